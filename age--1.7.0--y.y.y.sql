@@ -762,3 +762,338 @@ CREATE FUNCTION ag_catalog._agehash_self_test()
     VOLATILE
     PARALLEL UNSAFE
 AS 'MODULE_PATHNAME';
+
+--
+-- graph algorithm functions
+--
+CREATE FUNCTION ag_catalog.age_degree_centrality(graph_name name,
+                                                 direction text = 'both',
+                                                 edge_label name = NULL,
+                                                 OUT vertex_id graphid,
+                                                 OUT degree bigint,
+                                                 OUT centrality float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_kcore(graph_name name,
+                                     OUT vertex_id graphid,
+                                     OUT core_number bigint)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_random_walks(graph_name name,
+                                            start_ids graphid[] = NULL,
+                                            walk_length int = 10,
+                                            walks_per_node int = 1,
+                                            p float8 = 1.0,
+                                            q float8 = 1.0,
+                                            seed bigint = NULL,
+                                            OUT start_id graphid,
+                                            OUT walk graphid[])
+    RETURNS SETOF record
+    LANGUAGE c
+    VOLATILE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_node_similarity(graph_name name,
+                                               edge_label name = NULL,
+                                               metric text = 'jaccard',
+                                               top_k int = 10,
+                                               OUT source_id graphid,
+                                               OUT target_id graphid,
+                                               OUT similarity float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_similarity(graph_name name, a graphid,
+                                          b graphid,
+                                          metric text = 'jaccard',
+                                          edge_label name = NULL)
+    RETURNS float8
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_label_propagation(graph_name name,
+                                                 edge_label name = NULL,
+                                                 max_iter int = 20,
+                                                 OUT vertex_id graphid,
+                                                 OUT community graphid)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_personalized_pagerank(graph_name name,
+                                                     seed_ids graphid[],
+                                                     alpha float8 = 0.15,
+                                                     epsilon float8 = 1e-6,
+                                                     top_k int = 10,
+                                                     edge_label name = NULL,
+                                                     OUT vertex_id graphid,
+                                                     OUT score float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_project_graph(projection_name name,
+                                             graph_name name,
+                                             vertex_labels name[] = NULL,
+                                             edge_labels name[] = NULL,
+                                             property_keys text[] = NULL,
+                                             OUT vertex_count bigint,
+                                             OUT edge_count bigint)
+    RETURNS record
+    LANGUAGE c
+    VOLATILE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_drop_projection(projection_name name)
+    RETURNS boolean
+    LANGUAGE c
+    VOLATILE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_projections(OUT projection_name name,
+                                           OUT graph_name name,
+                                           OUT vertex_count bigint,
+                                           OUT edge_count bigint)
+    RETURNS SETOF record
+    LANGUAGE c
+    VOLATILE
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_betweenness(graph_name name,
+                                           edge_label name = NULL,
+                                           sample_size int = NULL,
+                                           seed bigint = NULL,
+                                           direction text = 'out',
+                                           OUT vertex_id graphid,
+                                           OUT betweenness float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    VOLATILE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_topological_sort(graph_name name,
+                                                edge_label name = NULL,
+                                                OUT vertex_id graphid,
+                                                OUT position bigint)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_dag_longest_path(graph_name name,
+                                                edge_label name = NULL,
+                                                weight_property text = NULL,
+                                                OUT vertex_ids graphid[],
+                                                OUT edge_ids graphid[],
+                                                OUT length float8)
+    RETURNS record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_khop_count(graph_name name,
+                                          start_ids graphid[] = NULL,
+                                          k int = 1,
+                                          direction text = 'out',
+                                          edge_label name = NULL,
+                                          OUT start_id graphid,
+                                          OUT hop int,
+                                          OUT count bigint)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_minimum_spanning_forest(graph_name name,
+                                                       edge_label name = NULL,
+                                                       weight_property text = NULL,
+                                                       OUT edge_id graphid,
+                                                       OUT weight float8,
+                                                       OUT total_weight float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+--
+-- graph statistics, collected by age_analyze_graph()
+--
+
+-- number of entities of a label, the default labels count all labels
+CREATE TABLE ag_catalog.ag_label_stats (
+                                graph oid NOT NULL,
+                                label label_id,
+                                row_count bigint NOT NULL
+);
+
+CREATE UNIQUE INDEX ag_label_stats_graph_label_index
+    ON ag_catalog.ag_label_stats
+    USING btree (graph, label);
+
+-- degrees along start_id ('o') or end_id ('i') of the edges of edge_label,
+-- over the vertices of vertex_label that have at least one such edge
+CREATE TABLE ag_catalog.ag_degree_stats (
+                                 graph oid NOT NULL,
+                                 edge_label label_id,
+                                 direction "char" NOT NULL
+                                     CHECK (direction = 'o' OR direction = 'i'),
+                                 vertex_label label_id,
+                                 edge_count bigint NOT NULL,
+                                 vertex_count bigint NOT NULL,
+                                 avg_degree float8 NOT NULL,
+                                 p50_degree float8 NOT NULL,
+                                 p90_degree float8 NOT NULL,
+                                 p99_degree float8 NOT NULL,
+                                 max_degree bigint NOT NULL
+);
+
+CREATE UNIQUE INDEX ag_degree_stats_graph_label_index
+    ON ag_catalog.ag_degree_stats
+    USING btree (graph, edge_label, direction, vertex_label);
+
+CREATE FUNCTION ag_catalog.age_analyze_graph(graph_name name)
+    RETURNS void
+    LANGUAGE c
+    AS 'MODULE_PATHNAME';
+
+-- join selectivity of '=' using the graph statistics
+CREATE FUNCTION ag_catalog.graphid_eqjoinsel(internal, oid, internal, int2,
+                                             internal)
+    RETURNS float8
+    LANGUAGE c
+    STABLE
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+ALTER OPERATOR ag_catalog.= (graphid, graphid)
+    SET (JOIN = ag_catalog.graphid_eqjoinsel);
+
+-- joins a cyclic MATCH pattern over the adjacency of the global graph
+CREATE FUNCTION ag_catalog.age_match_cycle(graph_name name,
+                                           vertex_labels text[],
+                                           edge_labels text[],
+                                           edge_starts int[],
+                                           edge_ends int[],
+                                           edge_directed boolean[],
+                                           OUT vertex_ids graphid[],
+                                           OUT edge_ids graphid[])
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+--
+-- Bound the ids of every pre-existing label table to its label, so that
+-- constraint exclusion can skip label tables for id constants. New label
+-- tables get the same constraint via label_commands.c.
+--
+DO $$
+DECLARE
+    r RECORD;
+BEGIN
+    FOR r IN
+        SELECT n.nspname AS schema_name, c.relname AS table_name, l.id
+        FROM ag_catalog.ag_label l
+        JOIN pg_catalog.pg_class c ON c.oid = l.relation
+        JOIN pg_catalog.pg_namespace n ON n.oid = c.relnamespace
+        WHERE NOT EXISTS (
+            SELECT 1 FROM pg_catalog.pg_constraint con
+            WHERE con.conrelid = l.relation
+              AND con.conname = '_age_label_id_check'
+        )
+    LOOP
+        EXECUTE format(
+            'ALTER TABLE %I.%I ADD CONSTRAINT _age_label_id_check '
+            'CHECK (id >= %L::ag_catalog.graphid '
+            'AND id <= %L::ag_catalog.graphid) NO INHERIT',
+            r.schema_name, r.table_name,
+            ag_catalog._graphid(r.id, 0),
+            ag_catalog._graphid(r.id, 281474976710655)
+        );
+    END LOOP;
+END;
+$$;
+
+--
+-- functions for CREATE INDEX and DROP INDEX of Cypher; they return no rows
+--
+CREATE FUNCTION ag_catalog._cypher_create_property_index(graph_name name,
+                                                         label_name name,
+                                                         label_kind "char",
+                                                         property_keys text[],
+                                                         index_name name,
+                                                         if_not_exists boolean,
+                                                         is_unique boolean)
+    RETURNS SETOF agtype
+    LANGUAGE c
+    VOLATILE
+    CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog._cypher_drop_property_index(graph_name name,
+                                                       index_name name,
+                                                       if_exists boolean,
+                                                       is_unique boolean)
+    RETURNS SETOF agtype
+    LANGUAGE c
+    VOLATILE
+    CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+--
+-- sort support with abbreviated keys for the agtype btree operator class
+--
+CREATE FUNCTION ag_catalog.agtype_btree_sort(internal)
+    RETURNS void
+    LANGUAGE c
+    IMMUTABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
+ALTER OPERATOR FAMILY ag_catalog.agtype_ops_btree USING btree
+  ADD FUNCTION 2 (agtype, agtype) ag_catalog.agtype_btree_sort(internal);
@@ -319,9 +319,212 @@ SELECT * FROM cypher('vle_trigger_test', $$
   ORDER BY n.name
 $$) AS (name agtype);
 
+-- Writes of a transaction are seen by the contexts loaded in between, and
+-- are gone once they are rolled back
+BEGIN;
+SELECT * FROM cypher('vle_trigger_test', $$
+  MATCH (x:Node {name: 'a'}), (y:Node {name: 'b_updated'})
+  CREATE (x)-[:Edge]->(y)
+$$) AS (v agtype);
+SELECT * FROM cypher('vle_trigger_test', $$
+  MATCH (a:Node {name: 'a'})-[:Edge*1..3]->(n:Node)
+  RETURN n.name
+  ORDER BY n.name
+$$) AS (name agtype);
+SELECT * FROM cypher('vle_trigger_test', $$
+  MATCH (x:Node {name: 'b_updated'}), (y:Node {name: 'c'})
+  CREATE (x)-[:Edge]->(y)
+$$) AS (v agtype);
+SELECT * FROM cypher('vle_trigger_test', $$
+  MATCH (x:Node {name: 'c'}), (y:Node {name: 'd'})
+  CREATE (x)-[:Edge]->(y)
+$$) AS (v agtype);
+SELECT * FROM cypher('vle_trigger_test', $$
+  MATCH (a:Node {name: 'a'})-[:Edge*1..3]->(n:Node)
+  RETURN n.name
+  ORDER BY n.name
+$$) AS (name agtype);
+SAVEPOINT s;
+DELETE FROM vle_trigger_test."Edge";
+SELECT * FROM cypher('vle_trigger_test', $$
+  MATCH (a:Node {name: 'a'})-[:Edge*1..3]->(n:Node)
+  RETURN n.name
+  ORDER BY n.name
+$$) AS (name agtype);
+ROLLBACK TO SAVEPOINT s;
+SELECT * FROM cypher('vle_trigger_test', $$
+  MATCH (a:Node {name: 'a'})-[:Edge*1..3]->(n:Node)
+  RETURN n.name
+  ORDER BY n.name
+$$) AS (name agtype);
+ROLLBACK;
+SELECT * FROM cypher('vle_trigger_test', $$
+  MATCH (a:Node {name: 'a'})-[:Edge*1..3]->(n:Node)
+  RETURN n.name
+  ORDER BY n.name
+$$) AS (name agtype);
+
 -- Cleanup
 SELECT * FROM drop_graph('vle_trigger_test', true);
 
+--
+-- Graph Expand custom scan (age.enable_graph_expand)
+--
+SELECT * FROM create_graph('graph_expand_test');
+SELECT * FROM cypher('graph_expand_test', $$
+  CREATE (a:N {name: 'a'}), (b:N {name: 'b'}), (c:N {name: 'c'}),
+         (a)-[:E]->(b), (a)-[:E]->(c), (b)-[:E]->(c), (c)-[:E]->(c),
+         (a)-[:F]->(c)
+$$) AS (a agtype);
+
+-- the path is only considered for analyzed graphs
+SELECT age_analyze_graph('graph_expand_test');
+
+SET age.enable_graph_expand = on;
+
+-- results must not depend on whether the expand path is chosen
+SELECT * FROM cypher('graph_expand_test', $$
+  MATCH (a:N)-[:E]->(b:N)
+  RETURN a.name, b.name
+  ORDER BY a.name, b.name
+$$) AS (a agtype, b agtype);
+SELECT * FROM cypher('graph_expand_test', $$
+  MATCH (a:N)<-[:E]-(b:N)
+  RETURN a.name, b.name
+  ORDER BY a.name, b.name
+$$) AS (a agtype, b agtype);
+SELECT * FROM cypher('graph_expand_test', $$
+  MATCH (a:N {name: 'a'})-[e]->(b:N)
+  RETURN label(e), b.name
+  ORDER BY label(e), b.name
+$$) AS (label agtype, b agtype);
+
+-- edges removed behind the context's back are not returned
+DELETE FROM graph_expand_test."E"
+WHERE end_id = (SELECT id FROM graph_expand_test."N"
+                WHERE properties @> '{"name": "b"}'::agtype);
+SELECT * FROM cypher('graph_expand_test', $$
+  MATCH (a:N)-[:E]->(b:N)
+  RETURN a.name, b.name
+  ORDER BY a.name, b.name
+$$) AS (a agtype, b agtype);
+
+RESET age.enable_graph_expand;
+SELECT * FROM drop_graph('graph_expand_test', true);
+
+--
+-- Multiway join of cyclic patterns (age.enable_multiway_join)
+--
+SELECT * FROM create_graph('multiway_join_test');
+
+SELECT * FROM cypher('multiway_join_test', $$
+  CREATE (a:N {name: 'a'}), (b:N {name: 'b'}), (c:N {name: 'c'}),
+         (d:N {name: 'd'}),
+         (a)-[:E]->(b), (a)-[:E]->(b), (b)-[:E]->(c), (c)-[:E]->(a),
+         (a)-[:E]->(d), (d)-[:E]->(c), (c)-[:E]->(c), (b)-[:F]->(a)
+$$) AS (a agtype);
+SELECT * FROM cypher('multiway_join_test', $$
+  MATCH (x:N)-[]-(y:N)-[]-(z:N)-[]-(x)
+  RETURN count(*)
+$$) AS (count agtype);
+
+SET age.enable_multiway_join = on;
+
+-- results must not depend on whether the cycle is joined by age_match_cycle
+SELECT * FROM cypher('multiway_join_test', $$
+  MATCH (x:N)-[]-(y:N)-[]-(z:N)-[]-(x)
+  RETURN count(*)
+$$) AS (count agtype);
+SELECT * FROM cypher('multiway_join_test', $$
+  MATCH (x:N)-[:E]->(y:N)-[:E]->(z:N)-[:E]->(x)
+  RETURN x.name, y.name, z.name
+  ORDER BY x.name, y.name, z.name
+$$) AS (x agtype, y agtype, z agtype);
+SELECT * FROM cypher('multiway_join_test', $$
+  MATCH (x:N)-[:E]->(y:N)-[:F]->(x)
+  RETURN x.name, y.name
+$$) AS (x agtype, y agtype);
+SELECT * FROM cypher('multiway_join_test', $$
+  MATCH (x:N)-[:E]->(x)
+  RETURN x.name
+$$) AS (x agtype);
+
+-- edges of different paths may be the same edge
+SELECT * FROM cypher('multiway_join_test', $$
+  MATCH (x:N)-[:E]->(y:N), (y)-[:E]->(z:N), (z)-[:E]->(x)
+  RETURN count(*)
+$$) AS (count agtype);
+
+-- the function itself does not check that edges are distinct
+SELECT count(*)
+FROM ag_catalog.age_match_cycle('multiway_join_test',
+                                ARRAY['N', 'N', 'N'], ARRAY['E', 'E', 'E'],
+                                ARRAY[0, 1, 2], ARRAY[1, 2, 0],
+                                ARRAY[true, true, true]);
+SELECT count(*)
+FROM ag_catalog.age_match_cycle('multiway_join_test',
+                                ARRAY['N', 'N'], ARRAY['E', 'E'],
+                                ARRAY[0, 1], ARRAY[1],
+                                ARRAY[true, true]);
+-- whether the plan of a query joins with age_match_cycle
+CREATE FUNCTION calls_match_cycle(query text)
+RETURNS boolean
+LANGUAGE plpgsql
+AS $func$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query
+    LOOP
+        IF line ~ 'age_match_cycle' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END;
+$func$;
+SELECT calls_match_cycle($q$
+    SELECT * FROM cypher('multiway_join_test', $$
+      MATCH (x:N)-[:E]->(y:N)-[:E]->(z:N)-[:E]->(x)
+      RETURN x.name, y.name, z.name
+    $$) AS (x agtype, y agtype, z agtype)
+$q$);
+-- an anchored pattern is left to the plain join, which starts from the anchor
+SELECT * FROM cypher('multiway_join_test', $$
+  MATCH (x:N {name: 'a'})-[:E]->(y:N)-[:E]->(z:N)-[:E]->(x)
+  RETURN y.name, z.name
+  ORDER BY y.name, z.name
+$$) AS (y agtype, z agtype);
+SELECT calls_match_cycle($q$
+    SELECT * FROM cypher('multiway_join_test', $$
+      MATCH (x:N {name: 'a'})-[:E]->(y:N)-[:E]->(z:N)-[:E]->(x)
+      RETURN y.name, z.name
+    $$) AS (y agtype, z agtype)
+$q$);
+SELECT calls_match_cycle($q$
+    SELECT * FROM cypher('multiway_join_test', $$
+      MATCH (x:N)-[:E]->(y:N)-[:E]->(z:N)-[:E]->(x)
+      WHERE id(x) = 844424930131969
+      RETURN y.name, z.name
+    $$) AS (y agtype, z agtype)
+$q$);
+DROP FUNCTION calls_match_cycle(text);
+
+-- a label that other labels inherit from matches their entities too
+SELECT * FROM cypher('multiway_join_test', $$
+  CREATE (p:M {name: 'p'}), (q:M {name: 'q'}),
+         (p)-[:E]->(q), (q)-[:E]->(p)
+$$) AS (a agtype);
+ALTER TABLE multiway_join_test."M" INHERIT multiway_join_test."N";
+SELECT * FROM cypher('multiway_join_test', $$
+  MATCH (x:N)-[:E]->(y:N)-[:E]->(x)
+  RETURN x.name, y.name
+  ORDER BY x.name, y.name
+$$) AS (x agtype, y agtype);
+
+RESET age.enable_multiway_join;
+SELECT * FROM drop_graph('multiway_join_test', true);
+
 -----------------------------------------------------------------------------------------------------------------------------
 --
 -- End of tests
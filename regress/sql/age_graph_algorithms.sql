@@ -0,0 +1,286 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+LOAD 'age';
+SET search_path TO ag_catalog;
+
+--
+-- graph algorithm functions
+--
+SELECT * FROM create_graph('graph_algorithms');
+SELECT * FROM cypher('graph_algorithms', $$
+    CREATE (a:Node {name: 'a'}), (b:Node {name: 'b'}), (c:Node {name: 'c'}),
+           (d:Node {name: 'd'}), (e:Node {name: 'e'}), (f:Node {name: 'f'}),
+           (a)-[:LINK]->(b), (b)-[:LINK]->(c), (c)-[:LINK]->(a),
+           (c)-[:LINK]->(d), (d)-[:LINK]->(e), (e)-[:LINK]->(f),
+           (a)-[:OTHER]->(d), (f)-[:LINK]->(f)
+$$) AS (a agtype);
+
+-- age_degree_centrality
+SELECT v.properties, d.degree, d.centrality
+FROM age_degree_centrality('graph_algorithms') AS d
+JOIN graph_algorithms."Node" AS v ON v.id = d.vertex_id
+ORDER BY d.vertex_id;
+SELECT v.properties, d.degree, d.centrality
+FROM age_degree_centrality('graph_algorithms', 'out', 'LINK') AS d
+JOIN graph_algorithms."Node" AS v ON v.id = d.vertex_id
+ORDER BY d.vertex_id;
+SELECT v.properties, d.degree, d.centrality
+FROM age_degree_centrality('graph_algorithms', 'in') AS d
+JOIN graph_algorithms."Node" AS v ON v.id = d.vertex_id
+ORDER BY d.vertex_id;
+-- invalid arguments
+SELECT * FROM age_degree_centrality('graph_algorithms', 'sideways');
+SELECT * FROM age_degree_centrality('graph_algorithms', 'out', 'Node');
+SELECT * FROM age_degree_centrality('graph_algorithms', 'out', 'MISSING');
+SELECT * FROM age_degree_centrality('missing_graph');
+
+-- age_kcore
+SELECT v.properties, k.core_number
+FROM age_kcore('graph_algorithms') AS k
+JOIN graph_algorithms."Node" AS v ON v.id = k.vertex_id
+ORDER BY k.vertex_id;
+
+-- age_random_walks
+-- the out-edges of d, e, and f force the walk
+SELECT start_id, walk FROM age_random_walks('graph_algorithms', ARRAY['844424930131972'::graphid], 5, 1, 1.0, 1.0, 7);
+SELECT start_id, walk FROM age_random_walks('graph_algorithms', ARRAY['844424930131973'::graphid], 4, 1, 0.5, 2.0, 7);
+-- every vertex has an out-edge, so every walk has the full length
+SELECT count(*), min(array_length(walk, 1)), max(array_length(walk, 1))
+FROM age_random_walks('graph_algorithms', NULL, 4, 3, 1.0, 1.0, 42);
+-- the same seed generates the same walks
+SELECT count(*) FROM (
+    SELECT * FROM age_random_walks('graph_algorithms', NULL, 8, 2, 0.5, 2.0, 42)
+    EXCEPT ALL
+    SELECT * FROM age_random_walks('graph_algorithms', NULL, 8, 2, 0.5, 2.0, 42)) AS diff;
+SELECT * FROM age_random_walks('graph_algorithms', NULL, 0);
+SELECT * FROM age_random_walks('graph_algorithms', NULL, 5, 1, 0.0);
+
+-- age_node_similarity
+SELECT s.properties AS source, t.properties AS target, n.similarity
+FROM age_node_similarity('graph_algorithms', NULL, 'jaccard', 2) AS n
+JOIN graph_algorithms."Node" AS s ON s.id = n.source_id
+JOIN graph_algorithms."Node" AS t ON t.id = n.target_id
+ORDER BY n.source_id, n.similarity DESC, n.target_id;
+SELECT s.properties AS source, t.properties AS target, n.similarity
+FROM age_node_similarity('graph_algorithms', 'LINK', 'overlap', 1) AS n
+JOIN graph_algorithms."Node" AS s ON s.id = n.source_id
+JOIN graph_algorithms."Node" AS t ON t.id = n.target_id
+ORDER BY n.source_id, n.similarity DESC, n.target_id;
+
+-- age_similarity
+SELECT age_similarity('graph_algorithms', '844424930131969', '844424930131971', 'jaccard');
+SELECT age_similarity('graph_algorithms', '844424930131969', '844424930131973', 'overlap');
+SELECT age_similarity('graph_algorithms', '844424930131969', '844424930131971', 'adamic_adar');
+SELECT age_similarity('graph_algorithms', '844424930131969', '844424930131971', 'common_neighbors');
+SELECT age_similarity('graph_algorithms', '844424930131969', '844424930131971', 'cosine');
+
+-- age_label_propagation
+SELECT v.properties AS vertex, c.properties AS community
+FROM age_label_propagation('graph_algorithms') AS l
+JOIN graph_algorithms."Node" AS v ON v.id = l.vertex_id
+JOIN graph_algorithms."Node" AS c ON c.id = l.community
+ORDER BY l.vertex_id;
+SELECT v.properties AS vertex, c.properties AS community
+FROM age_label_propagation('graph_algorithms', 'LINK') AS l
+JOIN graph_algorithms."Node" AS v ON v.id = l.vertex_id
+JOIN graph_algorithms."Node" AS c ON c.id = l.community
+ORDER BY l.vertex_id;
+-- no passes leave every vertex in its own community
+SELECT v.properties AS vertex, c.properties AS community
+FROM age_label_propagation('graph_algorithms', NULL, 0) AS l
+JOIN graph_algorithms."Node" AS v ON v.id = l.vertex_id
+JOIN graph_algorithms."Node" AS c ON c.id = l.community
+ORDER BY l.vertex_id;
+SELECT * FROM age_label_propagation('graph_algorithms', NULL, -1);
+SELECT * FROM age_label_propagation('graph_algorithms', 'Node');
+
+-- age_personalized_pagerank
+SELECT v.properties, round(p.score::numeric, 4) AS score
+FROM age_personalized_pagerank('graph_algorithms', ARRAY['844424930131969']::graphid[], 0.15, 1e-10, 3) AS p
+JOIN graph_algorithms."Node" AS v ON v.id = p.vertex_id
+ORDER BY p.score DESC, p.vertex_id;
+SELECT v.properties, round(p.score::numeric, 4) AS score
+FROM age_personalized_pagerank('graph_algorithms', ARRAY['844424930131969', '844424930131971']::graphid[], 0.3, 1e-10, 4, 'LINK') AS p
+JOIN graph_algorithms."Node" AS v ON v.id = p.vertex_id
+ORDER BY p.score DESC, p.vertex_id;
+-- the scores converge to a probability distribution
+SELECT count(*), round(sum(score)::numeric, 6) AS total
+FROM age_personalized_pagerank('graph_algorithms', ARRAY['844424930131970'::graphid], 0.15, 1e-10, 100);
+-- unknown seeds are ignored
+SELECT * FROM age_personalized_pagerank('graph_algorithms', ARRAY['1'::graphid]);
+SELECT * FROM age_personalized_pagerank('graph_algorithms', ARRAY['844424930131969'::graphid], 0.0);
+SELECT * FROM age_personalized_pagerank('graph_algorithms', ARRAY['844424930131969'::graphid], 0.15, 0.0);
+SELECT * FROM age_personalized_pagerank('graph_algorithms', NULL);
+
+-- named projections
+SELECT * FROM age_project_graph('link_only', 'graph_algorithms', NULL,
+                                 ARRAY['LINK']::name[], ARRAY['name']);
+SELECT * FROM age_projections();
+-- algorithms accept a projection in place of a graph
+SELECT v.properties, d.degree, d.centrality
+FROM age_degree_centrality('link_only') AS d
+JOIN graph_algorithms."Node" AS v ON v.id = d.vertex_id
+ORDER BY d.vertex_id;
+SELECT v.properties AS vertex, c.properties AS community
+FROM age_label_propagation('link_only') AS l
+JOIN graph_algorithms."Node" AS v ON v.id = l.vertex_id
+JOIN graph_algorithms."Node" AS c ON c.id = l.community
+ORDER BY l.vertex_id;
+SELECT count(*) FROM (
+    SELECT * FROM age_kcore('link_only')
+    EXCEPT
+    SELECT * FROM age_kcore('graph_algorithms')) AS diff;
+SELECT * FROM age_project_graph('link_only', 'graph_algorithms');
+SELECT * FROM age_project_graph('graph_algorithms', 'graph_algorithms');
+SELECT * FROM age_project_graph('bad', 'graph_algorithms', ARRAY['LINK']::name[]);
+SELECT * FROM age_project_graph('bad', 'graph_algorithms', NULL, ARRAY['Node']::name[]);
+SELECT age_drop_projection('link_only');
+SELECT age_drop_projection('link_only');
+SELECT * FROM age_kcore('link_only');
+
+-- age_betweenness
+SELECT v.properties, round(b.betweenness::numeric, 4) AS betweenness
+FROM age_betweenness('graph_algorithms') AS b
+JOIN graph_algorithms."Node" AS v ON v.id = b.vertex_id
+ORDER BY b.vertex_id;
+SELECT v.properties, round(b.betweenness::numeric, 4) AS betweenness
+FROM age_betweenness('graph_algorithms', 'LINK', NULL, NULL, 'both') AS b
+JOIN graph_algorithms."Node" AS v ON v.id = b.vertex_id
+ORDER BY b.vertex_id;
+-- a sample as large as the graph gives the exact scores
+SELECT count(*) FROM (
+    SELECT * FROM age_betweenness('graph_algorithms', NULL, 100, 1)
+    EXCEPT ALL
+    SELECT * FROM age_betweenness('graph_algorithms')) AS diff;
+-- the same seed samples the same sources
+SELECT count(*) FROM (
+    SELECT * FROM age_betweenness('graph_algorithms', NULL, 3, 42)
+    EXCEPT ALL
+    SELECT * FROM age_betweenness('graph_algorithms', NULL, 3, 42)) AS diff;
+SELECT * FROM age_betweenness('graph_algorithms', NULL, 0);
+
+-- age_topological_sort and age_dag_longest_path
+SELECT * FROM create_graph('dag');
+SELECT * FROM cypher('dag', $$
+    CREATE (t1:Task {name: 't1'}), (t2:Task {name: 't2'}), (t3:Task {name: 't3'}),
+           (t4:Task {name: 't4'}), (t5:Task {name: 't5'}),
+           (t1)-[:DEP {weight: 3}]->(t2), (t2)-[:DEP {weight: 4}]->(t3),
+           (t1)-[:DEP {weight: 1}]->(t3), (t3)-[:DEP {weight: 2}]->(t4),
+           (t2)-[:DEP {weight: 10.5}]->(t4), (t4)-[:DEP {weight: 1}]->(t5)
+$$) AS (a agtype);
+SELECT v.properties, t.position
+FROM age_topological_sort('dag') AS t
+JOIN dag."Task" AS v ON v.id = t.vertex_id
+ORDER BY t.position;
+-- ties are broken by load order
+SELECT v.properties, t.position
+FROM age_topological_sort('graph_algorithms', 'OTHER') AS t
+JOIN graph_algorithms."Node" AS v ON v.id = t.vertex_id
+ORDER BY t.position;
+SELECT p.length, cardinality(p.edge_ids) AS hops,
+       (SELECT string_agg(v.properties::text, ', ' ORDER BY u.n)
+        FROM unnest(p.vertex_ids) WITH ORDINALITY AS u(id, n)
+        JOIN dag."Task" AS v ON v.id = u.id) AS path
+FROM age_dag_longest_path('dag') AS p;
+SELECT p.length, cardinality(p.edge_ids) AS hops,
+       (SELECT string_agg(v.properties::text, ', ' ORDER BY u.n)
+        FROM unnest(p.vertex_ids) WITH ORDINALITY AS u(id, n)
+        JOIN dag."Task" AS v ON v.id = u.id) AS path
+FROM age_dag_longest_path('dag', NULL, 'weight') AS p;
+-- the weights can come from a projection
+SELECT * FROM age_project_graph('dag_weights', 'dag', NULL, NULL, ARRAY['weight']);
+SELECT p.length, cardinality(p.edge_ids) AS hops,
+       (SELECT string_agg(v.properties::text, ', ' ORDER BY u.n)
+        FROM unnest(p.vertex_ids) WITH ORDINALITY AS u(id, n)
+        JOIN dag."Task" AS v ON v.id = u.id) AS path
+FROM age_dag_longest_path('dag_weights', NULL, 'weight') AS p;
+SELECT age_drop_projection('dag_weights');
+SELECT length, cardinality(vertex_ids) AS vertices
+FROM age_dag_longest_path('graph_algorithms', 'OTHER');
+-- cycles and missing weights
+SELECT * FROM age_topological_sort('graph_algorithms');
+SELECT * FROM age_dag_longest_path('graph_algorithms', 'LINK');
+SELECT * FROM age_dag_longest_path('graph_algorithms', 'OTHER', 'weight');
+
+-- age_khop_count
+SELECT v.properties, h.hop, h.count
+FROM age_khop_count('graph_algorithms', NULL, 3) AS h
+JOIN graph_algorithms."Node" AS v ON v.id = h.start_id
+ORDER BY h.start_id, h.hop;
+SELECT v.properties, h.hop, h.count
+FROM age_khop_count('graph_algorithms', ARRAY['844424930131969', '844424930131974']::graphid[], 10, 'in', 'LINK') AS h
+JOIN graph_algorithms."Node" AS v ON v.id = h.start_id
+ORDER BY h.start_id, h.hop;
+SELECT v.properties, h.hop, h.count
+FROM age_khop_count('graph_algorithms', ARRAY['844424930131973']::graphid[], 2, 'both') AS h
+JOIN graph_algorithms."Node" AS v ON v.id = h.start_id
+ORDER BY h.start_id, h.hop;
+SELECT * FROM age_khop_count('graph_algorithms', NULL, 0);
+
+-- age_minimum_spanning_forest
+SELECT s.properties AS start_vertex, t.properties AS end_vertex,
+       m.weight, m.total_weight
+FROM age_minimum_spanning_forest('dag', NULL, 'weight') WITH ORDINALITY
+     AS m(edge_id, weight, total_weight, n)
+JOIN dag."DEP" AS e ON e.id = m.edge_id
+JOIN dag."Task" AS s ON s.id = e.start_id
+JOIN dag."Task" AS t ON t.id = e.end_id
+ORDER BY m.n;
+-- without weights, every spanning forest is minimal
+SELECT count(*), max(total_weight) AS total_weight
+FROM age_minimum_spanning_forest('graph_algorithms');
+SELECT count(*), max(total_weight) AS total_weight
+FROM age_minimum_spanning_forest('graph_algorithms', 'OTHER');
+
+-- dangling edges are left out of the adjacency
+SELECT * FROM create_graph('dangling');
+SELECT * FROM cypher('dangling', $$
+    CREATE (a:Node {name: 'a'}), (b:Node {name: 'b'}), (c:Node {name: 'c'}),
+           (a)-[:LINK]->(b), (a)-[:LINK]->(c), (b)-[:LINK]->(c)
+$$) AS (a agtype);
+DELETE FROM dangling."Node" WHERE id = '844424930131971'::graphid;
+-- suppress the warnings about the dangling edges when the graph is loaded
+SET client_min_messages = error;
+SELECT v.properties, k.core_number
+FROM age_kcore('dangling') AS k
+JOIN dangling."Node" AS v ON v.id = k.vertex_id
+ORDER BY k.vertex_id;
+RESET client_min_messages;
+SELECT v.properties, h.hop, h.count
+FROM age_khop_count('dangling', NULL, 2) AS h
+JOIN dangling."Node" AS v ON v.id = h.start_id
+ORDER BY h.start_id, h.hop;
+SELECT v.properties, round(p.score::numeric, 4) AS score
+FROM age_personalized_pagerank('dangling', ARRAY['844424930131969']::graphid[], 0.15, 1e-10) AS p
+JOIN dangling."Node" AS v ON v.id = p.vertex_id
+ORDER BY p.score DESC, p.vertex_id;
+SELECT age_similarity('dangling', '844424930131969', '844424930131970', 'jaccard');
+SELECT age_similarity('dangling', '844424930131969', '844424930131970', 'adamic_adar');
+
+--
+-- Cleanup
+--
+SELECT * FROM drop_graph('graph_algorithms', true);
+SELECT * FROM drop_graph('dag', true);
+SELECT * FROM drop_graph('dangling', true);
+
+--
+-- End of tests
+--
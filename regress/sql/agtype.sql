@@ -552,6 +552,8 @@ SELECT * FROM cypher('orderability_graph', $$ CREATE (:vertex {prop: null}), (:v
 SELECT * FROM cypher('orderability_graph', $$ MATCH (n) RETURN n ORDER BY n.prop $$) AS (sorted agtype);
 SELECT * FROM cypher('orderability_graph', $$ MATCH (n) RETURN n ORDER BY n.prop DESC $$) AS (sorted agtype);
 SELECT * FROM drop_graph('orderability_graph', true);
+-- Sorting with abbreviated keys
+SELECT x FROM (VALUES ('"abcdefghij2"'::agtype), ('-0.5'::agtype), ('9007199254740993'::agtype), ('null'::agtype), ('"abc"'::agtype), ('NaN'::agtype), ('{}'::agtype), ('1.5::numeric'::agtype), ('false'::agtype), ('-Infinity'::agtype), ('[1]'::agtype), ('9007199254740992'::agtype), ('"abcdefghij1"'::agtype), ('0.0'::agtype)) AS t(x) ORDER BY x;
 
 --
 -- Test overloaded agytype any comparison operators =, <>, <, >, <=, >=,
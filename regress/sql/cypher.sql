@@ -114,6 +114,33 @@ DROP TABLE my_detailed_paths;
 SELECT drop_graph('issue_1767', true);
 SELECT drop_graph('cypher', true);
 
+--
+-- cypher() query cache
+--
+SELECT create_graph('query_cache');
+-- the label does not exist yet when the query is analyzed first
+SELECT * FROM cypher('query_cache', $$ MATCH (n:cached) RETURN n.num $$) AS (num agtype);
+SELECT * FROM cypher('query_cache', $$ CREATE (:cached {num: 1}) $$) AS (a agtype);
+SELECT * FROM cypher('query_cache', $$ MATCH (n:cached) RETURN n.num $$) AS (num agtype);
+-- the analyzed query is shared by different column definition lists
+SELECT * FROM cypher('query_cache', $$ MATCH (n:cached) RETURN n.num $$) AS (num int);
+SELECT drop_label('query_cache', 'cached');
+SELECT * FROM cypher('query_cache', $$ MATCH (n:cached) RETURN n.num $$) AS (num agtype);
+SELECT * FROM cypher('query_cache', $$ CREATE (:cached {num: 2}) $$) AS (a agtype);
+SELECT * FROM cypher('query_cache', $$ MATCH (n:cached) RETURN n.num $$) AS (num agtype);
+-- the cache can be disabled
+SET age.cypher_query_cache_size = 0;
+SELECT * FROM cypher('query_cache', $$ MATCH (n:cached) RETURN n.num $$) AS (num agtype);
+RESET age.cypher_query_cache_size;
+-- a query taken from the cache locks the relations it reads
+SELECT * FROM cypher('query_cache', $$ MATCH (n:cached) RETURN n.num $$) AS (num agtype);
+BEGIN;
+SELECT * FROM cypher('query_cache', $$ MATCH (n:cached) RETURN n.num $$) AS (num agtype);
+SELECT mode FROM pg_locks
+WHERE relation = 'query_cache.cached'::regclass AND pid = pg_backend_pid();
+COMMIT;
+SELECT drop_graph('query_cache', true);
+
 --
 -- End
 --
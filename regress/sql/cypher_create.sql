@@ -475,6 +475,49 @@ SELECT * FROM cypher('cypher_create', $$
   CREATE (n), (m) WITH n AS r CREATE (m) RETURN m
 $$) as (m agtype);
 
+-- a terminal CREATE inserts its entities in batches
+SELECT * FROM cypher('cypher_create', $$
+  UNWIND range(1, 2500) AS i
+  CREATE (:batch_v {i: i})-[:batch_e {i: i}]->(:batch_v {i: -i})
+$$) as (a agtype);
+
+SELECT * FROM cypher('cypher_create', $$
+  MATCH (u:batch_v)-[e:batch_e]->(v:batch_v)
+  WHERE u.i = e.i AND v.i = -e.i
+  RETURN count(*), min(e.i), max(e.i)
+$$) as (count agtype, min agtype, max agtype);
+
+SELECT * FROM cypher('cypher_create', $$
+  MATCH (v:batch_v) RETURN count(DISTINCT id(v))
+$$) as (count agtype);
+
+-- labels created with age.graphid_block_size take ids in blocks
+SET age.graphid_block_size = 10;
+SELECT * FROM cypher('cypher_create', $$
+  CREATE (:block_v {i: 1}), (:block_v {i: 2})
+$$) as (a agtype);
+
+SELECT * FROM cypher('cypher_create', $$
+  MERGE (:block_v {i: 3})
+$$) as (a agtype);
+
+-- the whole block has been taken from the sequence
+SELECT seqcache FROM pg_sequence
+WHERE seqrelid = 'cypher_create.block_v_id_seq'::regclass;
+SELECT last_value FROM cypher_create.block_v_id_seq;
+SELECT currval('cypher_create.block_v_id_seq');
+
+-- the label keeps its cache
+RESET age.graphid_block_size;
+
+SELECT * FROM cypher('cypher_create', $$
+  CREATE (:block_v {i: 4})
+$$) as (a agtype);
+
+SELECT * FROM cypher('cypher_create', $$
+  MATCH (v:block_v) RETURN v.i, id(v) % 281474976710656 ORDER BY v.i
+$$) as (i agtype, entry_id agtype);
+
 --
 -- Clean up
 --
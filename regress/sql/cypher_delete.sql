@@ -302,6 +302,40 @@ SELECT id as "expected: 0 rows"              FROM setdelete._ag_label_edge;
 -- clean up
 SELECT drop_graph('setdelete', true);
 
+--
+-- DELETE with the global graph context loaded
+--
+SELECT create_graph('adjacency_delete');
+
+SELECT * FROM cypher('adjacency_delete', $$
+  CREATE (a:A {i: 1})-[:e1]->(b:B {i: 2}), (b)-[:e2]->(a), (b)-[:e1]->(b),
+         (:A {i: 3})-[:e3]->(:B {i: 4})
+$$) AS (a agtype);
+
+-- the VLE loads the context
+SELECT * FROM cypher('adjacency_delete', $$
+  MATCH p = (:A {i: 3})-[*]->() RETURN length(p)
+$$) AS (length agtype);
+
+-- should fail
+SELECT * FROM cypher('adjacency_delete', $$
+  MATCH (n:B {i: 2}) DELETE n
+$$) AS (a agtype);
+
+SELECT * FROM cypher('adjacency_delete', $$
+  MATCH (n:B {i: 2}) DETACH DELETE n
+$$) AS (a agtype);
+
+SELECT * FROM cypher('adjacency_delete', $$
+  MATCH (u)-[e]->(v) RETURN u.i, label(e), v.i
+$$) AS (u agtype, e agtype, v agtype);
+
+SELECT * FROM cypher('adjacency_delete', $$
+  MATCH (n) RETURN n.i ORDER BY n.i
+$$) AS (i agtype);
+
+SELECT drop_graph('adjacency_delete', true);
+
 --
 -- Clean up
 --
@@ -1689,6 +1689,123 @@ $$) AS (name agtype, friend agtype);
 
 SELECT drop_graph('issue_2378', true);
 
+--
+-- Label pruning from graphid constants
+--
+SELECT create_graph('label_pruning');
+SELECT create_vlabel('label_pruning', 'a');
+SELECT create_vlabel('label_pruning', 'b');
+SELECT create_elabel('label_pruning', 'e');
+SELECT create_elabel('label_pruning', 'f');
+SELECT * FROM cypher('label_pruning', $$
+    CREATE (:a {n: 1})-[:e]->(:b {n: 2}), (:b {n: 3})-[:f]->(:a {n: 4})
+$$) AS (a agtype);
+-- the tables that the plan of a query scans
+CREATE FUNCTION scanned_tables(query text)
+RETURNS SETOF text
+LANGUAGE plpgsql
+AS $func$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query
+    LOOP
+        IF line ~ ' on ' AND line !~ 'Bitmap Index Scan' THEN
+            RETURN NEXT substring(line from ' on (\S+)');
+        END IF;
+    END LOOP;
+END;
+$func$;
+-- only the table of the label in the id is scanned
+SELECT * FROM cypher('label_pruning', $$ MATCH (n) WHERE id(n) = 844424930131969 RETURN n.n $$) AS (n agtype);
+SELECT * FROM scanned_tables($q$
+    SELECT * FROM cypher('label_pruning', $$ MATCH (n) WHERE id(n) = 844424930131969 RETURN n.n $$) AS (n agtype)
+$q$) AS t ORDER BY t;
+SELECT * FROM cypher('label_pruning', $$ MATCH (n) WHERE id(n) IN [844424930131969, 1125899906842626] RETURN n.n ORDER BY n.n $$) AS (n agtype);
+SELECT * FROM scanned_tables($q$
+    SELECT * FROM cypher('label_pruning', $$ MATCH (n) WHERE id(n) IN [844424930131969, 1125899906842626] RETURN n.n ORDER BY n.n $$) AS (n agtype)
+$q$) AS t ORDER BY t;
+SELECT * FROM cypher('label_pruning', $$ MATCH (n) WHERE id(n) = 281474976710657 RETURN n.n $$) AS (n agtype);
+SELECT * FROM scanned_tables($q$
+    SELECT * FROM cypher('label_pruning', $$ MATCH (n) WHERE id(n) = 281474976710657 RETURN n.n $$) AS (n agtype)
+$q$) AS t ORDER BY t;
+-- no table has the label of the id
+SELECT * FROM cypher('label_pruning', $$ MATCH (n) WHERE id(n) = 2533274790395905 RETURN n.n $$) AS (n agtype);
+SELECT * FROM scanned_tables($q$
+    SELECT * FROM cypher('label_pruning', $$ MATCH (n) WHERE id(n) = 2533274790395905 RETURN n.n $$) AS (n agtype)
+$q$) AS t ORDER BY t;
+-- edges, and the vertices that start_id and end_id refer to
+SELECT * FROM cypher('label_pruning', $$ MATCH ()-[r]->() WHERE id(r) = 1688849860263937 RETURN type(r) $$) AS (t agtype);
+SELECT * FROM scanned_tables($q$
+    SELECT * FROM cypher('label_pruning', $$ MATCH ()-[r]->() WHERE id(r) = 1688849860263937 RETURN type(r) $$) AS (t agtype)
+$q$) AS t ORDER BY t;
+SELECT * FROM cypher('label_pruning', $$ MATCH (x)-[r]->() WHERE start_id(r) = 1125899906842626 RETURN x.n, type(r) $$) AS (n agtype, t agtype);
+SELECT * FROM scanned_tables($q$
+    SELECT * FROM cypher('label_pruning', $$ MATCH (x)-[r]->() WHERE start_id(r) = 1125899906842626 RETURN x.n, type(r) $$) AS (n agtype, t agtype)
+$q$) AS t ORDER BY t;
+SELECT * FROM cypher('label_pruning', $$ MATCH ()-[r]->(y) WHERE end_id(r) = 1125899906842625 RETURN y.n, type(r) $$) AS (n agtype, t agtype);
+SELECT * FROM scanned_tables($q$
+    SELECT * FROM cypher('label_pruning', $$ MATCH ()-[r]->(y) WHERE end_id(r) = 1125899906842625 RETURN y.n, type(r) $$) AS (n agtype, t agtype)
+$q$) AS t ORDER BY t;
+-- parameters are constants in custom plans
+PREPARE label_pruning_id(agtype) AS
+    SELECT * FROM cypher('label_pruning', $$ MATCH (n) WHERE id(n) = $id RETURN n.n $$, $1) AS (n agtype);
+EXECUTE label_pruning_id('{"id": 1125899906842625}');
+SELECT * FROM scanned_tables($q$
+    EXECUTE label_pruning_id('{"id": 1125899906842625}')
+$q$) AS t ORDER BY t;
+DEALLOCATE label_pruning_id;
+DROP FUNCTION scanned_tables(text);
+SELECT drop_graph('label_pruning', true);
+
+--
+-- Constant labels of leaf label tables
+--
+SELECT create_graph('label_constant');
+SELECT create_vlabel('label_constant', 'a');
+SELECT create_vlabel('label_constant', 'b');
+SELECT create_elabel('label_constant', 'e');
+SELECT * FROM cypher('label_constant', $$
+    CREATE (:a {n: 1})-[:e]->(:b {n: 2}), ({n: 0})
+$$) AS (a agtype);
+-- the label expressions of the plan of a query
+CREATE FUNCTION label_exprs(query text)
+RETURNS SETOF text
+LANGUAGE plpgsql
+AS $func$
+DECLARE
+    line text;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (VERBOSE, COSTS OFF) ' || query
+    LOOP
+        RETURN QUERY
+            SELECT m[1]
+            FROM regexp_matches(line, '_label_name|''"\w*"''(?=::)', 'g') AS m;
+    END LOOP;
+END;
+$func$;
+-- the tables of leaf labels give their label as a constant
+SELECT DISTINCT t FROM label_exprs($q$
+    SELECT * FROM cypher('label_constant', $$ MATCH (x:a)-[r:e]->(y:b) RETURN x, r, y $$) AS (x agtype, r agtype, y agtype)
+$q$) AS t ORDER BY t;
+-- the table of the default label is inherited by the others
+SELECT DISTINCT t FROM label_exprs($q$
+    SELECT * FROM cypher('label_constant', $$ MATCH (n) RETURN n $$) AS (n agtype)
+$q$) AS t ORDER BY t;
+SELECT * FROM cypher('label_constant', $$ MATCH (n) RETURN n.n, label(n) ORDER BY n.n $$) AS (n agtype, l agtype);
+-- a plan made with the constant is made again when the label gets a child
+PREPARE label_constant_a AS
+    SELECT * FROM cypher('label_constant', $$ MATCH (n:a) RETURN n.n, label(n) ORDER BY n.n $$) AS (n agtype, l agtype);
+EXECUTE label_constant_a;
+ALTER TABLE label_constant.b INHERIT label_constant.a;
+EXECUTE label_constant_a;
+SELECT DISTINCT t FROM label_exprs($q$
+    SELECT * FROM cypher('label_constant', $$ MATCH (n:a) RETURN n $$) AS (n agtype)
+$q$) AS t ORDER BY t;
+DEALLOCATE label_constant_a;
+DROP FUNCTION label_exprs(text);
+SELECT drop_graph('label_constant', true);
+
 --
 -- Clean up
 --
@@ -1088,6 +1088,32 @@ $$) AS (src agtype, last agtype);
 -- cleanup
 SELECT * FROM cypher('merge_actions', $$ MATCH (n) DETACH DELETE n $$) AS (a agtype);
 
+--
+-- Rows of a batch that repeat the entities created by earlier rows
+--
+SELECT create_graph('merge_batch');
+SELECT * FROM cypher('merge_batch', $$
+  UNWIND [{src: 1, dst: 2}, {src: 2, dst: 3}, {src: 1, dst: 2},
+          {src: 3, dst: 1}, {src: 1, dst: 3}, {src: 2, dst: 3}] AS r
+  MERGE (a:Acct {id: r.src})
+  MERGE (b:Acct {id: r.dst})
+  MERGE (a)-[:T]->(b)
+$$) AS (a agtype);
+SELECT * FROM cypher('merge_batch', $$
+  MATCH (a:Acct) RETURN a.id ORDER BY a.id
+$$) AS (id agtype);
+SELECT * FROM cypher('merge_batch', $$
+  MATCH (a:Acct)-[:T]->(b:Acct) RETURN a.id, b.id ORDER BY a.id, b.id
+$$) AS (src agtype, dst agtype);
+SELECT * FROM cypher('merge_batch', $$
+  UNWIND range(1, 3000) AS i
+  MERGE (s:Slot {n: i % 100})
+  RETURN count(*)
+$$) AS (rows agtype);
+SELECT * FROM cypher('merge_batch', $$
+  MATCH (s:Slot) RETURN count(*), min(s.n), max(s.n)
+$$) AS (slots agtype, min agtype, max agtype);
+
 --
 -- delete graphs
 --
@@ -1099,6 +1125,7 @@ SELECT drop_graph('issue_1691', true);
 SELECT drop_graph('issue_1709', true);
 SELECT drop_graph('issue_1446', true);
 SELECT drop_graph('issue_1954', true);
+SELECT drop_graph('merge_batch', true);
 
 --
 -- End
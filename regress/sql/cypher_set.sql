@@ -542,6 +542,28 @@ SELECT * FROM cypher('issue_1884', $$
     RETURN a
 $$) AS (a agtype);
 
+--
+-- Several items of a list altering the same entities
+--
+SELECT * FROM cypher('cypher_set_1', $$
+    CREATE (:Robert {name: 'Bob', z: 0})-[:KNOWS {since: 2000}]->(:Robert {name: 'Rob'})
+$$) AS (a agtype);
+SELECT * FROM cypher('cypher_set_1', $$
+    MATCH p=(a {name: 'Bob'})-[e:KNOWS]->(b)
+    SET a.c = 3, a.aa = 1, e.since = 2010, a.b = 2, a.z = NULL,
+        e.until = 2020, a += {d: 4, b: 5}
+    RETURN properties(a), properties(e), properties(relationships(p)[0])
+$$) AS (a agtype, e agtype, pe agtype);
+SELECT * FROM cypher('cypher_set_1', $$
+    MATCH (a {name: 'Bob'})-[e:KNOWS]->(b)
+    RETURN properties(a), properties(e)
+$$) AS (a agtype, e agtype);
+SELECT * FROM cypher('cypher_set_1', $$
+    MATCH (a {name: 'Bob'})
+    SET a.b = NULL, a.e = 'e', a.aa = NULL, a.c = [1, {f: 2}]
+    RETURN properties(a)
+$$) AS (a agtype);
+
 --
 -- Clean up
 --
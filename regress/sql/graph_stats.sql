@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+LOAD 'age';
+SET search_path TO ag_catalog;
+
+--
+-- graph statistics
+--
+SELECT * FROM create_graph('graph_stats');
+SELECT * FROM cypher('graph_stats', $$
+    CREATE (a:Person {name: 'a'}), (b:Person {name: 'b'}),
+           (c:Person {name: 'c'}), (d:Person {name: 'd'}),
+           (x:City {name: 'x'}),
+           (a)-[:KNOWS]->(b), (a)-[:KNOWS]->(c), (a)-[:KNOWS]->(d),
+           (b)-[:KNOWS]->(c), (c)-[:KNOWS]->(c),
+           (a)-[:LIVES_IN]->(x), (b)-[:LIVES_IN]->(x)
+$$) AS (a agtype);
+
+-- no statistics before the graph is analyzed
+SELECT count(*) FROM ag_label_stats
+WHERE graph = (SELECT graphid FROM ag_graph WHERE name = 'graph_stats');
+SELECT age_analyze_graph('graph_stats');
+SELECT l.name, s.row_count
+FROM ag_label_stats AS s
+JOIN ag_label AS l ON l.graph = s.graph AND l.id = s.label
+WHERE s.graph = (SELECT graphid FROM ag_graph WHERE name = 'graph_stats')
+ORDER BY l.name COLLATE "C";
+SELECT e.name AS edge_label, s.direction, v.name AS vertex_label,
+       s.edge_count, s.vertex_count, round(s.avg_degree::numeric, 2) AS avg,
+       round(s.p50_degree::numeric, 2) AS p50,
+       round(s.p90_degree::numeric, 2) AS p90,
+       round(s.p99_degree::numeric, 2) AS p99, s.max_degree
+FROM ag_degree_stats AS s
+JOIN ag_label AS e ON e.graph = s.graph AND e.id = s.edge_label
+JOIN ag_label AS v ON v.graph = s.graph AND v.id = s.vertex_label
+WHERE s.graph = (SELECT graphid FROM ag_graph WHERE name = 'graph_stats')
+ORDER BY e.name COLLATE "C", s.direction, v.name COLLATE "C";
+
+-- the statistics are used to estimate the pattern joins
+SELECT * FROM cypher('graph_stats', $$
+    MATCH (a:Person)-[:KNOWS]->(b:Person)
+    RETURN a.name, b.name
+    ORDER BY a.name, b.name
+$$) AS (a agtype, b agtype);
+SELECT * FROM cypher('graph_stats', $$
+    MATCH (p:Person)-[:LIVES_IN]->(c:City)
+    RETURN p.name, c.name
+    ORDER BY p.name
+$$) AS (p agtype, c agtype);
+SELECT * FROM cypher('graph_stats', $$
+    MATCH (c:City)-[:KNOWS]->(p:Person)
+    RETURN count(*)
+$$) AS (count agtype);
+
+-- analyzing again replaces the statistics
+SELECT * FROM cypher('graph_stats', $$
+    MATCH (a:Person {name: 'a'}), (x:City)
+    CREATE (a)<-[:LIVES_IN]-(x)
+$$) AS (a agtype);
+SELECT age_analyze_graph('graph_stats');
+SELECT l.name, s.row_count
+FROM ag_label_stats AS s
+JOIN ag_label AS l ON l.graph = s.graph AND l.id = s.label
+WHERE s.graph = (SELECT graphid FROM ag_graph WHERE name = 'graph_stats')
+ORDER BY l.name COLLATE "C";
+
+-- dropping a label drops its statistics
+SELECT count(*) FROM ag_degree_stats
+WHERE graph = (SELECT graphid FROM ag_graph WHERE name = 'graph_stats');
+SELECT drop_label('graph_stats', 'LIVES_IN');
+SELECT count(*) FROM ag_degree_stats
+WHERE graph = (SELECT graphid FROM ag_graph WHERE name = 'graph_stats');
+SELECT count(*) FROM ag_label_stats
+WHERE graph = (SELECT graphid FROM ag_graph WHERE name = 'graph_stats');
+-- invalid arguments
+SELECT age_analyze_graph(NULL);
+SELECT age_analyze_graph('missing_graph');
+
+--
+-- Cleanup
+--
+SELECT * FROM drop_graph('graph_stats', true);
+SELECT count(*) FROM ag_label_stats AS s
+WHERE NOT EXISTS (SELECT 1 FROM ag_graph AS g WHERE g.graphid = s.graph);
+
+--
+-- End of tests
+--
@@ -432,6 +432,169 @@ DROP INDEX cypher_index.city_id_idx;
 DROP INDEX cypher_index.city_west_coast_idx;
 DROP INDEX cypher_index.country_life_exp_idx;
 
+--
+-- Section 5: CREATE INDEX and DROP INDEX in Cypher
+--
+-- an index on a property of a label
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX FOR (c:City) ON (c.country_code)
+$$) as (a agtype);
+-- the property map of a pattern uses it along with the containment
+SELECT * FROM cypher('cypher_index', $$
+    EXPLAIN (costs off) MATCH (c:City {country_code: 'US'})
+    RETURN c.name
+$$) as (plan agtype);
+SELECT * FROM cypher('cypher_index', $$
+    MATCH (c:City {country_code: 'US'})
+    RETURN c.name
+    ORDER BY c.city_id
+$$) as (name agtype);
+-- another index on the same properties
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX FOR (c:City) ON (c.country_code)
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX IF NOT EXISTS FOR (c:City) ON (c.country_code)
+$$) as (a agtype);
+-- a named index on the properties of a relationship
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX has_city_since_idx FOR ()-[r:has_city]->() ON (r.since, r.until)
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX has_city_since_idx FOR ()-[r:has_city]->() ON (r.since)
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX has_city_since_idx IF NOT EXISTS FOR ()-[r:has_city]->() ON (r.since)
+$$) as (a agtype);
+-- the labels that inherit from the label get an index too
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX vertex_name_idx FOR (v:_ag_label_vertex) ON (v.name)
+$$) as (a agtype);
+SELECT indexname, indexdef FROM pg_indexes
+WHERE schemaname = 'cypher_index' AND indexdef LIKE '%agtype_access_operator%'
+ORDER BY indexname COLLATE "C";
+-- errors
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX FOR (n:Missing) ON (n.name)
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX FOR (n:has_city) ON (n.name)
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX FOR (c:City) ON (x.name)
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    CREATE INDEX FOR (:City) ON (c.name)
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    MATCH (c:City) CREATE INDEX FOR (c:City) ON (c.name)
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    DROP INDEX City_pkey
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    DROP INDEX missing_idx
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    DROP INDEX missing_idx IF EXISTS
+$$) as (a agtype);
+-- the indexes of the inheriting labels are dropped with the index
+SELECT * FROM cypher('cypher_index', $$
+    DROP INDEX vertex_name_idx
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    DROP INDEX City_country_code_idx
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    DROP INDEX has_city_since_idx
+$$) as (a agtype);
+SELECT indexname FROM pg_indexes
+WHERE schemaname = 'cypher_index' AND indexdef LIKE '%agtype_access_operator%';
+-- the keywords of the index commands are still names
+SELECT * FROM cypher('cypher_index', $$
+    MATCH (index:Country) RETURN index.name ORDER BY index.name
+$$) as (name agtype);
+SELECT * FROM cypher('cypher_index', $$
+    WITH 1 AS for, 2 AS if, 3 AS drop
+    RETURN for + if + drop
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_index', $$
+    MATCH (unique:City)-[constraint:has_city]->(require:Country {country_code: "MX"})
+    RETURN unique.name, type(constraint), require.name
+    ORDER BY unique.name
+$$) as (city agtype, rel agtype, country agtype);
+
+--
+-- Section 6: Unique constraints and MERGE
+--
+SELECT create_graph('cypher_constraint');
+SELECT * FROM cypher('cypher_constraint', $$
+    CREATE (:User {email: 'a@example.com', name: 'A'})
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_constraint', $$
+    CREATE CONSTRAINT FOR (u:User) REQUIRE u.email IS UNIQUE
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_constraint', $$
+    CREATE CONSTRAINT user_email IF NOT EXISTS FOR (u:User)
+    REQUIRE (u.email) IS UNIQUE
+$$) as (a agtype);
+SELECT indexname, indexdef FROM pg_indexes
+WHERE schemaname = 'cypher_constraint' AND indexdef LIKE '%agtype_access_operator%';
+-- the constraint is enforced
+SELECT * FROM cypher('cypher_constraint', $$
+    CREATE (:User {email: 'a@example.com'})
+$$) as (a agtype);
+-- MERGE matches the vertex that has the unique properties, or creates it
+SELECT * FROM cypher('cypher_constraint', $$
+    MERGE (u:User {email: 'a@example.com'})
+    RETURN u.name
+$$) as (name agtype);
+SELECT * FROM cypher('cypher_constraint', $$
+    MERGE (u:User {email: 'b@example.com'})
+    ON CREATE SET u.created = true
+    RETURN u.email, u.created
+$$) as (email agtype, created agtype);
+SELECT * FROM cypher('cypher_constraint', $$
+    UNWIND ['c@example.com', 'a@example.com', 'c@example.com'] AS e
+    MERGE (u:User {email: e})
+    RETURN u.email
+$$) as (email agtype);
+-- the vertex has the unique properties but does not match the pattern
+SELECT * FROM cypher('cypher_constraint', $$
+    MERGE (u:User {email: 'a@example.com', name: 'Z'})
+    RETURN u.name
+$$) as (name agtype);
+SELECT * FROM cypher('cypher_constraint', $$
+    MATCH (u:User)
+    RETURN u.email, u.name
+    ORDER BY u.email
+$$) as (email agtype, name agtype);
+-- errors
+SELECT * FROM cypher('cypher_constraint', $$
+    CREATE CONSTRAINT FOR (v:_ag_label_vertex) REQUIRE v.email IS UNIQUE
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_constraint', $$
+    CREATE CONSTRAINT FOR (u:User) REQUIRE x.email IS UNIQUE
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_constraint', $$
+    DROP INDEX User_email_key
+$$) as (a agtype);
+-- DROP CONSTRAINT
+SELECT * FROM cypher('cypher_constraint', $$
+    DROP CONSTRAINT User_email_key
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_constraint', $$
+    DROP CONSTRAINT User_email_key IF EXISTS
+$$) as (a agtype);
+-- the constraint cannot be created on duplicates
+SELECT * FROM cypher('cypher_constraint', $$
+    CREATE (:User {email: 'a@example.com'})
+$$) as (a agtype);
+SELECT * FROM cypher('cypher_constraint', $$
+    CREATE CONSTRAINT FOR (u:User) REQUIRE u.email IS UNIQUE
+$$) as (a agtype);
+SELECT drop_graph('cypher_constraint', true);
+
 --
 -- General Cleanup
 --
@@ -0,0 +1,210 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+--
+-- graph algorithm functions
+--
+CREATE FUNCTION ag_catalog.age_degree_centrality(graph_name name,
+                                                 direction text = 'both',
+                                                 edge_label name = NULL,
+                                                 OUT vertex_id graphid,
+                                                 OUT degree bigint,
+                                                 OUT centrality float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_kcore(graph_name name,
+                                     OUT vertex_id graphid,
+                                     OUT core_number bigint)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_random_walks(graph_name name,
+                                            start_ids graphid[] = NULL,
+                                            walk_length int = 10,
+                                            walks_per_node int = 1,
+                                            p float8 = 1.0,
+                                            q float8 = 1.0,
+                                            seed bigint = NULL,
+                                            OUT start_id graphid,
+                                            OUT walk graphid[])
+    RETURNS SETOF record
+    LANGUAGE c
+    VOLATILE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_node_similarity(graph_name name,
+                                               edge_label name = NULL,
+                                               metric text = 'jaccard',
+                                               top_k int = 10,
+                                               OUT source_id graphid,
+                                               OUT target_id graphid,
+                                               OUT similarity float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_similarity(graph_name name, a graphid,
+                                          b graphid,
+                                          metric text = 'jaccard',
+                                          edge_label name = NULL)
+    RETURNS float8
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_label_propagation(graph_name name,
+                                                 edge_label name = NULL,
+                                                 max_iter int = 20,
+                                                 OUT vertex_id graphid,
+                                                 OUT community graphid)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_personalized_pagerank(graph_name name,
+                                                     seed_ids graphid[],
+                                                     alpha float8 = 0.15,
+                                                     epsilon float8 = 1e-6,
+                                                     top_k int = 10,
+                                                     edge_label name = NULL,
+                                                     OUT vertex_id graphid,
+                                                     OUT score float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_project_graph(projection_name name,
+                                             graph_name name,
+                                             vertex_labels name[] = NULL,
+                                             edge_labels name[] = NULL,
+                                             property_keys text[] = NULL,
+                                             OUT vertex_count bigint,
+                                             OUT edge_count bigint)
+    RETURNS record
+    LANGUAGE c
+    VOLATILE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_drop_projection(projection_name name)
+    RETURNS boolean
+    LANGUAGE c
+    VOLATILE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_projections(OUT projection_name name,
+                                           OUT graph_name name,
+                                           OUT vertex_count bigint,
+                                           OUT edge_count bigint)
+    RETURNS SETOF record
+    LANGUAGE c
+    VOLATILE
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_betweenness(graph_name name,
+                                           edge_label name = NULL,
+                                           sample_size int = NULL,
+                                           seed bigint = NULL,
+                                           direction text = 'out',
+                                           OUT vertex_id graphid,
+                                           OUT betweenness float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    VOLATILE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_topological_sort(graph_name name,
+                                                edge_label name = NULL,
+                                                OUT vertex_id graphid,
+                                                OUT position bigint)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_dag_longest_path(graph_name name,
+                                                edge_label name = NULL,
+                                                weight_property text = NULL,
+                                                OUT vertex_ids graphid[],
+                                                OUT edge_ids graphid[],
+                                                OUT length float8)
+    RETURNS record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_khop_count(graph_name name,
+                                          start_ids graphid[] = NULL,
+                                          k int = 1,
+                                          direction text = 'out',
+                                          edge_label name = NULL,
+                                          OUT start_id graphid,
+                                          OUT hop int,
+                                          OUT count bigint)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog.age_minimum_spanning_forest(graph_name name,
+                                                       edge_label name = NULL,
+                                                       weight_property text = NULL,
+                                                       OUT edge_id graphid,
+                                                       OUT weight float8,
+                                                       OUT total_weight float8)
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
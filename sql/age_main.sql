@@ -75,6 +75,42 @@ CREATE UNIQUE INDEX ag_label_seq_name_graph_index
     ON ag_label
     USING btree (seq_name, graph);
 
+--
+-- graph statistics, collected by age_analyze_graph()
+--
+
+-- number of entities of a label, the default labels count all labels
+CREATE TABLE ag_label_stats (
+                                graph oid NOT NULL,
+                                label label_id,
+                                row_count bigint NOT NULL
+);
+
+CREATE UNIQUE INDEX ag_label_stats_graph_label_index
+    ON ag_label_stats
+    USING btree (graph, label);
+
+-- degrees along start_id ('o') or end_id ('i') of the edges of edge_label,
+-- over the vertices of vertex_label that have at least one such edge
+CREATE TABLE ag_degree_stats (
+                                 graph oid NOT NULL,
+                                 edge_label label_id,
+                                 direction "char" NOT NULL
+                                     CHECK (direction = 'o' OR direction = 'i'),
+                                 vertex_label label_id,
+                                 edge_count bigint NOT NULL,
+                                 vertex_count bigint NOT NULL,
+                                 avg_degree float8 NOT NULL,
+                                 p50_degree float8 NOT NULL,
+                                 p90_degree float8 NOT NULL,
+                                 p99_degree float8 NOT NULL,
+                                 max_degree bigint NOT NULL
+);
+
+CREATE UNIQUE INDEX ag_degree_stats_graph_label_index
+    ON ag_degree_stats
+    USING btree (graph, edge_label, direction, vertex_label);
+
 --
 -- catalog lookup functions
 --
@@ -110,6 +146,11 @@ CREATE FUNCTION ag_catalog.drop_graph(graph_name name, cascade boolean = false)
     LANGUAGE c
     AS 'MODULE_PATHNAME';
 
+CREATE FUNCTION ag_catalog.age_analyze_graph(graph_name name)
+    RETURNS void
+    LANGUAGE c
+    AS 'MODULE_PATHNAME';
+
 CREATE FUNCTION ag_catalog.create_vlabel(graph_name cstring, label_name cstring)
     RETURNS void
     LANGUAGE c
@@ -216,6 +257,15 @@ RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
 
+-- join selectivity of '=' using the graph statistics
+CREATE FUNCTION ag_catalog.graphid_eqjoinsel(internal, oid, internal, int2,
+                                             internal)
+    RETURNS float8
+    LANGUAGE c
+    STABLE
+PARALLEL SAFE
+AS 'MODULE_PATHNAME';
+
 CREATE OPERATOR = (
   FUNCTION = ag_catalog.graphid_eq,
   LEFTARG = graphid,
@@ -223,7 +273,7 @@ CREATE OPERATOR = (
   COMMUTATOR = =,
   NEGATOR = <>,
   RESTRICT = eqsel,
-  JOIN = eqjoinsel,
+  JOIN = ag_catalog.graphid_eqjoinsel,
   HASHES,
   MERGES
 );
@@ -43,6 +43,36 @@ CREATE FUNCTION ag_catalog._cypher_merge_clause(internal)
     LANGUAGE c
     AS 'MODULE_PATHNAME';
 
+--
+-- functions for schema commands
+--
+
+-- They return no rows. The sets only fit the column definition list of cypher().
+CREATE FUNCTION ag_catalog._cypher_create_property_index(graph_name name,
+                                                         label_name name,
+                                                         label_kind "char",
+                                                         property_keys text[],
+                                                         index_name name,
+                                                         if_not_exists boolean,
+                                                         is_unique boolean)
+    RETURNS SETOF agtype
+    LANGUAGE c
+    VOLATILE
+    CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
+CREATE FUNCTION ag_catalog._cypher_drop_property_index(graph_name name,
+                                                       index_name name,
+                                                       if_exists boolean,
+                                                       is_unique boolean)
+    RETURNS SETOF agtype
+    LANGUAGE c
+    VOLATILE
+    CALLED ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
 --
 -- query functions
 --
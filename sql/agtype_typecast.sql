@@ -132,6 +132,22 @@ RETURNS NULL ON NULL INPUT
 PARALLEL SAFE
 AS 'MODULE_PATHNAME';
 
+-- joins a cyclic MATCH pattern over the adjacency of the global graph
+CREATE FUNCTION ag_catalog.age_match_cycle(graph_name name,
+                                           vertex_labels text[],
+                                           edge_labels text[],
+                                           edge_starts int[],
+                                           edge_ends int[],
+                                           edge_directed boolean[],
+                                           OUT vertex_ids graphid[],
+                                           OUT edge_ids graphid[])
+    RETURNS SETOF record
+    LANGUAGE c
+    STABLE
+RETURNS NULL ON NULL INPUT
+PARALLEL UNSAFE
+AS 'MODULE_PATHNAME';
+
 -- list functions
 CREATE FUNCTION ag_catalog.age_keys(agtype)
     RETURNS agtype
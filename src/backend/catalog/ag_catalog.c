@@ -31,6 +31,7 @@
 
 #include "catalog/ag_graph.h"
 #include "catalog/ag_label.h"
+#include "catalog/ag_label_stats.h"
 #include "utils/ag_cache.h"
 #include "utils/age_global_graph.h"
 
@@ -261,10 +262,11 @@ static void object_access(ObjectAccessType access, Oid class_id, Oid object_id,
         if (drop_arg->dropflags & PERFORM_DELETION_INTERNAL)
         {
             /*
-             * Remove the corresponding ag_label entry here first. We don't
-             * know whether this operation is drop_label() or a part of
-             * drop_graph().
+             * Remove the corresponding ag_label entry, and the statistics
+             * that mention the label, here first. We don't know whether this
+             * operation is drop_label() or a part of drop_graph().
              */
+            delete_label_stats(cache_data->graph, cache_data->id);
             delete_label(object_id);
         }
         else
@@ -0,0 +1,514 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/htup_details.h"
+#include "access/table.h"
+#include "catalog/indexing.h"
+#include "utils/catcache.h"
+#include "utils/fmgroids.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+
+#include "catalog/ag_label_stats.h"
+#include "catalog/ag_namespace.h"
+#include "utils/graphid.h"
+
+/*
+ * The planner asks for the same statistics once per join clause and path, so
+ * they are cached per backend. Misses are cached too; a graph that was never
+ * analyzed has no rows at all.
+ */
+typedef struct label_stats_cache_key
+{
+    Oid graph_oid;
+    int32 label_id;
+} label_stats_cache_key;
+
+typedef struct label_stats_cache_entry
+{
+    label_stats_cache_key key; /* hash key */
+    bool found;
+    int64 row_count;
+} label_stats_cache_entry;
+
+typedef struct degree_stats_cache_key
+{
+    Oid graph_oid;
+    int32 edge_label_id;
+    int32 vertex_label_id;
+    char direction;
+} degree_stats_cache_key;
+
+typedef struct degree_stats_cache_entry
+{
+    degree_stats_cache_key key; /* hash key */
+    bool found;
+    degree_stats stats;
+} degree_stats_cache_entry;
+
+static HTAB *label_stats_cache_hash = NULL;
+static HTAB *degree_stats_cache_hash = NULL;
+
+/* the catalogs the cached entries were read from */
+static Oid label_stats_relid = InvalidOid;
+static Oid degree_stats_relid = InvalidOid;
+
+static Oid get_stats_relation_id(const char *name);
+static void delete_stats_rows(const char *table_name, const char *index_name,
+                              Oid graph_oid, int32 label_id,
+                              AttrNumber *attnos, int nattnos);
+static void initialize_stats_caches(void);
+static void invalidate_stats_caches(Datum arg, Oid relid);
+static void flush_stats_cache(HTAB *hash);
+static bool search_label_stats_miss(Oid relid, Oid graph_oid, int32 label_id,
+                                    int64 *row_count);
+static bool search_degree_stats_miss(Oid relid, Oid graph_oid,
+                                     int32 edge_label_id, char direction,
+                                     int32 vertex_label_id,
+                                     degree_stats *stats);
+
+/*
+ * The statistics catalogs were added after the label catalog. Look them up
+ * without erroring out so that dropping a label still works while the
+ * extension has not been updated yet.
+ */
+static Oid get_stats_relation_id(const char *name)
+{
+    return get_relname_relid(name, ag_catalog_namespace_id());
+}
+
+static void initialize_stats_caches(void)
+{
+    HASHCTL hash_ctl;
+
+    if (label_stats_cache_hash)
+    {
+        return;
+    }
+    if (!CacheMemoryContext)
+    {
+        CreateCacheMemoryContext();
+    }
+
+    MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+    hash_ctl.keysize = sizeof(label_stats_cache_key);
+    hash_ctl.entrysize = sizeof(label_stats_cache_entry);
+    label_stats_cache_hash = hash_create("ag_label_stats cache", 16,
+                                         &hash_ctl, HASH_ELEM | HASH_BLOBS);
+
+    MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+    hash_ctl.keysize = sizeof(degree_stats_cache_key);
+    hash_ctl.entrysize = sizeof(degree_stats_cache_entry);
+    degree_stats_cache_hash = hash_create("ag_degree_stats cache", 16,
+                                          &hash_ctl, HASH_ELEM | HASH_BLOBS);
+
+    /*
+     * The writers below invalidate the relcache entry of the catalog they
+     * change, which reaches this backend at the next command and the other
+     * backends at commit.
+     */
+    CacheRegisterRelcacheCallback(invalidate_stats_caches, (Datum)0);
+}
+
+static void invalidate_stats_caches(Datum arg, Oid relid)
+{
+    if (relid == InvalidOid || relid == label_stats_relid)
+    {
+        flush_stats_cache(label_stats_cache_hash);
+    }
+    if (relid == InvalidOid || relid == degree_stats_relid)
+    {
+        flush_stats_cache(degree_stats_cache_hash);
+    }
+}
+
+static void flush_stats_cache(HTAB *hash)
+{
+    HASH_SEQ_STATUS hash_seq;
+    void *entry;
+
+    /* the key is the first field of both entry types */
+    hash_seq_init(&hash_seq, hash);
+    while ((entry = hash_seq_search(&hash_seq)) != NULL)
+    {
+        hash_search(hash, entry, HASH_REMOVE, NULL);
+    }
+}
+
+/* INSERT INTO ag_catalog.ag_label_stats VALUES (graph, label, row_count) */
+void insert_label_stats(Oid graph_oid, int32 label_id, int64 row_count)
+{
+    Datum values[Natts_ag_label_stats];
+    bool nulls[Natts_ag_label_stats];
+    Relation ag_label_stats;
+    HeapTuple tuple;
+
+    ag_label_stats = table_open(ag_relation_id(AG_LABEL_STATS_TABLE, "table"),
+                                RowExclusiveLock);
+
+    values[Anum_ag_label_stats_graph - 1] = ObjectIdGetDatum(graph_oid);
+    nulls[Anum_ag_label_stats_graph - 1] = false;
+
+    values[Anum_ag_label_stats_label - 1] = Int32GetDatum(label_id);
+    nulls[Anum_ag_label_stats_label - 1] = false;
+
+    values[Anum_ag_label_stats_row_count - 1] = Int64GetDatum(row_count);
+    nulls[Anum_ag_label_stats_row_count - 1] = false;
+
+    tuple = heap_form_tuple(RelationGetDescr(ag_label_stats), values, nulls);
+    CatalogTupleInsert(ag_label_stats, tuple);
+    CacheInvalidateRelcache(ag_label_stats);
+
+    table_close(ag_label_stats, RowExclusiveLock);
+}
+
+/*
+ * INSERT INTO ag_catalog.ag_degree_stats
+ * VALUES (graph, edge_label, direction, vertex_label, stats...)
+ */
+void insert_degree_stats(Oid graph_oid, int32 edge_label_id, char direction,
+                         int32 vertex_label_id, degree_stats *stats)
+{
+    Datum values[Natts_ag_degree_stats];
+    bool nulls[Natts_ag_degree_stats];
+    Relation ag_degree_stats;
+    HeapTuple tuple;
+
+    Assert(direction == DEGREE_STATS_OUT || direction == DEGREE_STATS_IN);
+
+    ag_degree_stats = table_open(ag_relation_id(AG_DEGREE_STATS_TABLE,
+                                                "table"),
+                                 RowExclusiveLock);
+
+    memset(nulls, false, sizeof(nulls));
+
+    values[Anum_ag_degree_stats_graph - 1] = ObjectIdGetDatum(graph_oid);
+    values[Anum_ag_degree_stats_edge_label - 1] = Int32GetDatum(edge_label_id);
+    values[Anum_ag_degree_stats_direction - 1] = CharGetDatum(direction);
+    values[Anum_ag_degree_stats_vertex_label - 1] =
+        Int32GetDatum(vertex_label_id);
+    values[Anum_ag_degree_stats_edge_count - 1] =
+        Int64GetDatum(stats->edge_count);
+    values[Anum_ag_degree_stats_vertex_count - 1] =
+        Int64GetDatum(stats->vertex_count);
+    values[Anum_ag_degree_stats_avg_degree - 1] =
+        Float8GetDatum(stats->avg_degree);
+    values[Anum_ag_degree_stats_p50_degree - 1] =
+        Float8GetDatum(stats->p50_degree);
+    values[Anum_ag_degree_stats_p90_degree - 1] =
+        Float8GetDatum(stats->p90_degree);
+    values[Anum_ag_degree_stats_p99_degree - 1] =
+        Float8GetDatum(stats->p99_degree);
+    values[Anum_ag_degree_stats_max_degree - 1] =
+        Int64GetDatum(stats->max_degree);
+
+    tuple = heap_form_tuple(RelationGetDescr(ag_degree_stats), values, nulls);
+    CatalogTupleInsert(ag_degree_stats, tuple);
+    CacheInvalidateRelcache(ag_degree_stats);
+
+    table_close(ag_degree_stats, RowExclusiveLock);
+}
+
+/*
+ * DELETE FROM ag_catalog.ag_label_stats WHERE graph = graph_oid
+ * DELETE FROM ag_catalog.ag_degree_stats WHERE graph = graph_oid
+ */
+void delete_graph_stats(Oid graph_oid)
+{
+    delete_label_stats(graph_oid, INVALID_LABEL_ID);
+}
+
+/*
+ * Removes the statistics that mention the given label, or all statistics of
+ * the graph if label_id is INVALID_LABEL_ID.
+ */
+void delete_label_stats(Oid graph_oid, int32 label_id)
+{
+    AttrNumber label_stats_attnos[1] = {Anum_ag_label_stats_label};
+    AttrNumber degree_stats_attnos[2] = {Anum_ag_degree_stats_edge_label,
+                                         Anum_ag_degree_stats_vertex_label};
+
+    delete_stats_rows(AG_LABEL_STATS_TABLE, AG_LABEL_STATS_INDEX, graph_oid,
+                      label_id, label_stats_attnos, 1);
+    delete_stats_rows(AG_DEGREE_STATS_TABLE, AG_DEGREE_STATS_INDEX, graph_oid,
+                      label_id, degree_stats_attnos, 2);
+}
+
+/*
+ * Deletes the rows of the graph whose label columns, given by attnos, match
+ * label_id. Every row of the graph matches INVALID_LABEL_ID. Both catalogs
+ * have the graph as their first column and leading index key.
+ */
+static void delete_stats_rows(const char *table_name, const char *index_name,
+                              Oid graph_oid, int32 label_id,
+                              AttrNumber *attnos, int nattnos)
+{
+    ScanKeyData scan_keys[1];
+    Oid relid = get_stats_relation_id(table_name);
+    Relation rel;
+    SysScanDesc scan_desc;
+    HeapTuple tuple;
+    bool deleted = false;
+
+    if (!OidIsValid(relid))
+    {
+        return;
+    }
+
+    ScanKeyInit(&scan_keys[0], 1, BTEqualStrategyNumber, F_OIDEQ,
+                ObjectIdGetDatum(graph_oid));
+
+    rel = table_open(relid, RowExclusiveLock);
+    scan_desc = systable_beginscan(rel, ag_relation_id(index_name, "index"),
+                                   true, NULL, 1, scan_keys);
+
+    while (HeapTupleIsValid(tuple = systable_getnext(scan_desc)))
+    {
+        bool matches = (label_id == INVALID_LABEL_ID);
+        int i;
+
+        for (i = 0; i < nattnos && !matches; i++)
+        {
+            bool isnull;
+            Datum label = heap_getattr(tuple, attnos[i],
+                                       RelationGetDescr(rel), &isnull);
+
+            matches = (DatumGetInt32(label) == label_id);
+        }
+
+        if (matches)
+        {
+            CatalogTupleDelete(rel, &tuple->t_self);
+            deleted = true;
+        }
+    }
+
+    systable_endscan(scan_desc);
+
+    if (deleted)
+    {
+        CacheInvalidateRelcache(rel);
+    }
+
+    table_close(rel, RowExclusiveLock);
+}
+
+/*
+ * Returns the row count of the label, as of the last age_analyze_graph() of
+ * the graph, or false if there is none.
+ */
+bool get_label_stats(Oid graph_oid, int32 label_id, int64 *row_count)
+{
+    label_stats_cache_key key;
+    label_stats_cache_entry *entry;
+    Oid relid = get_stats_relation_id(AG_LABEL_STATS_TABLE);
+
+    if (!OidIsValid(relid))
+    {
+        return false;
+    }
+
+    initialize_stats_caches();
+    label_stats_relid = relid;
+
+    MemSet(&key, 0, sizeof(key));
+    key.graph_oid = graph_oid;
+    key.label_id = label_id;
+
+    entry = hash_search(label_stats_cache_hash, &key, HASH_FIND, NULL);
+    if (!entry)
+    {
+        int64 count = 0;
+        bool found;
+
+        /* the scan may process invalidations, so enter the entry after it */
+        found = search_label_stats_miss(relid, graph_oid, label_id, &count);
+
+        entry = hash_search(label_stats_cache_hash, &key, HASH_ENTER, NULL);
+        entry->found = found;
+        entry->row_count = count;
+    }
+
+    if (entry->found)
+    {
+        *row_count = entry->row_count;
+    }
+
+    return entry->found;
+}
+
+/*
+ * Returns the degree statistics of the edge label in the given direction,
+ * restricted to the vertex label, or false if there are none.
+ */
+bool get_degree_stats(Oid graph_oid, int32 edge_label_id, char direction,
+                      int32 vertex_label_id, degree_stats *stats)
+{
+    degree_stats_cache_key key;
+    degree_stats_cache_entry *entry;
+    Oid relid = get_stats_relation_id(AG_DEGREE_STATS_TABLE);
+
+    if (!OidIsValid(relid))
+    {
+        return false;
+    }
+
+    initialize_stats_caches();
+    degree_stats_relid = relid;
+
+    MemSet(&key, 0, sizeof(key));
+    key.graph_oid = graph_oid;
+    key.edge_label_id = edge_label_id;
+    key.vertex_label_id = vertex_label_id;
+    key.direction = direction;
+
+    entry = hash_search(degree_stats_cache_hash, &key, HASH_FIND, NULL);
+    if (!entry)
+    {
+        degree_stats found_stats;
+        bool found;
+
+        MemSet(&found_stats, 0, sizeof(found_stats));
+        found = search_degree_stats_miss(relid, graph_oid, edge_label_id,
+                                         direction, vertex_label_id,
+                                         &found_stats);
+
+        entry = hash_search(degree_stats_cache_hash, &key, HASH_ENTER, NULL);
+        entry->found = found;
+        entry->stats = found_stats;
+    }
+
+    if (entry->found)
+    {
+        *stats = entry->stats;
+    }
+
+    return entry->found;
+}
+
+/*
+ * SELECT row_count FROM ag_catalog.ag_label_stats
+ * WHERE graph = graph_oid AND label = label_id
+ */
+static bool search_label_stats_miss(Oid relid, Oid graph_oid, int32 label_id,
+                                    int64 *row_count)
+{
+    ScanKeyData scan_keys[2];
+    Relation ag_label_stats;
+    SysScanDesc scan_desc;
+    HeapTuple tuple;
+    bool found = false;
+
+    ScanKeyInit(&scan_keys[0], Anum_ag_label_stats_graph,
+                BTEqualStrategyNumber, F_OIDEQ, ObjectIdGetDatum(graph_oid));
+    ScanKeyInit(&scan_keys[1], Anum_ag_label_stats_label,
+                BTEqualStrategyNumber, F_INT4EQ, Int32GetDatum(label_id));
+
+    ag_label_stats = table_open(relid, AccessShareLock);
+    scan_desc = systable_beginscan(ag_label_stats,
+                                   ag_relation_id(AG_LABEL_STATS_INDEX,
+                                                  "index"),
+                                   true, NULL, 2, scan_keys);
+
+    tuple = systable_getnext(scan_desc);
+    if (HeapTupleIsValid(tuple))
+    {
+        bool isnull;
+
+        *row_count = DatumGetInt64(heap_getattr(tuple,
+                                                Anum_ag_label_stats_row_count,
+                                                RelationGetDescr(ag_label_stats),
+                                                &isnull));
+        found = true;
+    }
+
+    systable_endscan(scan_desc);
+    table_close(ag_label_stats, AccessShareLock);
+
+    return found;
+}
+
+/*
+ * SELECT * FROM ag_catalog.ag_degree_stats
+ * WHERE graph = graph_oid AND edge_label = edge_label_id
+ *   AND direction = direction AND vertex_label = vertex_label_id
+ */
+static bool search_degree_stats_miss(Oid relid, Oid graph_oid,
+                                     int32 edge_label_id, char direction,
+                                     int32 vertex_label_id,
+                                     degree_stats *stats)
+{
+    ScanKeyData scan_keys[4];
+    Relation ag_degree_stats;
+    SysScanDesc scan_desc;
+    HeapTuple tuple;
+    bool found = false;
+
+    ScanKeyInit(&scan_keys[0], Anum_ag_degree_stats_graph,
+                BTEqualStrategyNumber, F_OIDEQ, ObjectIdGetDatum(graph_oid));
+    ScanKeyInit(&scan_keys[1], Anum_ag_degree_stats_edge_label,
+                BTEqualStrategyNumber, F_INT4EQ, Int32GetDatum(edge_label_id));
+    ScanKeyInit(&scan_keys[2], Anum_ag_degree_stats_direction,
+                BTEqualStrategyNumber, F_CHAREQ, CharGetDatum(direction));
+    ScanKeyInit(&scan_keys[3], Anum_ag_degree_stats_vertex_label,
+                BTEqualStrategyNumber, F_INT4EQ,
+                Int32GetDatum(vertex_label_id));
+
+    ag_degree_stats = table_open(relid, AccessShareLock);
+    scan_desc = systable_beginscan(ag_degree_stats,
+                                   ag_relation_id(AG_DEGREE_STATS_INDEX,
+                                                  "index"),
+                                   true, NULL, 4, scan_keys);
+
+    tuple = systable_getnext(scan_desc);
+    if (HeapTupleIsValid(tuple))
+    {
+        TupleDesc tupdesc = RelationGetDescr(ag_degree_stats);
+        Datum values[Natts_ag_degree_stats];
+        bool nulls[Natts_ag_degree_stats];
+
+        heap_deform_tuple(tuple, tupdesc, values, nulls);
+
+        stats->edge_count =
+            DatumGetInt64(values[Anum_ag_degree_stats_edge_count - 1]);
+        stats->vertex_count =
+            DatumGetInt64(values[Anum_ag_degree_stats_vertex_count - 1]);
+        stats->avg_degree =
+            DatumGetFloat8(values[Anum_ag_degree_stats_avg_degree - 1]);
+        stats->p50_degree =
+            DatumGetFloat8(values[Anum_ag_degree_stats_p50_degree - 1]);
+        stats->p90_degree =
+            DatumGetFloat8(values[Anum_ag_degree_stats_p90_degree - 1]);
+        stats->p99_degree =
+            DatumGetFloat8(values[Anum_ag_degree_stats_p99_degree - 1]);
+        stats->max_degree =
+            DatumGetInt64(values[Anum_ag_degree_stats_max_degree - 1]);
+        found = true;
+    }
+
+    systable_endscan(scan_desc);
+    table_close(ag_degree_stats, AccessShareLock);
+
+    return found;
+}
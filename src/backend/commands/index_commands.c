@@ -0,0 +1,665 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/table.h"
+#include "access/xact.h"
+#include "catalog/dependency.h"
+#include "catalog/index.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_am_d.h"
+#include "catalog/pg_class_d.h"
+#include "catalog/pg_inherits.h"
+#include "catalog/pg_type_d.h"
+#include "commands/defrem.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "storage/lmgr.h"
+#include "tcop/utility.h"
+#include "utils/acl.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/json.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/relcache.h"
+
+#include "catalog/ag_label.h"
+#include "commands/index_commands.h"
+#include "commands/label_commands.h"
+#include "utils/ag_cache.h"
+#include "utils/ag_func.h"
+#include "utils/agtype.h"
+
+static void define_property_index(char *graph_name, char *label_name,
+                                  char label_kind, List *keys,
+                                  char *index_name, bool unique,
+                                  bool if_not_exists);
+static char *choose_property_index_name(char *rel_name, List *keys,
+                                        bool unique, Oid nsp_id);
+static void create_property_index(char *schema_name, char *rel_name,
+                                  char *index_name, List *keys, bool unique);
+static Node *build_property_access_expr(char *key);
+static List *get_property_index_keys(Relation index_rel,
+                                     AttrNumber properties_attnum);
+static char *get_property_access_key(Node *expr, AttrNumber properties_attnum);
+static List *get_array_text_list(ArrayType *array);
+
+PG_FUNCTION_INFO_V1(_cypher_create_property_index);
+
+/*
+ * Executes CREATE INDEX and CREATE CONSTRAINT of Cypher. It takes the graph
+ * name, the label name, the label kind, the property keys, the index name
+ * (NULL to choose one), whether an existing index is fine, and whether the
+ * index is a unique constraint. It returns no rows; it only returns a set to
+ * fit the column definition list of cypher().
+ */
+Datum _cypher_create_property_index(PG_FUNCTION_ARGS)
+{
+    FuncCallContext *funcctx;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        char *index_name = NULL;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+
+        if (PG_ARGISNULL(0) || PG_ARGISNULL(1) || PG_ARGISNULL(2) ||
+            PG_ARGISNULL(3) || PG_ARGISNULL(5) || PG_ARGISNULL(6))
+        {
+            ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                            errmsg("_cypher_create_property_index: only the index name can be NULL")));
+        }
+
+        if (!PG_ARGISNULL(4))
+        {
+            index_name = NameStr(*PG_GETARG_NAME(4));
+        }
+
+        define_property_index(NameStr(*PG_GETARG_NAME(0)),
+                              NameStr(*PG_GETARG_NAME(1)), PG_GETARG_CHAR(2),
+                              get_array_text_list(PG_GETARG_ARRAYTYPE_P(3)),
+                              index_name, PG_GETARG_BOOL(6),
+                              PG_GETARG_BOOL(5));
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+
+    SRF_RETURN_DONE(funcctx);
+}
+
+PG_FUNCTION_INFO_V1(_cypher_drop_property_index);
+
+/*
+ * Executes DROP INDEX and DROP CONSTRAINT of Cypher. It takes the graph name,
+ * the index name, whether a missing index is fine, and whether the index is a
+ * unique constraint. Only the indexes on the properties of a label can be
+ * dropped this way, and DROP INDEX does not drop a constraint. Like
+ * _cypher_create_property_index(), it returns no rows.
+ */
+Datum _cypher_drop_property_index(PG_FUNCTION_ARGS)
+{
+    FuncCallContext *funcctx;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        char *graph_name;
+        char *index_name;
+        bool unique;
+        char *object_type;
+        graph_cache_data *graph_cache;
+        Oid index_oid;
+        Oid rel_oid = InvalidOid;
+        bool is_property_index = false;
+        ObjectAddress address;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+
+        if (PG_ARGISNULL(0) || PG_ARGISNULL(1) || PG_ARGISNULL(2) ||
+            PG_ARGISNULL(3))
+        {
+            ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                            errmsg("_cypher_drop_property_index: arguments must not be NULL")));
+        }
+
+        graph_name = NameStr(*PG_GETARG_NAME(0));
+        index_name = NameStr(*PG_GETARG_NAME(1));
+        unique = PG_GETARG_BOOL(3);
+        object_type = unique ? "constraint" : "index";
+
+        graph_cache = search_graph_name_cache(graph_name);
+        if (graph_cache == NULL)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_UNDEFINED_SCHEMA),
+                     errmsg("graph \"%s\" does not exist", graph_name)));
+        }
+
+        index_oid = get_relname_relid(index_name, graph_cache->namespace);
+        if (OidIsValid(index_oid) &&
+            get_rel_relkind(index_oid) == RELKIND_INDEX)
+        {
+            rel_oid = IndexGetRelation(index_oid, false);
+
+            /* lock the table before its index like DROP INDEX does */
+            LockRelationOid(rel_oid, AccessExclusiveLock);
+
+            if (search_label_relation_cache(rel_oid) != NULL)
+            {
+                Relation index_rel;
+
+                index_rel = index_open(index_oid, AccessExclusiveLock);
+                is_property_index =
+                    (index_rel->rd_index->indisunique == unique &&
+                     get_property_index_keys(
+                         index_rel,
+                         get_attnum(rel_oid,
+                                    AG_VERTEX_COLNAME_PROPERTIES)) != NIL);
+                index_close(index_rel, NoLock);
+            }
+        }
+
+        if (!is_property_index)
+        {
+            if (!PG_GETARG_BOOL(2))
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_UNDEFINED_OBJECT),
+                         errmsg("%s \"%s\" does not exist", object_type,
+                                index_name)));
+            }
+
+            ereport(NOTICE,
+                    (errmsg("%s \"%s\" does not exist, skipping", object_type,
+                            index_name)));
+        }
+        else
+        {
+            if (!object_ownercheck(RelationRelationId, index_oid, GetUserId()))
+            {
+                aclcheck_error(ACLCHECK_NOT_OWNER, OBJECT_INDEX, index_name);
+            }
+
+            /* the indexes of the inheriting tables go with it */
+            ObjectAddressSet(address, RelationRelationId, index_oid);
+            performDeletion(&address, DROP_RESTRICT, 0);
+        }
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+
+    SRF_RETURN_DONE(funcctx);
+}
+
+/*
+ * Creates an index on the given properties of the label. The tables that
+ * inherit from the label's table get an index of their own because indexes
+ * are not inherited. Those depend on the index of the label to be dropped
+ * with it.
+ *
+ * A unique index is only unique within its table. So, unique constraints are
+ * limited to the labels that no other label inherits from.
+ */
+static void define_property_index(char *graph_name, char *label_name,
+                                  char label_kind, List *keys,
+                                  char *index_name, bool unique,
+                                  bool if_not_exists)
+{
+    graph_cache_data *graph_cache;
+    label_cache_data *label_cache;
+    char *schema_name;
+    char *rel_name;
+    Oid nsp_id;
+    Oid label_relation;
+    List *indexes;
+    List *children;
+    ListCell *lc;
+    Oid index_oid;
+    ObjectAddress index_address;
+    char *object_type = unique ? "constraint" : "index";
+    char *an_object_type = unique ? "a constraint" : "an index";
+
+    graph_cache = search_graph_name_cache(graph_name);
+    if (graph_cache == NULL)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_UNDEFINED_SCHEMA),
+                 errmsg("graph \"%s\" does not exist", graph_name)));
+    }
+
+    label_cache = search_label_name_graph_cache(label_name, graph_cache->oid);
+    if (label_cache == NULL)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_UNDEFINED_TABLE),
+                 errmsg("label \"%s\" does not exist", label_name)));
+    }
+    if (label_cache->kind != label_kind)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_WRONG_OBJECT_TYPE),
+                 errmsg("label \"%s\" is not a %s label", label_name,
+                        label_kind == LABEL_KIND_VERTEX ? "vertex" : "edge")));
+    }
+
+    /* the cache entries may go away with the invalidations below */
+    nsp_id = graph_cache->namespace;
+    label_relation = label_cache->relation;
+
+    if (unique && find_inheritance_children(label_relation, NoLock) != NIL)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("label \"%s\" cannot have a unique constraint",
+                        label_name),
+                 errdetail("Other labels inherit from it.")));
+    }
+
+    if (index_name != NULL &&
+        OidIsValid(get_relname_relid(index_name, nsp_id)))
+    {
+        if (!if_not_exists)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_DUPLICATE_TABLE),
+                     errmsg("relation \"%s\" already exists", index_name)));
+        }
+
+        ereport(NOTICE,
+                (errmsg("relation \"%s\" already exists, skipping",
+                        index_name)));
+        return;
+    }
+
+    /* another index on the same properties would be of no use */
+    indexes = get_label_property_indexes(label_relation);
+    foreach (lc, indexes)
+    {
+        property_index *index = lfirst(lc);
+        char *existing_name;
+
+        if (index->unique != unique || !equal(index->keys, keys))
+        {
+            continue;
+        }
+
+        existing_name = get_rel_name(index->index_oid);
+        if (!if_not_exists)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_DUPLICATE_OBJECT),
+                     errmsg("label \"%s\" already has %s on the same properties",
+                            label_name, an_object_type),
+                     errdetail("The %s is \"%s\".", object_type,
+                               existing_name)));
+        }
+
+        ereport(NOTICE,
+                (errmsg("label \"%s\" already has %s \"%s\" on the same properties, skipping",
+                        label_name, an_object_type, existing_name)));
+        return;
+    }
+
+    schema_name = get_namespace_name(nsp_id);
+    rel_name = get_rel_name(label_relation);
+
+    if (index_name == NULL)
+    {
+        index_name = choose_property_index_name(rel_name, keys, unique,
+                                                nsp_id);
+    }
+
+    create_property_index(schema_name, rel_name, index_name, keys, unique);
+    CommandCounterIncrement();
+
+    index_oid = get_relname_relid(index_name, nsp_id);
+    Assert(OidIsValid(index_oid));
+    ObjectAddressSet(index_address, RelationRelationId, index_oid);
+
+    children = find_all_inheritors(label_relation, ShareLock, NULL);
+    foreach (lc, children)
+    {
+        Oid child_oid = lfirst_oid(lc);
+        char *child_rel_name;
+        char *child_index_name;
+        ObjectAddress child_index_address;
+
+        if (child_oid == label_relation)
+        {
+            continue;
+        }
+
+        child_rel_name = get_rel_name(child_oid);
+        child_index_name = choose_property_index_name(child_rel_name, keys,
+                                                      unique, nsp_id);
+
+        create_property_index(schema_name, child_rel_name, child_index_name,
+                              keys, unique);
+        CommandCounterIncrement();
+
+        ObjectAddressSet(child_index_address, RelationRelationId,
+                         get_relname_relid(child_index_name, nsp_id));
+        recordDependencyOn(&child_index_address, &index_address,
+                           DEPENDENCY_AUTO);
+    }
+
+    CommandCounterIncrement();
+}
+
+/*
+ * <rel_name>_<key>[_<key> ...]_idx, or _key for a unique index like the
+ * unique constraints of Postgres, made unique in the namespace
+ */
+static char *choose_property_index_name(char *rel_name, List *keys,
+                                        bool unique, Oid nsp_id)
+{
+    StringInfoData buf;
+    ListCell *lc;
+
+    initStringInfo(&buf);
+    foreach (lc, keys)
+    {
+        if (buf.len > 0)
+        {
+            appendStringInfoChar(&buf, '_');
+        }
+        appendStringInfoString(&buf, strVal(lfirst(lc)));
+    }
+
+    return ChooseRelationName(rel_name, buf.data, unique ? "key" : "idx",
+                              nsp_id, false);
+}
+
+/*
+ * CREATE [UNIQUE] INDEX `index_name` ON `schema_name`.`rel_name`
+ * (ag_catalog.agtype_access_operator(properties, '"key"'::agtype), ...)
+ */
+static void create_property_index(char *schema_name, char *rel_name,
+                                  char *index_name, List *keys, bool unique)
+{
+    IndexStmt *index_stmt;
+    List *index_params = NIL;
+    ListCell *lc;
+    PlannedStmt *index_wrapper;
+
+    foreach (lc, keys)
+    {
+        IndexElem *index_elem;
+
+        index_elem = makeNode(IndexElem);
+        index_elem->name = NULL;
+        index_elem->expr = build_property_access_expr(strVal(lfirst(lc)));
+        index_elem->indexcolname = NULL;
+        index_elem->collation = NIL;
+        index_elem->opclass = NIL;
+        index_elem->opclassopts = NIL;
+        index_elem->ordering = SORTBY_DEFAULT;
+        index_elem->nulls_ordering = SORTBY_NULLS_DEFAULT;
+
+        index_params = lappend(index_params, index_elem);
+    }
+
+    index_stmt = makeNode(IndexStmt);
+    index_stmt->idxname = index_name;
+    index_stmt->relation = makeRangeVar(schema_name, rel_name, -1);
+    index_stmt->accessMethod = "btree";
+    index_stmt->tableSpace = NULL;
+    index_stmt->indexParams = index_params;
+    index_stmt->options = NIL;
+    index_stmt->whereClause = NULL;
+    index_stmt->excludeOpNames = NIL;
+    index_stmt->idxcomment = NULL;
+    index_stmt->indexOid = InvalidOid;
+    index_stmt->unique = unique;
+    index_stmt->nulls_not_distinct = false;
+    index_stmt->primary = false;
+    index_stmt->isconstraint = false;
+    index_stmt->deferrable = false;
+    index_stmt->initdeferred = false;
+    index_stmt->transformed = false;
+    index_stmt->concurrent = false;
+    index_stmt->if_not_exists = false;
+    index_stmt->reset_default_tblspc = false;
+
+    index_wrapper = makeNode(PlannedStmt);
+    index_wrapper->commandType = CMD_UTILITY;
+    index_wrapper->canSetTag = false;
+    index_wrapper->utilityStmt = (Node *)index_stmt;
+    index_wrapper->stmt_location = -1;
+    index_wrapper->stmt_len = 0;
+
+    ProcessUtility(index_wrapper, "(generated CREATE INDEX command)", false,
+                   PROCESS_UTILITY_SUBCOMMAND, NULL, NULL, None_Receiver,
+                   NULL);
+}
+
+/*
+ * ag_catalog.agtype_access_operator(properties, '"key"'::agtype)
+ *
+ * It is analyzed into the same expression as n.key is transformed into.
+ */
+static Node *build_property_access_expr(char *key)
+{
+    ColumnRef *properties;
+    StringInfoData key_json;
+    A_Const *key_const;
+    TypeCast *key_cast;
+
+    properties = makeNode(ColumnRef);
+    properties->fields = list_make1(makeString(AG_VERTEX_COLNAME_PROPERTIES));
+    properties->location = -1;
+
+    initStringInfo(&key_json);
+    escape_json(&key_json, key);
+
+    key_const = makeNode(A_Const);
+    key_const->val.sval.type = T_String;
+    key_const->val.sval.sval = key_json.data;
+    key_const->location = -1;
+
+    key_cast = makeNode(TypeCast);
+    key_cast->arg = (Node *)key_const;
+    key_cast->typeName = makeTypeNameFromNameList(
+        list_make2(makeString("ag_catalog"), makeString("agtype")));
+    key_cast->location = -1;
+
+    return (Node *)makeFuncCall(
+        list_make2(makeString("ag_catalog"),
+                   makeString("agtype_access_operator")),
+        list_make2(properties, key_cast), COERCE_EXPLICIT_CALL, -1);
+}
+
+/* Returns the property indexes of the label's table. */
+List *get_label_property_indexes(Oid label_relation)
+{
+    Relation rel;
+    AttrNumber properties_attnum;
+    List *index_oids;
+    List *indexes = NIL;
+    ListCell *lc;
+
+    rel = table_open(label_relation, AccessShareLock);
+    properties_attnum = get_attnum(label_relation,
+                                   AG_VERTEX_COLNAME_PROPERTIES);
+
+    index_oids = RelationGetIndexList(rel);
+    foreach (lc, index_oids)
+    {
+        Relation index_rel;
+        List *keys;
+
+        index_rel = index_open(lfirst_oid(lc), AccessShareLock);
+
+        keys = get_property_index_keys(index_rel, properties_attnum);
+        if (keys != NIL)
+        {
+            property_index *index = palloc(sizeof(property_index));
+
+            index->index_oid = RelationGetRelid(index_rel);
+            index->unique = index_rel->rd_index->indisunique;
+            index->keys = keys;
+
+            indexes = lappend(indexes, index);
+        }
+
+        index_close(index_rel, AccessShareLock);
+    }
+
+    list_free(index_oids);
+    table_close(rel, NoLock);
+
+    return indexes;
+}
+
+/*
+ * Returns the property keys of the index if it is a valid btree index whose
+ * columns are all property accesses and that covers every row of the table.
+ * Otherwise, returns NIL.
+ */
+static List *get_property_index_keys(Relation index_rel,
+                                     AttrNumber properties_attnum)
+{
+    Form_pg_index index_form = index_rel->rd_index;
+    List *keys = NIL;
+    ListCell *lc;
+    int i;
+
+    if (index_rel->rd_rel->relam != BTREE_AM_OID || !index_form->indisvalid ||
+        RelationGetIndexPredicate(index_rel) != NIL)
+    {
+        return NIL;
+    }
+
+    /* expression columns have no attribute number */
+    for (i = 0; i < index_form->indnatts; i++)
+    {
+        if (index_form->indkey.values[i] != 0)
+        {
+            return NIL;
+        }
+    }
+
+    foreach (lc, RelationGetIndexExpressions(index_rel))
+    {
+        char *key = get_property_access_key(lfirst(lc), properties_attnum);
+
+        if (key == NULL)
+        {
+            return NIL;
+        }
+
+        keys = lappend(keys, makeString(key));
+    }
+
+    return keys;
+}
+
+/*
+ * Returns the key if the expression is
+ * agtype_access_operator(VARIADIC ARRAY[properties, '"key"'::agtype]).
+ * Otherwise, returns NULL.
+ */
+static char *get_property_access_key(Node *expr, AttrNumber properties_attnum)
+{
+    FuncExpr *func_expr;
+    ArrayExpr *array_expr;
+    Var *var;
+    Const *key_const;
+    agtype *key_agt;
+    agtype_value *key_agtv;
+
+    if (!IsA(expr, FuncExpr))
+    {
+        return NULL;
+    }
+
+    func_expr = (FuncExpr *)expr;
+    if (func_expr->funcid != get_ag_func_oid("agtype_access_operator", 1,
+                                             AGTYPEARRAYOID) ||
+        list_length(func_expr->args) != 1 ||
+        !IsA(linitial(func_expr->args), ArrayExpr))
+    {
+        return NULL;
+    }
+
+    array_expr = linitial(func_expr->args);
+    if (list_length(array_expr->elements) != 2 ||
+        !IsA(linitial(array_expr->elements), Var) ||
+        !IsA(lsecond(array_expr->elements), Const))
+    {
+        return NULL;
+    }
+
+    var = linitial(array_expr->elements);
+    key_const = lsecond(array_expr->elements);
+    if (var->varattno != properties_attnum || key_const->constisnull ||
+        key_const->consttype != AGTYPEOID)
+    {
+        return NULL;
+    }
+
+    key_agt = DATUM_GET_AGTYPE_P(key_const->constvalue);
+    if (!AGT_ROOT_IS_SCALAR(key_agt))
+    {
+        return NULL;
+    }
+
+    key_agtv = get_ith_agtype_value_from_container(&key_agt->root, 0);
+    if (key_agtv->type != AGTV_STRING)
+    {
+        return NULL;
+    }
+
+    return pnstrdup(key_agtv->val.string.val, key_agtv->val.string.len);
+}
+
+/* converts a text[] into a List of String nodes */
+static List *get_array_text_list(ArrayType *array)
+{
+    Datum *elems;
+    bool *nulls;
+    int nelems;
+    List *list = NIL;
+    int i;
+
+    deconstruct_array(array, TEXTOID, -1, false, TYPALIGN_INT, &elems, &nulls,
+                      &nelems);
+
+    for (i = 0; i < nelems; i++)
+    {
+        if (nulls[i])
+        {
+            ereport(ERROR, (errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+                            errmsg("property key must not be NULL")));
+        }
+
+        list = lappend(list, makeString(TextDatumGetCString(elems[i])));
+    }
+
+    if (list == NIL)
+    {
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("an index needs at least one property")));
+    }
+
+    return list;
+}
@@ -40,6 +40,8 @@
 #include "catalog/ag_label.h"
 #include "commands/label_commands.h"
 #include "utils/ag_cache.h"
+#include "utils/ag_guc.h"
+#include "utils/graphid.h"
 #include "utils/name_validation.h"
 
 /*
@@ -51,7 +53,7 @@
 static void create_table_for_label(char *graph_name, char *label_name,
                                    char *schema_name, char *rel_name,
                                    char *seq_name, char label_type,
-                                   List *parents);
+                                   int32 label_id, List *parents);
 
 /* common */
 static List *create_edge_table_elements(char *graph_name, char *label_name,
@@ -68,6 +70,7 @@ static FuncCall *build_id_default_func_expr(char *graph_name, char *label_name,
                                             char *schema_name, char *seq_name);
 static Constraint *build_not_null_constraint(void);
 static Constraint *build_properties_default(void);
+static Constraint *build_label_id_check_constraint(int32 label_id);
 static void alter_sequence_owned_by_for_label(RangeVar *seq_range_var,
                                               char *rel_name);
 static int32 get_new_label_id(Oid graph_oid, Oid nsp_id);
@@ -334,9 +337,12 @@ void create_label(char *graph_name, char *label_name, char label_type,
     seq_range_var = makeRangeVar(schema_name, seq_name, -1);
     create_sequence_for_label(seq_range_var);
 
+    /* get a new "id" for the new label, the table's constraint needs it */
+    label_id = get_new_label_id(graph_oid, nsp_id);
+
     /* create a table for the new label */
     create_table_for_label(graph_name, label_name, schema_name, rel_name,
-                           seq_name, label_type, parents);
+                           seq_name, label_type, label_id, parents);
 
     /* record the new label in ag_label */
     relation_id = get_relname_relid(rel_name, nsp_id);
@@ -349,9 +355,6 @@ void create_label(char *graph_name, char *label_name, char label_type,
     /* associate the sequence with the "id" column */
     alter_sequence_owned_by_for_label(seq_range_var, rel_name);
 
-    /* get a new "id" for the new label */
-    label_id = get_new_label_id(graph_oid, nsp_id);
-
     insert_label(label_name, graph_oid, label_id, label_type,
                  relation_id, seq_name);
 
@@ -363,13 +366,14 @@ void create_label(char *graph_name, char *label_name, char label_type,
  * "id" graphid PRIMARY KEY DEFAULT "ag_catalog"."_graphid"(...),
  * "start_id" graphid NOT NULL note: only for edge labels
  * "end_id" graphid NOT NULL  note: only for edge labels
- * "properties" agtype NOT NULL DEFAULT "ag_catalog"."agtype_build_map"()
+ * "properties" agtype NOT NULL DEFAULT "ag_catalog"."agtype_build_map"(),
+ * CONSTRAINT "_age_label_id_check" CHECK ("id" ...) NO INHERIT
  * )
  */
 static void create_table_for_label(char *graph_name, char *label_name,
                                    char *schema_name, char *rel_name,
                                    char *seq_name, char label_type,
-                                   List *parents)
+                                   int32 label_id, List *parents)
 {
     CreateStmt *create_stmt;
     PlannedStmt *wrapper;
@@ -407,7 +411,8 @@ static void create_table_for_label(char *graph_name, char *label_name,
     create_stmt->inhRelations = parents;
     create_stmt->partbound = NULL;
     create_stmt->ofTypename = NULL;
-    create_stmt->constraints = NIL;
+    create_stmt->constraints = list_make1(
+        build_label_id_check_constraint(label_id));
     create_stmt->options = NIL;
     create_stmt->oncommit = ONCOMMIT_NOOP;
     create_stmt->tablespacename = NULL;
@@ -615,7 +620,10 @@ static List *create_vertex_table_elements(char *graph_name, char *label_name,
     return list_make2(id, props);
 }
 
-/* CREATE SEQUENCE `seq_range_var` MAXVALUE `LOCAL_ID_MAX` */
+/*
+ * CREATE SEQUENCE `seq_range_var` MAXVALUE `LOCAL_ID_MAX`
+ * CACHE `age.graphid_block_size`
+ */
 static void create_sequence_for_label(RangeVar *seq_range_var)
 {
     ParseState *pstate;
@@ -623,6 +631,7 @@ static void create_sequence_for_label(RangeVar *seq_range_var)
     /* greater than MAXINT8LEN+1 */
     char buf[32];
     DefElem *maxvalue;
+    DefElem *cache;
 
     pstate = make_parsestate(NULL);
     pstate->p_sourcetext = "(generated CREATE SEQUENCE command)";
@@ -631,7 +640,9 @@ static void create_sequence_for_label(RangeVar *seq_range_var)
     seq_stmt->sequence = seq_range_var;
     pg_lltoa(ENTRY_ID_MAX, buf);
     maxvalue = makeDefElem("maxvalue", (Node *)makeFloat(pstrdup(buf)), -1);
-    seq_stmt->options = list_make1(maxvalue);
+    cache = makeDefElem("cache", (Node *)makeInteger(age_graphid_block_size),
+                        -1);
+    seq_stmt->options = list_make2(maxvalue, cache);
     seq_stmt->ownerId = InvalidOid;
     seq_stmt->for_identity = false;
     seq_stmt->if_not_exists = false;
@@ -774,6 +785,74 @@ static Constraint *build_properties_default(void)
     return props_default;
 }
 
+/*
+ * CONSTRAINT "_age_label_id_check"
+ * CHECK ("id" >= '...'::graphid AND "id" <= '...'::graphid) NO INHERIT
+ *
+ * Every id of the label carries label_id in its upper bits, so the ids fall
+ * in one range. Stating the range lets constraint exclusion skip the tables
+ * of the other labels when a query compares "id", or anything equal to it
+ * like "start_id" and "end_id" of an edge, with constants. It must not be
+ * inherited because the default label tables are the parents of the others.
+ */
+static Constraint *build_label_id_check_constraint(int32 label_id)
+{
+    graphid bounds[2];
+    char *opnames[2] = {">=", "<="};
+    List *args = NIL;
+    BoolExpr *range;
+    Constraint *check;
+    int i;
+
+    bounds[0] = make_graphid(label_id, ENTRY_ID_MIN);
+    bounds[1] = make_graphid(label_id, ENTRY_ID_MAX);
+
+    for (i = 0; i < 2; i++)
+    {
+        ColumnRef *id;
+        A_Const *bound_const;
+        TypeCast *bound;
+
+        id = makeNode(ColumnRef);
+        id->fields = list_make1(makeString("id"));
+        id->location = -1;
+
+        bound_const = makeNode(A_Const);
+        bound_const->val.sval.type = T_String;
+        bound_const->val.sval.sval = psprintf(INT64_FORMAT, bounds[i]);
+        bound_const->location = -1;
+
+        bound = makeNode(TypeCast);
+        bound->arg = (Node *)bound_const;
+        bound->typeName = makeTypeNameFromNameList(
+            list_make2(makeString("ag_catalog"), makeString("graphid")));
+        bound->location = -1;
+
+        args = lappend(args, makeSimpleA_Expr(AEXPR_OP, opnames[i],
+                                              (Node *)id, (Node *)bound, -1));
+    }
+
+    range = makeNode(BoolExpr);
+    range->boolop = AND_EXPR;
+    range->args = args;
+    range->location = -1;
+
+    check = makeNode(Constraint);
+    check->contype = CONSTR_CHECK;
+    check->conname = AG_LABEL_ID_CHECK_NAME;
+    check->location = -1;
+    check->is_no_inherit = true;
+    check->raw_expr = (Node *)range;
+    check->cooked_expr = NULL;
+    check->skip_validation = false;
+    check->initially_valid = true;
+#if PG_VERSION_NUM >= 180000
+    check->is_enforced = true;
+#endif
+
+    return check;
+}
+
 /*
  * Alter the default constraint on the label's id to the use the given
  * sequence.
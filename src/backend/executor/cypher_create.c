@@ -25,6 +25,7 @@
 #include "catalog/ag_label.h"
 #include "executor/cypher_executor.h"
 #include "executor/cypher_utils.h"
+#include "utils/ag_graphid_cache.h"
 #include "utils/age_global_graph.h"
 
 static void begin_cypher_create(CustomScanState *node, EState *estate,
@@ -42,6 +43,10 @@ static Datum create_vertex(cypher_create_custom_scan_state *css,
                            List *list);
 
 static void process_pattern(cypher_create_custom_scan_state *css);
+static void insert_created_entity(cypher_create_custom_scan_state *css,
+                                  cypher_target_node *node, EState *estate);
+static entity_insert_buffer *
+find_insert_buffer(cypher_create_custom_scan_state *css, Oid relid);
 
 
 const CustomExecMethods cypher_create_exec_methods = {CREATE_SCAN_STATE_NAME,
@@ -113,12 +118,6 @@ static void begin_cypher_create(CustomScanState *node, EState *estate,
             cypher_node->elemTupleSlot = table_slot_create(
                 rel, &estate->es_tupleTable);
 
-            if (cypher_node->id_expr != NULL)
-            {
-                cypher_node->id_expr_state =
-                    ExecInitExpr(cypher_node->id_expr, (PlanState *)node);
-            }
-
             if (cypher_node->prop_expr != NULL)
             {
                 cypher_node->prop_expr_state = ExecInitExpr(cypher_node->prop_expr,
@@ -130,6 +129,19 @@ static void begin_cypher_create(CustomScanState *node, EState *estate,
             {
                 setup_wcos(cypher_node->resultRelInfo, estate, node, CMD_INSERT);
             }
+
+            /*
+             * Nothing reads the entities of a terminal CREATE clause before it
+             * is done, so they are buffered and inserted in batches instead of
+             * one by one. Target nodes of the same label share a buffer.
+             */
+            if (CYPHER_CLAUSE_IS_TERMINAL(css->flags) &&
+                find_insert_buffer(css, cypher_node->relid) == NULL)
+            {
+                css->insert_buffers = lappend(
+                    css->insert_buffers,
+                    create_entity_insert_buffer(cypher_node->resultRelInfo));
+            }
         }
     }
 
@@ -200,6 +212,7 @@ static TupleTableSlot *exec_cypher_create(CustomScanState *node)
     TupleTableSlot *slot;
     bool terminal = CYPHER_CLAUSE_IS_TERMINAL(css->flags);
     bool used = false;
+    ListCell *lc;
 
     /*
      * If the CREATE clause was the final cypher clause written then we aren't
@@ -238,6 +251,12 @@ static TupleTableSlot *exec_cypher_create(CustomScanState *node)
         }
     } while (terminal);
 
+    /* insert what is left in the buffers of a terminal CREATE */
+    foreach (lc, css->insert_buffers)
+    {
+        flush_entity_insert_buffer(lfirst(lc), estate);
+    }
+
     /*
      * If the current command Id wasn't used, nothing was inserted and we're
      * done.
@@ -274,6 +293,13 @@ static void end_cypher_create(CustomScanState *node)
 
     ExecEndNode(node->ss.ps.lefttree);
 
+    foreach (lc, css->insert_buffers)
+    {
+        free_entity_insert_buffer(lfirst(lc));
+    }
+    list_free(css->insert_buffers);
+    css->insert_buffers = NIL;
+
     foreach (lc, css->pattern)
     {
         cypher_create_path *path = lfirst(lc);
@@ -324,6 +350,7 @@ Node *create_cypher_create_plan_state(CustomScan *cscan)
     Assert(is_ag_node(target_nodes, cypher_create_target_nodes));
 
     cypher_css->path_values = NIL;
+    cypher_css->insert_buffers = NIL;
     cypher_css->pattern = target_nodes->paths;
     cypher_css->flags = target_nodes->flags;
     cypher_css->graph_oid = target_nodes->graph_oid;
@@ -341,7 +368,6 @@ static void create_edge(cypher_create_custom_scan_state *css,
                         cypher_target_node *node, Datum prev_vertex_id,
                         ListCell *next, List *list)
 {
-    bool isNull;
     EState *estate = css->css.ss.ps.state;
     ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
     ResultRelInfo *resultRelInfo = node->resultRelInfo;
@@ -399,9 +425,9 @@ static void create_edge(cypher_create_custom_scan_state *css,
     ExecClearTuple(elemTupleSlot);
 
     /* Graph Id for the edge */
-    id = ExecEvalExpr(node->id_expr_state, econtext, &isNull);
+    id = GRAPHID_GET_DATUM(get_next_label_graphid(node->relid));
     elemTupleSlot->tts_values[edge_tuple_id] = id;
-    elemTupleSlot->tts_isnull[edge_tuple_id] = isNull;
+    elemTupleSlot->tts_isnull[edge_tuple_id] = false;
 
     /* Graph id for the starting vertex */
     elemTupleSlot->tts_values[edge_tuple_start_id] = start_id;
@@ -418,7 +444,7 @@ static void create_edge(cypher_create_custom_scan_state *css,
         scanTupleSlot->tts_isnull[node->prop_attr_num];
 
     /* Insert the new edge */
-    insert_entity_tuple(resultRelInfo, elemTupleSlot, estate);
+    insert_created_entity(css, node, estate);
 
     /* restore the old result relation info */
     estate->es_result_relations = old_estate_es_result_relations;
@@ -460,7 +486,6 @@ static void create_edge(cypher_create_custom_scan_state *css,
 static Datum create_vertex(cypher_create_custom_scan_state *css,
                            cypher_target_node *node, ListCell *next, List *list)
 {
-    bool isNull;
     Datum id;
     EState *estate = css->css.ss.ps.state;
     ExprContext *econtext = css->css.ss.ps.ps_ExprContext;
@@ -494,9 +519,9 @@ static Datum create_vertex(cypher_create_custom_scan_state *css,
         ExecClearTuple(elemTupleSlot);
 
         /* get the next graphid for this vertex. */
-        id = ExecEvalExpr(node->id_expr_state, econtext, &isNull);
+        id = GRAPHID_GET_DATUM(get_next_label_graphid(node->relid));
         elemTupleSlot->tts_values[vertex_tuple_id] = id;
-        elemTupleSlot->tts_isnull[vertex_tuple_id] = isNull;
+        elemTupleSlot->tts_isnull[vertex_tuple_id] = false;
 
         /* get the properties for this vertex */
         elemTupleSlot->tts_values[vertex_tuple_properties] =
@@ -505,7 +530,7 @@ static Datum create_vertex(cypher_create_custom_scan_state *css,
             scanTupleSlot->tts_isnull[node->prop_attr_num];
 
         /* Insert the new vertex */
-        insert_entity_tuple(resultRelInfo, elemTupleSlot, estate);
+        insert_created_entity(css, node, estate);
 
         /* restore the old result relation info */
         estate->es_result_relations = old_estate_es_result_relations;
@@ -616,3 +641,42 @@ static Datum create_vertex(cypher_create_custom_scan_state *css,
     return id;
 }
 
+
+/*
+ * Insert the entity in the target node's elemTupleSlot, or add it to the
+ * buffer of its label if the clause is terminal.
+ */
+static void insert_created_entity(cypher_create_custom_scan_state *css,
+                                  cypher_target_node *node, EState *estate)
+{
+    entity_insert_buffer *buffer;
+
+    buffer = find_insert_buffer(css, node->relid);
+    if (buffer != NULL)
+    {
+        buffer_entity_tuple(buffer, node->resultRelInfo, node->elemTupleSlot,
+                            estate);
+    }
+    else
+    {
+        insert_entity_tuple(node->resultRelInfo, node->elemTupleSlot, estate);
+    }
+}
+
+static entity_insert_buffer *
+find_insert_buffer(cypher_create_custom_scan_state *css, Oid relid)
+{
+    ListCell *lc;
+
+    foreach (lc, css->insert_buffers)
+    {
+        entity_insert_buffer *buffer = lfirst(lc);
+
+        if (RelationGetRelid(buffer->resultRelInfo->ri_RelationDesc) == relid)
+        {
+            return buffer;
+        }
+    }
+
+    return NULL;
+}
@@ -30,6 +30,7 @@
 #include "executor/cypher_executor.h"
 #include "utils/age_global_graph.h"
 #include "executor/cypher_utils.h"
+#include "utils/ag_cache.h"
 
 static void begin_cypher_delete(CustomScanState *node, EState *estate,
                                 int eflags);
@@ -40,6 +41,13 @@ static void rescan_cypher_delete(CustomScanState *node);
 static void process_delete_list(CustomScanState *node);
 
 static void check_for_connected_edges(CustomScanState *node);
+static bool check_for_connected_edges_by_adjacency(CustomScanState *node);
+static void delete_connected_edge(cypher_delete_custom_scan_state *css,
+                                  EState *estate,
+                                  ResultRelInfo *resultRelInfo, Oid relid,
+                                  char *label_name, bool rls_enabled,
+                                  List *qualExprs, ExprContext *econtext,
+                                  TupleTableSlot *slot);
 static agtype_value *extract_entity(CustomScanState *node,
                                     TupleTableSlot *scanTupleSlot,
                                     int entity_position);
@@ -570,6 +578,63 @@ static void process_delete_list(CustomScanState *node)
     hash_destroy(index_cache);
 }
 
+/*
+ * The edge in slot is connected to a deleted vertex. For DETACH DELETE, delete
+ * it; otherwise, throw an error.
+ */
+static void delete_connected_edge(cypher_delete_custom_scan_state *css,
+                                  EState *estate,
+                                  ResultRelInfo *resultRelInfo, Oid relid,
+                                  char *label_name, bool rls_enabled,
+                                  List *qualExprs, ExprContext *econtext,
+                                  TupleTableSlot *slot)
+{
+    AclResult aclresult;
+    HeapTuple tuple;
+    bool shouldFree;
+
+    if (!css->delete_data->detach)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INTERNAL_ERROR),
+                 errmsg("Cannot delete a vertex that has edge(s). "
+                        "Delete the edge(s) first, or try DETACH DELETE.")));
+    }
+
+    /* Check that the user has DELETE permission on the edge table */
+    aclresult = pg_class_aclcheck(relid, GetUserId(), ACL_DELETE);
+    if (aclresult != ACLCHECK_OK)
+    {
+        aclcheck_error(aclresult, OBJECT_TABLE, label_name);
+    }
+
+    /* Check RLS security quals (USING policy) before delete */
+    if (rls_enabled)
+    {
+        /*
+         * For DETACH DELETE, error out if edge RLS check fails. Unlike normal
+         * DELETE which silently skips, we cannot silently skip edges here as
+         * it would leave dangling edges pointing to deleted vertices.
+         */
+        if (!check_security_quals(qualExprs, slot, econtext))
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+                     errmsg("cannot delete edge due to row-level security policy on \"%s\"",
+                            label_name),
+                     errhint("DETACH DELETE requires permission to delete all connected edges.")));
+        }
+    }
+
+    tuple = ExecFetchSlotHeapTuple(slot, true, &shouldFree);
+    delete_entity(estate, resultRelInfo, tuple);
+
+    if (shouldFree)
+    {
+        heap_freetuple(tuple);
+    }
+}
+
 /*
  * Helper function to scan an edge table using a specific index (start_id or end_id)
  * and delete the connected edges if the vertex is being deleted.
@@ -628,47 +693,9 @@ static void process_edges_by_index(Oid index_oid,
             }
 
             /* If edge found - delete it (or error if not DETACH) */
-            if (css->delete_data->detach)
-            {
-                AclResult aclresult;
-                bool shouldFree;
-                HeapTuple tuple;
-
-                /* Check that the user has DELETE permission on the edge table */
-                aclresult = pg_class_aclcheck(relid, GetUserId(), ACL_DELETE);
-                if (aclresult != ACLCHECK_OK)
-                {
-                    aclcheck_error(aclresult, OBJECT_TABLE, label_name);
-                }
-
-                /* Check RLS security quals (USING policy) before delete */
-                if (rls_enabled)
-                {
-                    if (!check_security_quals(qualExprs, slot, econtext))
-                    {
-                        ereport(ERROR,
-                                (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
-                                    errmsg("cannot delete edge due to row-level security policy on \"%s\"",
-                                        label_name),
-                                    errhint("DETACH DELETE requires permission to delete all connected edges.")));
-                    }
-                }
-                
-                tuple = ExecFetchSlotHeapTuple(slot, true, &shouldFree);
-                delete_entity(estate, resultRelInfo, tuple);
-                
-                if (shouldFree) 
-                {
-                    heap_freetuple(tuple);
-                }
-            }
-            else
-            {
-                ereport(ERROR,
-                    (errcode(ERRCODE_INTERNAL_ERROR),
-                        errmsg("Cannot delete a vertex that has edge(s). "
-                            "Delete the edge(s) first, or try DETACH DELETE.")));
-            }
+            delete_connected_edge(css, estate, resultRelInfo, relid,
+                                  label_name, rls_enabled, qualExprs,
+                                  econtext, slot);
             ExecClearTuple(slot);
         }
     }
@@ -690,6 +717,17 @@ static void check_for_connected_edges(CustomScanState *node)
     EState *estate = css->css.ss.ps.state;
     char *graph_name = css->delete_data->graph_name;
 
+    /* no vertex was deleted, so there are no edges to look for */
+    if (hash_get_num_entries(css->vertex_id_htab) == 0)
+    {
+        return;
+    }
+
+    if (check_for_connected_edges_by_adjacency(node))
+    {
+        return;
+    }
+
     /* scans each label from css->edge_labels */
     foreach (lc, css->edge_labels)
     {
@@ -785,53 +823,214 @@ static void check_for_connected_edges(CustomScanState *node)
 
                 if (found_startid || found_endid)
                 {
-                    if (css->delete_data->detach)
-                    {
-                        AclResult aclresult;
-
-                        /* Check that the user has DELETE permission on the edge table */
-                        aclresult = pg_class_aclcheck(relid, GetUserId(), ACL_DELETE);
-                        if (aclresult != ACLCHECK_OK)
-                        {
-                            aclcheck_error(aclresult, OBJECT_TABLE, label_name);
-                        }
-
-                        /* Check RLS security quals (USING policy) before delete */
-                        if (rls_enabled)
-                        {
-                            /*
-                             * For DETACH DELETE, error out if edge RLS check fails.
-                             * Unlike normal DELETE which silently skips, we cannot
-                             * silently skip edges here as it would leave dangling
-                             * edges pointing to deleted vertices.
-                             */
-                            if (!check_security_quals(qualExprs, slot, econtext))
-                            {
-                                ereport(ERROR,
-                                        (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
-                                         errmsg("cannot delete edge due to row-level security policy on \"%s\"",
-                                                label_name),
-                                         errhint("DETACH DELETE requires permission to delete all connected edges.")));
-                            }
-                        }
-
-                        delete_entity(estate, resultRelInfo, tuple);
-                    }
-                    else
+                    delete_connected_edge(css, estate, resultRelInfo, relid,
+                                          label_name, rls_enabled, qualExprs,
+                                          econtext, slot);
+                }
+            }
+
+            table_endscan(scan_desc);
+        }
+
+        destroy_entity_result_rel_info(resultRelInfo);
+    }
+}
+
+/* the edges of one label that are connected to the deleted vertices */
+typedef struct connected_label_edges
+{
+    Oid relid;
+    List *edges; /* edge_entry pointers */
+} connected_label_edges;
+
+/*
+ * Finds the edges connected to the deleted vertices through the adjacency of
+ * the graph's global context, when the context has every edge the statement
+ * sees, and handles them as check_for_connected_edges does. The edges are
+ * fetched by the TIDs the context recorded, and edge labels that none of
+ * them belongs to are not read at all.
+ *
+ * Returns false if the edges have to be found by scanning the edge labels.
+ * That is the case if there is no such context, or if a TID turns out to hold
+ * another edge. Edges deleted here before that are invisible to the scan.
+ */
+static bool check_for_connected_edges_by_adjacency(CustomScanState *node)
+{
+    cypher_delete_custom_scan_state *css =
+        (cypher_delete_custom_scan_state *)node;
+    EState *estate = css->css.ss.ps.state;
+    char *graph_name = css->delete_data->graph_name;
+    GRAPH_global_context *ggctx;
+    HASH_SEQ_STATUS hash_status;
+    HASHCTL hashctl;
+    HTAB *edge_id_htab;
+    graphid *vid;
+    List *label_edges_list = NIL;
+    ListCell *lc;
+    bool complete = true;
+
+    ggctx = find_GRAPH_global_context(css->delete_data->graph_oid);
+    if (ggctx == NULL || !is_ggctx_current(ggctx, estate->es_snapshot))
+    {
+        return false;
+    }
+
+    /* an edge between two deleted vertices is found from both of them */
+    MemSet(&hashctl, 0, sizeof(hashctl));
+    hashctl.keysize = sizeof(graphid);
+    hashctl.entrysize = sizeof(graphid);
+    hashctl.hash = tag_hash;
+    hashctl.hcxt = CurrentMemoryContext;
+    edge_id_htab = hash_create("delete_edge_id_htab", 64, &hashctl,
+                               HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+    /* group the connected edges by their label */
+    hash_seq_init(&hash_status, css->vertex_id_htab);
+    while ((vid = (graphid *)hash_seq_search(&hash_status)) != NULL)
+    {
+        vertex_entry *ve;
+        VertexEdgeArray *edge_arrays[3];
+        int i;
+
+        ve = get_vertex_entry(ggctx, *vid);
+        if (ve == NULL)
+        {
+            continue;
+        }
+
+        edge_arrays[0] = get_vertex_entry_edges_out_array(ve);
+        edge_arrays[1] = get_vertex_entry_edges_in_array(ve);
+        edge_arrays[2] = get_vertex_entry_edges_self_array(ve);
+
+        for (i = 0; i < 3; i++)
+        {
+            int32 j;
+
+            for (j = 0; j < edge_arrays[i]->size; j++)
+            {
+                graphid edge_id = edge_arrays[i]->array[j];
+                connected_label_edges *label_edges = NULL;
+                edge_entry *ee;
+                Oid relid;
+                bool found;
+
+                hash_search(edge_id_htab, (void *)&edge_id, HASH_ENTER,
+                            &found);
+                if (found)
+                {
+                    continue;
+                }
+
+                ee = get_edge_entry(ggctx, edge_id);
+                if (ee == NULL)
+                {
+                    continue;
+                }
+
+                relid = get_edge_entry_label_table_oid(ee);
+
+                foreach (lc, label_edges_list)
+                {
+                    connected_label_edges *e = lfirst(lc);
+
+                    if (e->relid == relid)
                     {
-                        ereport(
-                            ERROR,
-                            (errcode(ERRCODE_INTERNAL_ERROR),
-                             errmsg(
-                                 "Cannot delete a vertex that has edge(s). "
-                                 "Delete the edge(s) first, or try DETACH DELETE.")));
+                        label_edges = e;
+                        break;
                     }
                 }
+
+                if (label_edges == NULL)
+                {
+                    label_edges = palloc(sizeof(connected_label_edges));
+                    label_edges->relid = relid;
+                    label_edges->edges = NIL;
+                    label_edges_list = lappend(label_edges_list, label_edges);
+                }
+
+                label_edges->edges = lappend(label_edges->edges, ee);
             }
+        }
+    }
 
-            table_endscan(scan_desc);
+    hash_destroy(edge_id_htab);
+
+    foreach (lc, label_edges_list)
+    {
+        connected_label_edges *label_edges = lfirst(lc);
+        label_cache_data *label_cache;
+        ResultRelInfo *resultRelInfo;
+        TupleTableSlot *slot;
+        Relation rel;
+        char *label_name;
+        bool rls_enabled = false;
+        List *qualExprs = NIL;
+        ExprContext *econtext = NULL;
+        ListCell *lc2;
+
+        label_cache = search_label_relation_cache(label_edges->relid);
+        if (label_cache == NULL)
+        {
+            complete = false;
+            break;
+        }
+        label_name = pstrdup(NameStr(label_cache->name));
+
+        resultRelInfo = create_entity_result_rel_info(estate, graph_name,
+                                                      label_name);
+        rel = resultRelInfo->ri_RelationDesc;
+        estate->es_snapshot->curcid = GetCurrentCommandId(false);
+        estate->es_output_cid = GetCurrentCommandId(false);
+
+        if (css->delete_data->detach &&
+            check_enable_rls(label_edges->relid, InvalidOid, true) ==
+                RLS_ENABLED)
+        {
+            rls_enabled = true;
+            econtext = css->css.ss.ps.ps_ExprContext;
+            qualExprs = setup_security_quals(resultRelInfo, estate, node,
+                                             CMD_DELETE);
         }
 
+        slot = table_slot_create(rel, NULL);
+
+        foreach (lc2, label_edges->edges)
+        {
+            edge_entry *ee = lfirst(lc2);
+            graphid id;
+            bool isnull;
+
+            /* the edge may have been deleted by this DELETE clause already */
+            if (!table_tuple_fetch_row_version(rel, get_edge_entry_tid(ee),
+                                               estate->es_snapshot, slot))
+            {
+                continue;
+            }
+
+            id = DATUM_GET_GRAPHID(slot_getattr(slot,
+                                                Anum_ag_label_edge_table_id,
+                                                &isnull));
+            if (id != get_edge_entry_id(ee))
+            {
+                complete = false;
+                ExecClearTuple(slot);
+                break;
+            }
+
+            delete_connected_edge(css, estate, resultRelInfo,
+                                  label_edges->relid, label_name, rls_enabled,
+                                  qualExprs, econtext, slot);
+            ExecClearTuple(slot);
+        }
+
+        ExecDropSingleTupleTableSlot(slot);
         destroy_entity_result_rel_info(resultRelInfo);
+
+        if (!complete)
+        {
+            break;
+        }
     }
+
+    return complete;
 }
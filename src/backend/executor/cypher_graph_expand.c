@@ -0,0 +1,245 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include "access/tableam.h"
+#include "executor/executor.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+
+#include "executor/cypher_executor.h"
+#include "utils/ag_cache.h"
+#include "utils/age_global_graph.h"
+
+/*
+ * Graph Expand scans the edges of one edge label table that are incident to
+ * a bound vertex. The vertex's adjacency lists in the graph's global context
+ * give the candidate edges, the label id encoded in their graphids skips
+ * those of other labels, and the rest are fetched by TID with the scan's
+ * snapshot, so an edge the context still lists but that is no longer
+ * visible is skipped.
+ */
+typedef struct cypher_graph_expand_scan_state
+{
+    CustomScanState css;
+    ExprState *vertex_id_expr_state; /* the bound vertex */
+    bool outgoing;                   /* expand out-edges, or in-edges */
+    char *graph_name;
+    Oid graph_oid;
+    int32 label_id;                  /* label id of the scanned table */
+    GRAPH_global_context *ggctx;     /* loaded on the first fetch */
+    bool vertex_loaded;              /* edges below are for this scan */
+    VertexEdgeArray *edges;          /* out- or in-edges of the vertex */
+    VertexEdgeArray *self_edges;     /* self loops of the vertex */
+    int32 next_edge;
+    int32 next_self_edge;
+} cypher_graph_expand_scan_state;
+
+static void begin_cypher_graph_expand(CustomScanState *node, EState *estate,
+                                      int eflags);
+static TupleTableSlot *exec_cypher_graph_expand(CustomScanState *node);
+static void end_cypher_graph_expand(CustomScanState *node);
+static void rescan_cypher_graph_expand(CustomScanState *node);
+
+static TupleTableSlot *graph_expand_next(ScanState *node);
+static bool graph_expand_recheck(ScanState *node, TupleTableSlot *slot);
+static void load_vertex_edges(cypher_graph_expand_scan_state *gess);
+
+const CustomExecMethods cypher_graph_expand_exec_methods = {
+    GRAPH_EXPAND_SCAN_STATE_NAME,
+    begin_cypher_graph_expand,
+    exec_cypher_graph_expand,
+    end_cypher_graph_expand,
+    rescan_cypher_graph_expand,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL};
+
+static void begin_cypher_graph_expand(CustomScanState *node, EState *estate,
+                                      int eflags)
+{
+    cypher_graph_expand_scan_state *gess =
+        (cypher_graph_expand_scan_state *)node;
+    CustomScan *cscan = (CustomScan *)node->ss.ps.plan;
+    Relation rel = node->ss.ss_currentRelation;
+    label_cache_data *label_cache;
+
+    gess->vertex_id_expr_state = ExecInitExpr(linitial(cscan->custom_exprs),
+                                              (PlanState *)node);
+    gess->outgoing = (intVal(linitial(cscan->custom_private)) != 0);
+
+    label_cache = search_label_relation_cache(RelationGetRelid(rel));
+    if (label_cache == NULL)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_UNDEFINED_TABLE),
+                 errmsg("relation \"%s\" is not an edge label table",
+                        RelationGetRelationName(rel))));
+    }
+
+    /* label tables live in the schema named after their graph */
+    gess->graph_name = get_namespace_name(RelationGetNamespace(rel));
+    gess->graph_oid = label_cache->graph;
+    gess->label_id = label_cache->id;
+    gess->ggctx = NULL;
+    gess->vertex_loaded = false;
+}
+
+static TupleTableSlot *exec_cypher_graph_expand(CustomScanState *node)
+{
+    return ExecScan(&node->ss, (ExecScanAccessMtd) graph_expand_next,
+                    (ExecScanRecheckMtd) graph_expand_recheck);
+}
+
+static void end_cypher_graph_expand(CustomScanState *node)
+{
+}
+
+static void rescan_cypher_graph_expand(CustomScanState *node)
+{
+    cypher_graph_expand_scan_state *gess =
+        (cypher_graph_expand_scan_state *)node;
+
+    /* the vertex may have changed, look it up again on the next fetch */
+    gess->vertex_loaded = false;
+
+    ExecScanReScan(&node->ss);
+}
+
+/*
+ * Looks up the bound vertex in the global context, loading or rebuilding
+ * the context first if needed, and starts over at its first edge.
+ */
+static void load_vertex_edges(cypher_graph_expand_scan_state *gess)
+{
+    ExprContext *econtext = gess->css.ss.ps.ps_ExprContext;
+    vertex_entry *ve = NULL;
+    Datum vertex_id;
+    bool isnull;
+
+    if (gess->ggctx == NULL)
+    {
+        gess->ggctx = manage_GRAPH_global_contexts(gess->graph_name,
+                                                   gess->graph_oid);
+    }
+
+    vertex_id = ExecEvalExprSwitchContext(gess->vertex_id_expr_state,
+                                          econtext, &isnull);
+    if (!isnull)
+    {
+        ve = get_vertex_entry(gess->ggctx, DATUM_GET_GRAPHID(vertex_id));
+    }
+
+    if (ve == NULL)
+    {
+        gess->edges = NULL;
+        gess->self_edges = NULL;
+    }
+    else if (gess->outgoing)
+    {
+        gess->edges = get_vertex_entry_edges_out_array(ve);
+        gess->self_edges = get_vertex_entry_edges_self_array(ve);
+    }
+    else
+    {
+        gess->edges = get_vertex_entry_edges_in_array(ve);
+        gess->self_edges = get_vertex_entry_edges_self_array(ve);
+    }
+
+    gess->next_edge = 0;
+    gess->next_self_edge = 0;
+    gess->vertex_loaded = true;
+}
+
+/* fetches the next visible edge of the label, self loops last */
+static TupleTableSlot *graph_expand_next(ScanState *node)
+{
+    cypher_graph_expand_scan_state *gess =
+        (cypher_graph_expand_scan_state *)node;
+    Relation rel = node->ss_currentRelation;
+    TupleTableSlot *slot = node->ss_ScanTupleSlot;
+    Snapshot snapshot = node->ps.state->es_snapshot;
+
+    if (!gess->vertex_loaded)
+    {
+        load_vertex_edges(gess);
+    }
+
+    for (;;)
+    {
+        edge_entry *ee;
+        graphid edge_id;
+
+        if (gess->edges != NULL && gess->next_edge < gess->edges->size)
+        {
+            edge_id = gess->edges->array[gess->next_edge++];
+        }
+        else if (gess->self_edges != NULL &&
+                 gess->next_self_edge < gess->self_edges->size)
+        {
+            edge_id = gess->self_edges->array[gess->next_self_edge++];
+        }
+        else
+        {
+            return ExecClearTuple(slot);
+        }
+
+        if (get_graphid_label_id(edge_id) != gess->label_id)
+        {
+            continue;
+        }
+
+        ee = get_edge_entry(gess->ggctx, edge_id);
+        if (ee == NULL)
+        {
+            continue;
+        }
+
+        if (table_tuple_fetch_row_version(rel, get_edge_entry_tid(ee),
+                                          snapshot, slot))
+        {
+            return slot;
+        }
+    }
+}
+
+/* the quals are rechecked by ExecScan, there is nothing else to check */
+static bool graph_expand_recheck(ScanState *node, TupleTableSlot *slot)
+{
+    return true;
+}
+
+Node *create_cypher_graph_expand_plan_state(CustomScan *cscan)
+{
+    cypher_graph_expand_scan_state *gess =
+        palloc0(sizeof(cypher_graph_expand_scan_state));
+
+    gess->css.ss.ps.type = T_CustomScanState;
+    gess->css.methods = &cypher_graph_expand_exec_methods;
+    /* edges are fetched from the heap into the scan slot */
+    gess->css.slotOps = &TTSOpsBufferHeapTuple;
+
+    return (Node *)gess;
+}
@@ -19,13 +19,19 @@
 
 #include "postgres.h"
 
+#include "access/tableam.h"
+#include "access/xact.h"
+#include "common/hashfn.h"
 #include "executor/executor.h"
+#include "storage/lmgr.h"
 #include "utils/datum.h"
 #include "utils/rls.h"
 
 #include "catalog/ag_label.h"
+#include "commands/index_commands.h"
 #include "executor/cypher_executor.h"
 #include "executor/cypher_utils.h"
+#include "utils/ag_graphid_cache.h"
 #include "utils/age_global_graph.h"
 
 /*
@@ -58,9 +64,20 @@ typedef struct path_entry
 typedef struct created_path
 {
     struct created_path *next;  /* next link in linked list of path_entrys */
+    struct created_path *next_in_bucket; /* next path with the same hash */
     struct path_entry **entry;  /* path_entry array for this link */
 } created_path;
 
+/*
+ * The following structure is an entry of created_paths_htab. It holds the
+ * created paths whose path_hash() is the same.
+ */
+typedef struct created_path_bucket
+{
+    uint32 path_hash;           /* hash key */
+    created_path *paths;        /* paths linked through next_in_bucket */
+} created_path_bucket;
+
 static void begin_cypher_merge(CustomScanState *node, EState *estate,
                                int eflags);
 static TupleTableSlot *exec_cypher_merge(CustomScanState *node);
@@ -78,8 +95,17 @@ static void merge_edge(cypher_merge_custom_scan_state *css,
 static void process_simple_merge(CustomScanState *node);
 static bool check_path(cypher_merge_custom_scan_state *css,
                        TupleTableSlot *slot);
-static void process_path(cypher_merge_custom_scan_state *css,
+static bool process_path(cypher_merge_custom_scan_state *css,
                          path_entry **path_array, bool should_insert);
+static List *get_merge_arbiter_indexes(Oid relid);
+static bool insert_merge_vertex(cypher_merge_custom_scan_state *css,
+                                cypher_target_node *node,
+                                TupleTableSlot *elemTupleSlot, CommandId cid,
+                                Datum *id, Datum *prop);
+static bool lock_merge_conflict(cypher_merge_custom_scan_state *css,
+                                Relation rel, ItemPointer conflict_tid);
+static bool merge_conflict_matches(TupleTableSlot *conflict_slot,
+                                   TupleTableSlot *elemTupleSlot);
 static void mark_tts_isnull(TupleTableSlot *slot);
 static void mark_scan_slot_valid(TupleTableSlot *slot);
 
@@ -96,6 +122,9 @@ static bool compare_2_paths(path_entry **lhs, path_entry **rhs,
                             int path_length);
 static path_entry **find_duplicate_path(CustomScanState *node,
                                         path_entry **path_array);
+static uint32 path_hash(path_entry **path_array, int path_length);
+static void remember_created_path(cypher_merge_custom_scan_state *css,
+                                  path_entry **path_array);
 static void free_path_entry_array(path_entry **path_array, int length);
 
 /*
@@ -110,6 +139,7 @@ static void begin_cypher_merge(CustomScanState *node, EState *estate,
     ListCell *lc = NULL;
     Plan *subplan = NULL;
     css->created_paths_list = NULL;
+    css->created_paths_htab = NULL;
 
     Assert(list_length(css->cs->custom_plans) == 1);
 
@@ -165,8 +195,25 @@ static void begin_cypher_merge(CustomScanState *node, EState *estate,
                           list_length(estate->es_range_table), NULL,
                           estate->es_instrument);
 
+        /*
+         * A lone vertex whose label has unique constraints is inserted like
+         * INSERT ... ON CONFLICT does. The indexes need the information for
+         * that.
+         */
+        if (list_length(css->path->target_nodes) == 1)
+        {
+            css->arbiter_indexes = get_merge_arbiter_indexes(cypher_node->relid);
+        }
+
         /* Open all indexes for the relation */
-        ExecOpenIndices(cypher_node->resultRelInfo, false);
+        ExecOpenIndices(cypher_node->resultRelInfo,
+                        css->arbiter_indexes != NIL);
+
+        if (css->arbiter_indexes != NIL)
+        {
+            css->conflict_slot = table_slot_create(rel,
+                                                   &estate->es_tupleTable);
+        }
 
         /* Setup the relation's tuple slot */
         cypher_node->elemTupleSlot = ExecInitExtraTupleSlot(
@@ -174,12 +221,6 @@ static void begin_cypher_merge(CustomScanState *node, EState *estate,
             RelationGetDescr(cypher_node->resultRelInfo->ri_RelationDesc),
             &TTSOpsHeapTuple);
 
-        if (cypher_node->id_expr != NULL)
-        {
-            cypher_node->id_expr_state =
-                ExecInitExpr(cypher_node->id_expr, (PlanState *)node);
-        }
-
         if (cypher_node->prop_expr != NULL)
         {
             cypher_node->prop_expr_state = ExecInitExpr(cypher_node->prop_expr,
@@ -279,13 +320,20 @@ static bool check_path(cypher_merge_custom_scan_state *css,
     return false;
 }
 
-static void process_path(cypher_merge_custom_scan_state *css,
+/*
+ * Creates the path. Returns false if, instead, the vertex of a lone vertex
+ * path was matched through a unique constraint of its label. See
+ * insert_merge_vertex().
+ */
+static bool process_path(cypher_merge_custom_scan_state *css,
                          path_entry **path_array, bool should_insert)
 {
     cypher_create_path *path = css->path;
     List *list = path->target_nodes;
     ListCell *lc = list_head(list);
 
+    css->matched_on_conflict = false;
+
     /*
      * Create the first vertex. The create_vertex function will
      * create the rest of the path, if necessary.
@@ -325,6 +373,8 @@ static void process_path(cypher_merge_custom_scan_state *css,
             scantuple->tts_isnull[tuple_position] = false;
         }
     }
+
+    return !css->matched_on_conflict;
 }
 
 /*
@@ -354,13 +404,23 @@ static void process_simple_merge(CustomScanState *node)
         econtext->ecxt_scantuple = sss->ss.ss_ScanTupleSlot;
         mark_tts_isnull(econtext->ecxt_scantuple);
 
-        process_path(css, NULL, true);
-
-        /* ON CREATE SET: path was just created */
-        if (css->on_create_set_info)
+        if (process_path(css, NULL, true))
         {
-            mark_scan_slot_valid(econtext->ecxt_scantuple);
-            apply_update_list(&css->css, css->on_create_set_info);
+            /* ON CREATE SET: path was just created */
+            if (css->on_create_set_info)
+            {
+                mark_scan_slot_valid(econtext->ecxt_scantuple);
+                apply_update_list(&css->css, css->on_create_set_info);
+            }
+        }
+        else
+        {
+            /* ON MATCH SET: the vertex was matched through a constraint */
+            if (css->on_match_set_info)
+            {
+                mark_scan_slot_valid(econtext->ecxt_scantuple);
+                apply_update_list(&css->css, css->on_match_set_info);
+            }
         }
     }
     else
@@ -591,36 +651,42 @@ static bool compare_2_paths(path_entry **lhs, path_entry **rhs, int path_length)
     return true;
 }
 
-/* helper function to find a duplicate path in the created_paths_list */
+/*
+ * Helper function to find a duplicate path among the paths this MERGE has
+ * created. The created paths are kept in a hash table by path_hash(), so that
+ * a batch of rows that repeat the same entities does not compare each row
+ * with every path created before it.
+ */
 static path_entry **find_duplicate_path(CustomScanState *node,
                                          path_entry **path_array)
 {
     cypher_merge_custom_scan_state *css =
         (cypher_merge_custom_scan_state *)node;
     int path_length = list_length(css->path->target_nodes);
+    created_path_bucket *bucket = NULL;
+    created_path *curr_path = NULL;
+    uint32 hash;
 
-    /* if the list is NULL just return NULL */
-    if (css->created_paths_list == NULL)
+    /* if nothing was created yet, just return NULL */
+    if (css->created_paths_htab == NULL)
     {
         return NULL;
     }
-    /* otherwise, check to see if the path already exists */
-    else
+
+    hash = path_hash(path_array, path_length);
+    bucket = hash_search(css->created_paths_htab, &hash, HASH_FIND, NULL);
+    if (bucket == NULL)
     {
-        /* set to the top of the list */
-        created_path *curr_path = css->created_paths_list;
+        return NULL;
+    }
 
-        /* iterate through our list of created paths */
-        while (curr_path != NULL)
+    /* the hashes can collide, so compare the paths themselves */
+    for (curr_path = bucket->paths; curr_path != NULL;
+         curr_path = curr_path->next_in_bucket)
+    {
+        if (compare_2_paths(path_array, curr_path->entry, path_length))
         {
-            /* if we have found the entry, return it */
-            if (compare_2_paths(path_array, curr_path->entry, path_length))
-            {
-                return curr_path->entry;
-            }
-
-            /* otherwise, get the next path */
-            curr_path = curr_path->next;
+            return curr_path->entry;
         }
     }
 
@@ -628,6 +694,80 @@ static path_entry **find_duplicate_path(CustomScanState *node,
     return NULL;
 }
 
+/*
+ * Helper function to hash a prebuilt path. Only what compare_2_paths()
+ * compares goes into the hash: the ids of the actual vertices, and the
+ * label, direction, and properties of the other entities.
+ */
+static uint32 path_hash(path_entry **path_array, int path_length)
+{
+    uint32 hash = 0;
+    int i;
+
+    for (i = 0; i < path_length; i++)
+    {
+        path_entry *entry = path_array[i];
+
+        if (entry->actual)
+        {
+            hash = hash_combine(hash,
+                                hash_bytes((const unsigned char *)&entry->id,
+                                           sizeof(graphid)));
+            continue;
+        }
+
+        hash = hash_combine(hash, murmurhash32((uint32)entry->label));
+        hash = hash_combine(hash, murmurhash32((uint32)entry->direction));
+        hash = hash_combine(hash, entry->dih);
+    }
+
+    return hash;
+}
+
+/*
+ * Helper function to add a path this MERGE has just created to the
+ * created_paths_list and its hash table. The path_array is owned by the list
+ * from then on.
+ */
+static void remember_created_path(cypher_merge_custom_scan_state *css,
+                                  path_entry **path_array)
+{
+    int path_length = list_length(css->path->target_nodes);
+    created_path *new_path = palloc0(sizeof(created_path));
+    created_path_bucket *bucket = NULL;
+    uint32 hash;
+    bool found;
+
+    if (css->created_paths_htab == NULL)
+    {
+        HASHCTL hash_ctl;
+
+        MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+        hash_ctl.keysize = sizeof(uint32);
+        hash_ctl.entrysize = sizeof(created_path_bucket);
+        hash_ctl.hcxt = css->css.ss.ps.state->es_query_cxt;
+
+        css->created_paths_htab = hash_create("MERGE created paths", 256,
+                                              &hash_ctl,
+                                              HASH_ELEM | HASH_BLOBS |
+                                              HASH_CONTEXT);
+    }
+
+    new_path->next = css->created_paths_list;
+    new_path->entry = path_array;
+    css->created_paths_list = new_path;
+
+    hash = path_hash(path_array, path_length);
+    bucket = hash_search(css->created_paths_htab, &hash, HASH_ENTER, &found);
+    if (!found)
+    {
+        bucket->paths = NULL;
+    }
+
+    new_path->next_in_bucket = bucket->paths;
+    bucket->paths = new_path;
+}
+
 /*
  * Function that is called mid-execution. This function will call
  * its subtree in the execution tree, and depending on the results
@@ -732,16 +872,10 @@ static TupleTableSlot *exec_cypher_merge(CustomScanState *node)
                             apply_update_list(&css->css,
                                               css->on_match_set_info);
                     }
-                    else
+                    else if (process_path(css, prebuilt_path_array, true))
                     {
-                        created_path *new_path =
-                            palloc0(sizeof(created_path));
-
-                        new_path->next = css->created_paths_list;
-                        new_path->entry = prebuilt_path_array;
-                        css->created_paths_list = new_path;
+                        remember_created_path(css, prebuilt_path_array);
 
-                        process_path(css, prebuilt_path_array, true);
                         mark_scan_slot_valid(econtext->ecxt_scantuple);
 
                         /* ON CREATE SET: path was just created */
@@ -749,6 +883,24 @@ static TupleTableSlot *exec_cypher_merge(CustomScanState *node)
                             apply_update_list(&css->css,
                                               css->on_create_set_info);
                     }
+                    else
+                    {
+                        /*
+                         * The vertex was matched through a constraint. It
+                         * is not remembered as created; the next rows of the
+                         * same pattern match it the same way.
+                         */
+                        free_path_entry_array(prebuilt_path_array,
+                                              path_length);
+                        pfree(prebuilt_path_array);
+
+                        mark_scan_slot_valid(econtext->ecxt_scantuple);
+
+                        /* ON MATCH SET: the vertex already existed */
+                        if (css->on_match_set_info)
+                            apply_update_list(&css->css,
+                                              css->on_match_set_info);
+                    }
                 }
                 else
                 {
@@ -833,21 +985,28 @@ static TupleTableSlot *exec_cypher_merge(CustomScanState *node)
                     if (css->on_match_set_info)
                         apply_update_list(&css->css, css->on_match_set_info);
                 }
-                else
+                else if (process_path(css, prebuilt_path_array, true))
                 {
-                    created_path *new_path = palloc0(sizeof(created_path));
-
-                    new_path->next = css->created_paths_list;
-                    new_path->entry = prebuilt_path_array;
-                    css->created_paths_list = new_path;
+                    remember_created_path(css, prebuilt_path_array);
 
-                    process_path(css, prebuilt_path_array, true);
                     mark_scan_slot_valid(econtext->ecxt_scantuple);
 
                     /* ON CREATE SET: path was just created */
                     if (css->on_create_set_info)
                         apply_update_list(&css->css, css->on_create_set_info);
                 }
+                else
+                {
+                    /* matched through a constraint, see the case above */
+                    free_path_entry_array(prebuilt_path_array, path_length);
+                    pfree(prebuilt_path_array);
+
+                    mark_scan_slot_valid(econtext->ecxt_scantuple);
+
+                    /* ON MATCH SET: the vertex already existed */
+                    if (css->on_match_set_info)
+                        apply_update_list(&css->css, css->on_match_set_info);
+                }
             }
             else
             {
@@ -1003,14 +1162,23 @@ static TupleTableSlot *exec_cypher_merge(CustomScanState *node)
             mark_tts_isnull(econtext->ecxt_scantuple);
 
             /* create the path */
-            process_path(css, NULL, true);
+            if (process_path(css, NULL, true))
+            {
+                /* mark the slot as valid so tts_nvalid reflects natts */
+                mark_scan_slot_valid(econtext->ecxt_scantuple);
 
-            /* mark the slot as valid so tts_nvalid reflects natts */
-            mark_scan_slot_valid(econtext->ecxt_scantuple);
+                /* ON CREATE SET: path was just created */
+                if (css->on_create_set_info)
+                    apply_update_list(&css->css, css->on_create_set_info);
+            }
+            else
+            {
+                mark_scan_slot_valid(econtext->ecxt_scantuple);
 
-            /* ON CREATE SET: path was just created */
-            if (css->on_create_set_info)
-                apply_update_list(&css->css, css->on_create_set_info);
+                /* ON MATCH SET: the vertex was matched through a constraint */
+                if (css->on_match_set_info)
+                    apply_update_list(&css->css, css->on_match_set_info);
+            }
 
             /* mark the create_new_path flag to true. */
             css->created_new_path = true;
@@ -1093,6 +1261,12 @@ static void end_cypher_merge(CustomScanState *node)
         css->created_paths_list = next;
     }
 
+    if (css->created_paths_htab != NULL)
+    {
+        hash_destroy(css->created_paths_htab);
+        css->created_paths_htab = NULL;
+    }
+
     /* free the eager buffer if it was used */
     if (css->eager_tuples != NIL)
     {
@@ -1228,7 +1402,8 @@ static Datum merge_vertex(cypher_merge_custom_scan_state *css,
         else if (should_insert == true)
         {
             /* get the next graphid for this vertex */
-            id = ExecEvalExpr(node->id_expr_state, econtext, &isNull);
+            id = GRAPHID_GET_DATUM(get_next_label_graphid(node->relid));
+            isNull = false;
 
             if (path_array != NULL && path_array[path_index] != NULL)
             {
@@ -1292,7 +1467,28 @@ static Datum merge_vertex(cypher_merge_custom_scan_state *css,
          *    following command to see the updates generated by this instance of
          *    merge.
          */
-        if (should_insert &&
+        if (should_insert && css->arbiter_indexes != NIL)
+        {
+            bool use_current_cid =
+                css->base_currentCommandId == GetCurrentCommandId(false);
+
+            if (insert_merge_vertex(css, node, elemTupleSlot,
+                                    use_current_cid ?
+                                        GetCurrentCommandId(true) :
+                                        css->base_currentCommandId,
+                                    &id, &prop))
+            {
+                if (use_current_cid)
+                {
+                    CommandCounterIncrement();
+                }
+            }
+            else
+            {
+                css->matched_on_conflict = true;
+            }
+        }
+        else if (should_insert &&
             css->base_currentCommandId == GetCurrentCommandId(false))
         {
             insert_entity_tuple(resultRelInfo, elemTupleSlot, estate);
@@ -1557,7 +1753,8 @@ static void merge_edge(cypher_merge_custom_scan_state *css,
     else if (should_insert == true)
     {
         /* get the next graphid for this edge */
-        id = ExecEvalExpr(node->id_expr_state, econtext, &isNull);
+        id = GRAPHID_GET_DATUM(get_next_label_graphid(node->relid));
+        isNull = false;
 
         if (path_array != NULL && path_array[path_index] != NULL)
         {
@@ -1699,3 +1896,221 @@ static void merge_edge(cypher_merge_custom_scan_state *css,
         }
     }
 }
+
+/* Returns the unique constraints of the label's table, see index_commands.c */
+static List *get_merge_arbiter_indexes(Oid relid)
+{
+    List *arbiter_indexes = NIL;
+    ListCell *lc;
+
+    foreach (lc, get_label_property_indexes(relid))
+    {
+        property_index *index = lfirst(lc);
+
+        if (index->unique)
+        {
+            arbiter_indexes = lappend_oid(arbiter_indexes, index->index_oid);
+        }
+    }
+
+    return arbiter_indexes;
+}
+
+/*
+ * Inserts the vertex of a lone vertex path whose label has unique constraints
+ * the way INSERT ... ON CONFLICT does. The lateral join cannot see a vertex
+ * that a concurrent transaction inserts with the same unique properties. So,
+ * the unique indexes are probed before the insert, and a speculative insert
+ * makes sure that no such vertex went in meanwhile. If one did, the vertex is
+ * locked and matched instead of failing on the unique index.
+ *
+ * Returns true if the vertex was inserted. Otherwise, returns false with the
+ * id and the properties of the matched vertex.
+ */
+static bool insert_merge_vertex(cypher_merge_custom_scan_state *css,
+                                cypher_target_node *node,
+                                TupleTableSlot *elemTupleSlot, CommandId cid,
+                                Datum *id, Datum *prop)
+{
+    EState *estate = css->css.ss.ps.state;
+    ResultRelInfo *resultRelInfo = node->resultRelInfo;
+    Relation rel = resultRelInfo->ri_RelationDesc;
+
+    ExecStoreVirtualTuple(elemTupleSlot);
+
+    /* Check the constraints of the tuple */
+    if (rel->rd_att->constr != NULL)
+    {
+        ExecConstraints(resultRelInfo, elemTupleSlot, estate);
+    }
+
+    /* Check RLS WITH CHECK policies if configured */
+    if (resultRelInfo->ri_WithCheckOptions != NIL)
+    {
+        ExecWithCheckOptions(WCO_RLS_INSERT_CHECK, resultRelInfo,
+                             elemTupleSlot, estate);
+    }
+
+    for (;;)
+    {
+        ItemPointerData conflict_tid;
+        uint32 spec_token;
+        bool spec_conflict = false;
+        List *recheck_indexes;
+
+        if (!ExecCheckIndexConstraints(resultRelInfo, elemTupleSlot, estate,
+                                       &conflict_tid, css->arbiter_indexes))
+        {
+            bool isnull;
+
+            /* the vertex went away before it could be locked, start over */
+            if (!lock_merge_conflict(css, rel, &conflict_tid))
+            {
+                continue;
+            }
+
+            /*
+             * The vertex has the unique properties of the pattern, but not
+             * the others. MERGE has to create the pattern, which the
+             * constraint does not allow.
+             */
+            if (!merge_conflict_matches(css->conflict_slot, elemTupleSlot))
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_UNIQUE_VIOLATION),
+                         errmsg("MERGE cannot create a vertex of label \"%s\" that violates its unique constraints",
+                                node->label_name),
+                         errdetail("Vertex %ld has the same unique properties but does not match the pattern.",
+                                   DatumGetInt64(slot_getattr(
+                                       css->conflict_slot,
+                                       Anum_ag_label_vertex_table_id,
+                                       &isnull)))));
+            }
+
+            *id = slot_getattr(css->conflict_slot,
+                               Anum_ag_label_vertex_table_id, &isnull);
+            *prop = slot_getattr(css->conflict_slot,
+                                 Anum_ag_label_vertex_table_properties,
+                                 &isnull);
+
+            return false;
+        }
+
+        spec_token = SpeculativeInsertionLockAcquire(GetCurrentTransactionId());
+
+        table_tuple_insert_speculative(rel, elemTupleSlot, cid, 0, NULL,
+                                       spec_token);
+
+        recheck_indexes = ExecInsertIndexTuples(resultRelInfo, elemTupleSlot,
+                                                estate, false, true,
+                                                &spec_conflict,
+                                                css->arbiter_indexes, false);
+
+        table_tuple_complete_speculative(rel, elemTupleSlot, spec_token,
+                                         !spec_conflict);
+
+        SpeculativeInsertionLockRelease(GetCurrentTransactionId());
+
+        list_free(recheck_indexes);
+
+        if (!spec_conflict)
+        {
+            return true;
+        }
+
+        /* a concurrent transaction inserted the same unique properties */
+    }
+}
+
+/*
+ * Locks the vertex that has the same unique properties into conflict_slot,
+ * like ON CONFLICT DO UPDATE locks the conflicting row. Returns false if the
+ * vertex was updated or deleted meanwhile, to look for it again.
+ */
+static bool lock_merge_conflict(cypher_merge_custom_scan_state *css,
+                                Relation rel, ItemPointer conflict_tid)
+{
+    EState *estate = css->css.ss.ps.state;
+    TupleTableSlot *conflict_slot = css->conflict_slot;
+    TM_FailureData tmfd;
+    TM_Result result;
+
+    result = table_tuple_lock(rel, conflict_tid, estate->es_snapshot,
+                              conflict_slot, GetCurrentCommandId(false),
+                              LockTupleKeyShare, LockWaitBlock, 0, &tmfd);
+    switch (result)
+    {
+        case TM_Ok:
+            break;
+
+        case TM_SelfModified:
+            /* updated by this transaction, the new version conflicts */
+            return false;
+
+        case TM_Updated:
+        case TM_Deleted:
+            if (IsolationUsesXactSnapshot())
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
+                         errmsg("could not serialize access due to concurrent update")));
+            }
+            return false;
+
+        default:
+            elog(ERROR, "unrecognized table_tuple_lock status: %u", result);
+    }
+
+    /*
+     * Under REPEATABLE READ or SERIALIZABLE, the vertex must be visible to the
+     * transaction, as ON CONFLICT requires of the conflicting row.
+     */
+    if (IsolationUsesXactSnapshot() &&
+        !table_tuple_satisfies_snapshot(rel, conflict_slot,
+                                        estate->es_snapshot))
+    {
+        bool isnull;
+        Datum xmin = slot_getsysattr(conflict_slot,
+                                     MinTransactionIdAttributeNumber, &isnull);
+
+        if (!TransactionIdIsCurrentTransactionId(DatumGetTransactionId(xmin)))
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
+                     errmsg("could not serialize access due to concurrent update")));
+        }
+    }
+
+    return true;
+}
+
+/* Returns true if the properties of the locked vertex contain the pattern's */
+static bool merge_conflict_matches(TupleTableSlot *conflict_slot,
+                                   TupleTableSlot *elemTupleSlot)
+{
+    Datum properties;
+    Datum constraints;
+    agtype_iterator *property_it;
+    agtype_iterator *constraint_it;
+    bool isnull;
+
+    constraints = slot_getattr(elemTupleSlot,
+                               Anum_ag_label_vertex_table_properties, &isnull);
+    if (isnull)
+    {
+        return true;
+    }
+
+    properties = slot_getattr(conflict_slot,
+                              Anum_ag_label_vertex_table_properties, &isnull);
+    if (isnull)
+    {
+        return false;
+    }
+
+    property_it = agtype_iterator_init(&DATUM_GET_AGTYPE_P(properties)->root);
+    constraint_it =
+        agtype_iterator_init(&DATUM_GET_AGTYPE_P(constraints)->root);
+
+    return agtype_deep_contains(&property_it, &constraint_it, false);
+}
@@ -28,6 +28,7 @@
 #include "executor/cypher_utils.h"
 #include "utils/age_global_graph.h"
 #include "catalog/ag_graph.h"
+#include "catalog/ag_label.h"
 #include "utils/agtype.h"
 
 static void begin_cypher_set(CustomScanState *node, EState *estate,
@@ -387,6 +388,8 @@ void apply_update_list(CustomScanState *node,
     ListCell *lc;
     EState *estate = node->ss.ps.state;
     int *luindex = NULL;
+    agtype_value **entity_values = NULL;
+    bool keep_entities = true;
     int lidx = 0;
     HTAB *qual_cache = NULL;
     HASHCTL hashctl;
@@ -396,6 +399,9 @@ void apply_update_list(CustomScanState *node,
     /* allocate an array to hold the last update index of each 'entity' */
     luindex = palloc0(sizeof(int) * scanTupleSlot->tts_nvalid);
 
+    /* and one for the 'entities' altered by an item that isn't their last */
+    entity_values = palloc0(sizeof(agtype_value *) * scanTupleSlot->tts_nvalid);
+
     /* Hash table for caching compiled security quals per label */
     MemSet(&hashctl, 0, sizeof(hashctl));
     hashctl.keysize = sizeof(Oid);
@@ -427,6 +433,15 @@ void apply_update_list(CustomScanState *node,
         update_item = (cypher_update_item *)lfirst(lc);
         luindex[update_item->entity_position - 1] = lidx;
 
+        /*
+         * The expression of an item may read the 'entity' as altered by the
+         * previous items, which must then be in the scan tuple.
+         */
+        if (update_item->prop_expr != NULL)
+        {
+            keep_entities = false;
+        }
+
         /* increment the loop index */
         lidx++;
     }
@@ -480,8 +495,20 @@ void apply_update_list(CustomScanState *node,
                             clause_name)));
         }
 
-        original_entity = DATUM_GET_AGTYPE_P(scanTupleSlot->tts_values[update_item->entity_position - 1]);
-        original_entity_value = get_ith_agtype_value_from_container(&original_entity->root, 0);
+        /*
+         * Continue with the entity as altered by the previous items, if it
+         * was kept. Otherwise, decode it from the scan tuple.
+         */
+        if (entity_values[update_item->entity_position - 1] != NULL)
+        {
+            original_entity_value =
+                entity_values[update_item->entity_position - 1];
+        }
+        else
+        {
+            original_entity = DATUM_GET_AGTYPE_P(scanTupleSlot->tts_values[update_item->entity_position - 1]);
+            original_entity_value = get_ith_agtype_value_from_container(&original_entity->root, 0);
+        }
 
         if (original_entity_value->type != AGTV_VERTEX &&
             original_entity_value->type != AGTV_EDGE)
@@ -565,10 +592,11 @@ void apply_update_list(CustomScanState *node,
         if (update_item->prop_name != NULL &&
             strcmp(update_item->prop_name, "") != 0)
         {
-            altered_properties = alter_property_value(original_properties,
-                                                      update_item->prop_name,
-                                                      new_property_value,
-                                                      remove_property);
+            /* the entity was decoded for this list, alter it in place */
+            altered_properties = set_property_value(original_properties,
+                                                    update_item->prop_name,
+                                                    new_property_value,
+                                                    remove_property);
         }
         else
         {
@@ -588,6 +616,27 @@ void apply_update_list(CustomScanState *node,
             }
         }
 
+        /*
+         * If a later item alters the same entity, keep the altered entity for
+         * it. The entity is built and written once, by its last item, instead
+         * of being serialized and decoded again for each item.
+         */
+        if (keep_entities && altered_properties != NULL &&
+            original_properties != NULL &&
+            luindex[update_item->entity_position - 1] != lidx)
+        {
+            if (altered_properties != original_properties)
+            {
+                *original_properties = *altered_properties;
+            }
+            entity_values[update_item->entity_position - 1] =
+                original_entity_value;
+
+            /* increment loop index */
+            lidx++;
+            continue;
+        }
+
         resultRelInfo = create_entity_result_rel_info(
             estate, set_info->graph_name, label_name);
 
@@ -644,25 +693,26 @@ void apply_update_list(CustomScanState *node,
          */
         if (original_entity_value->type == AGTV_VERTEX)
         {
+            slot = populate_vertex_tts(slot, id, altered_properties);
+
+            /* the properties are serialized once, for both */
             new_entity = make_vertex(GRAPHID_GET_DATUM(id->val.int_value),
                                      string_to_agtype(label_name),
-                                     AGTYPE_P_GET_DATUM(agtype_value_to_agtype(altered_properties)));
-
-            slot = populate_vertex_tts(slot, id, altered_properties);
+                                     slot->tts_values[vertex_tuple_properties]);
         }
         else if (original_entity_value->type == AGTV_EDGE)
         {
             agtype_value *startid = GET_AGTYPE_VALUE_OBJECT_VALUE(original_entity_value, "start_id");
             agtype_value *endid = GET_AGTYPE_VALUE_OBJECT_VALUE(original_entity_value, "end_id");
 
+            slot = populate_edge_tts(slot, id, startid, endid,
+                                     altered_properties);
+
             new_entity = make_edge(GRAPHID_GET_DATUM(id->val.int_value),
                                    GRAPHID_GET_DATUM(startid->val.int_value),
                                    GRAPHID_GET_DATUM(endid->val.int_value),
                                    string_to_agtype(label_name),
-                                   AGTYPE_P_GET_DATUM(agtype_value_to_agtype(altered_properties)));
-
-            slot = populate_edge_tts(slot, id, startid, endid,
-                                     altered_properties);
+                                   slot->tts_values[edge_tuple_properties]);
         }
         else
         {
@@ -832,8 +882,9 @@ void apply_update_list(CustomScanState *node,
     hash_destroy(qual_cache);
     hash_destroy(index_cache);
 
-    /* free our lookup array */
+    /* free our lookup arrays */
     pfree_if_not_null(luindex);
+    pfree_if_not_null(entity_values);
 }
 
 static void process_update_list(CustomScanState *node)
@@ -348,6 +348,135 @@ HeapTuple insert_entity_tuple_cid(ResultRelInfo *resultRelInfo,
     return tuple;
 }
 
+/*
+ * Create an empty insert buffer for the label table of resultRelInfo, whose
+ * indices must be open already.
+ */
+entity_insert_buffer *create_entity_insert_buffer(ResultRelInfo *resultRelInfo)
+{
+    entity_insert_buffer *buffer;
+
+    buffer = palloc0(sizeof(entity_insert_buffer));
+    buffer->resultRelInfo = resultRelInfo;
+    buffer->bistate = GetBulkInsertState();
+    /* the slots are created as they are needed */
+    buffer->slots = palloc0(sizeof(TupleTableSlot *) *
+                            ENTITY_INSERT_BUFFER_SIZE);
+    buffer->num_tuples = 0;
+    buffer->buffered_bytes = 0;
+
+    return buffer;
+}
+
+/*
+ * Check the edge/vertex tuple in elemTupleSlot the way insert_entity_tuple
+ * does and add a copy of it to the buffer. The buffer is flushed when it is
+ * full.
+ *
+ * resultRelInfo is the one of the target node being created, which carries
+ * its RLS WITH CHECK policies. It may differ from the buffer's one, as the
+ * buffer is shared by all target nodes of the same label.
+ */
+void buffer_entity_tuple(entity_insert_buffer *buffer,
+                         ResultRelInfo *resultRelInfo,
+                         TupleTableSlot *elemTupleSlot, EState *estate)
+{
+    TupleTableSlot *slot;
+
+    ExecStoreVirtualTuple(elemTupleSlot);
+
+    /* Check the constraints of the tuple */
+    if (resultRelInfo->ri_RelationDesc->rd_att->constr != NULL)
+    {
+        ExecConstraints(resultRelInfo, elemTupleSlot, estate);
+    }
+
+    /* Check RLS WITH CHECK policies if configured */
+    if (resultRelInfo->ri_WithCheckOptions != NIL)
+    {
+        ExecWithCheckOptions(WCO_RLS_INSERT_CHECK, resultRelInfo,
+                             elemTupleSlot, estate);
+    }
+
+    slot = buffer->slots[buffer->num_tuples];
+    if (slot == NULL)
+    {
+        Relation rel = buffer->resultRelInfo->ri_RelationDesc;
+
+        slot = MakeSingleTupleTableSlot(RelationGetDescr(rel),
+                                        &TTSOpsHeapTuple);
+        buffer->slots[buffer->num_tuples] = slot;
+    }
+
+    /* the copy is materialized, it does not point to elemTupleSlot's datums */
+    ExecCopySlot(slot, elemTupleSlot);
+
+    buffer->buffered_bytes += ExecFetchSlotHeapTuple(slot, false, NULL)->t_len;
+    buffer->num_tuples++;
+
+    if (buffer->num_tuples >= ENTITY_INSERT_BUFFER_SIZE ||
+        buffer->buffered_bytes >= ENTITY_INSERT_BUFFER_BYTES)
+    {
+        flush_entity_insert_buffer(buffer, estate);
+    }
+}
+
+/*
+ * Insert the buffered tuples into the table with a single multi-insert, then
+ * insert their index entries. Like insert_batch() of the loader, but the
+ * tuples have been checked already and unique violations are errors.
+ */
+void flush_entity_insert_buffer(entity_insert_buffer *buffer, EState *estate)
+{
+    ResultRelInfo *resultRelInfo = buffer->resultRelInfo;
+    int i;
+
+    if (buffer->num_tuples == 0)
+    {
+        return;
+    }
+
+    table_multi_insert(resultRelInfo->ri_RelationDesc, buffer->slots,
+                       buffer->num_tuples, GetCurrentCommandId(true), 0,
+                       buffer->bistate);
+
+    for (i = 0; i < buffer->num_tuples; i++)
+    {
+        if (resultRelInfo->ri_NumIndices > 0)
+        {
+            ExecInsertIndexTuples(resultRelInfo, buffer->slots[i], estate,
+                                  false, false, NULL, NIL, false);
+        }
+
+        ExecClearTuple(buffer->slots[i]);
+    }
+
+    buffer->num_tuples = 0;
+    buffer->buffered_bytes = 0;
+}
+
+/*
+ * Release the buffer. Tuples that have not been flushed are discarded.
+ */
+void free_entity_insert_buffer(entity_insert_buffer *buffer)
+{
+    int i;
+
+    for (i = 0; i < ENTITY_INSERT_BUFFER_SIZE; i++)
+    {
+        if (buffer->slots[i] == NULL)
+        {
+            break;
+        }
+
+        ExecDropSingleTupleTableSlot(buffer->slots[i]);
+    }
+
+    FreeBulkInsertState(buffer->bistate);
+    pfree(buffer->slots);
+    pfree(buffer);
+}
+
 /*
  * setup_wcos
  *
@@ -57,6 +57,8 @@ const char *node_names[] = {
     "cypher_sub_pattern",
     "cypher_sub_query",
     "cypher_call",
+    "cypher_create_index",
+    "cypher_drop_index",
     "cypher_create_target_nodes",
     "cypher_create_path",
     "cypher_target_node",
@@ -126,6 +128,8 @@ const ExtensibleNodeMethods node_methods[] = {
     DEFINE_NODE_METHODS(cypher_sub_pattern),
     DEFINE_NODE_METHODS(cypher_sub_query),
     DEFINE_NODE_METHODS(cypher_call),
+    DEFINE_NODE_METHODS(cypher_create_index),
+    DEFINE_NODE_METHODS(cypher_drop_index),
     DEFINE_NODE_METHODS_EXTENDED(cypher_create_target_nodes),
     DEFINE_NODE_METHODS_EXTENDED(cypher_create_path),
     DEFINE_NODE_METHODS_EXTENDED(cypher_target_node),
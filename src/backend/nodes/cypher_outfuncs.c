@@ -375,6 +375,30 @@ void out_cypher_call(StringInfo str, const ExtensibleNode *node)
     WRITE_NODE_FIELD(yield_items);
 }
 
+/* serialization function for the cypher_create_index ExtensibleNode. */
+void out_cypher_create_index(StringInfo str, const ExtensibleNode *node)
+{
+    DEFINE_AG_NODE(cypher_create_index);
+
+    WRITE_STRING_FIELD(name);
+    WRITE_BOOL_FIELD(if_not_exists);
+    WRITE_NODE_FIELD(entity);
+    WRITE_NODE_FIELD(properties);
+    WRITE_BOOL_FIELD(unique);
+    WRITE_LOCATION_FIELD(location);
+}
+
+/* serialization function for the cypher_drop_index ExtensibleNode. */
+void out_cypher_drop_index(StringInfo str, const ExtensibleNode *node)
+{
+    DEFINE_AG_NODE(cypher_drop_index);
+
+    WRITE_STRING_FIELD(name);
+    WRITE_BOOL_FIELD(if_exists);
+    WRITE_BOOL_FIELD(unique);
+    WRITE_LOCATION_FIELD(location);
+}
+
 /* serialization function for the cypher_create_target_nodes ExtensibleNode. */
 void out_cypher_create_target_nodes(StringInfo str, const ExtensibleNode *node)
 {
@@ -19,6 +19,10 @@
 
 #include "postgres.h"
 
+#include "nodes/makefuncs.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/restrictinfo.h"
+
 #include "executor/cypher_executor.h"
 #include "optimizer/cypher_createplan.h"
 
@@ -30,6 +34,8 @@ const CustomScanMethods cypher_delete_plan_methods = {
     "Cypher Delete", create_cypher_delete_plan_state};
 const CustomScanMethods cypher_merge_plan_methods = {
     "Cypher Merge", create_cypher_merge_plan_state};
+const CustomScanMethods cypher_graph_expand_plan_methods = {
+    "Cypher Graph Expand", create_cypher_graph_expand_plan_state};
 
 Plan *plan_cypher_create_path(PlannerInfo *root, RelOptInfo *rel,
                               CustomPath *best_path, List *tlist,
@@ -238,3 +244,67 @@ Plan *plan_cypher_merge_path(PlannerInfo *root, RelOptInfo *rel,
 
     return (Plan *)cs;
 }
+
+/*
+ * Converts a Graph Expand path to a CustomScan that scans the edge relation
+ * itself. The side of the binding clause that does not belong to the edge
+ * relation becomes the vertex id expression; PostgreSQL replaces its outer
+ * Vars with nestloop params. The binding clause stays in the quals, where it
+ * costs one comparison per edge, so that no redundant EC-derived variant of
+ * it has to be recognized.
+ */
+Plan *plan_cypher_graph_expand_path(PlannerInfo *root, RelOptInfo *rel,
+                                    CustomPath *best_path, List *tlist,
+                                    List *clauses, List *custom_plans)
+{
+    CustomScan *cs;
+    RestrictInfo *rinfo = linitial(best_path->custom_private);
+    OpExpr *op = (OpExpr *) rinfo->clause;
+    Node *vertex_id_expr;
+
+    if (bms_is_subset(rinfo->left_relids, rel->relids))
+    {
+        vertex_id_expr = lsecond(op->args);
+    }
+    else
+    {
+        vertex_id_expr = linitial(op->args);
+    }
+
+    cs = makeNode(CustomScan);
+
+    cs->scan.plan.startup_cost = best_path->path.startup_cost;
+    cs->scan.plan.total_cost = best_path->path.total_cost;
+
+    cs->scan.plan.plan_rows = best_path->path.rows;
+    cs->scan.plan.plan_width = 0;
+
+    cs->scan.plan.parallel_aware = best_path->path.parallel_aware;
+    cs->scan.plan.parallel_safe = best_path->path.parallel_safe;
+
+    cs->scan.plan.plan_node_id = 0; /* Set later in set_plan_refs */
+    cs->scan.plan.targetlist = tlist;
+    cs->scan.plan.qual = extract_actual_clauses(clauses, false);
+    cs->scan.plan.lefttree = NULL;
+    cs->scan.plan.righttree = NULL;
+    cs->scan.plan.initPlan = NIL;
+
+    cs->scan.plan.extParam = NULL;
+    cs->scan.plan.allParam = NULL;
+
+    /* This is a real scan of the edge relation */
+    cs->scan.scanrelid = rel->relid;
+
+    cs->flags = best_path->flags;
+
+    cs->custom_plans = NIL;
+    cs->custom_exprs = list_make1(copyObject(vertex_id_expr));
+    /* only the direction, the clause itself is in the quals */
+    cs->custom_private = list_make1(lsecond(best_path->custom_private));
+    cs->custom_scan_tlist = NIL;
+
+    cs->custom_relids = NULL;
+    cs->methods = &cypher_graph_expand_plan_methods;
+
+    return (Plan *)cs;
+}
@@ -27,6 +27,10 @@
 #include "executor/cypher_utils.h"
 #include "optimizer/subselect.h"
 #include "nodes/makefuncs.h"
+#include "optimizer/cost.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/pathnode.h"
+#include "utils/spccache.h"
 
 static Const *convert_sublink_to_subplan(PlannerInfo *root,
                                          List *custom_private);
@@ -40,6 +44,8 @@ const CustomPathMethods cypher_delete_path_methods = {
     DELETE_PATH_NAME, plan_cypher_delete_path, NULL};
 const CustomPathMethods cypher_merge_path_methods = {
     MERGE_PATH_NAME, plan_cypher_merge_path, NULL};
+const CustomPathMethods cypher_graph_expand_path_methods = {
+    GRAPH_EXPAND_PATH_NAME, plan_cypher_graph_expand_path, NULL};
 
 CustomPath *create_cypher_create_path(PlannerInfo *root, RelOptInfo *rel,
                                       List *custom_private)
@@ -268,3 +274,117 @@ static bool expr_has_sublink(Node *node, void *context)
 
     return cypher_expr_tree_walker(node, expr_has_sublink, context);
 }
+
+/*
+ * Creates a Graph Expand path, which returns the edges of rel that are
+ * incident to the vertex bound by rinfo, reading the vertex's adjacency
+ * list in the graph's global context and fetching the edges by TID. The
+ * path is parameterized by the rels that bind the vertex, so it is only
+ * used as the inner side of a nested loop, where it competes with an index
+ * scan on start_id or end_id.
+ *
+ * Edge heap visits are costed like the heap part of an index scan. What
+ * replaces the index descent is one hash lookup for the vertex and a label
+ * check for each of its edges, avg_degree on average. The first scan may
+ * have to load the global context, which reads all graph_size vertices and
+ * edges; that is a startup cost shared by the rescans.
+ */
+CustomPath *create_cypher_graph_expand_path(PlannerInfo *root,
+                                            RelOptInfo *rel,
+                                            RestrictInfo *rinfo,
+                                            bool outgoing,
+                                            Relids required_outer,
+                                            double avg_degree,
+                                            double graph_size)
+{
+    CustomPath *cp;
+    QualCost qual_cost;
+    double spc_random_page_cost;
+    double edges_fetched;
+    double pages_fetched;
+    double loop_count = 1.0;
+    Cost run_cost;
+    Cost load_cost;
+    int relid = -1;
+
+    cp = makeNode(CustomPath);
+
+    cp->path.pathtype = T_CustomScan;
+
+    cp->path.parent = rel;
+    cp->path.pathtarget = rel->reltarget;
+
+    cp->path.param_info = get_baserel_parampathinfo(root, rel,
+                                                    required_outer);
+
+    /* The global graph contexts are backend local */
+    cp->path.parallel_aware = false;
+    cp->path.parallel_safe = false;
+    cp->path.parallel_workers = 0;
+
+    cp->path.rows = cp->path.param_info->ppi_rows;
+
+    /* Edges come out in adjacency list order */
+    cp->path.pathkeys = NIL;
+
+    /* The edges of the vertex before any other qual is checked */
+    edges_fetched = clamp_row_est(rel->tuples *
+                                  clauselist_selectivity(root,
+                                                         list_make1(rinfo),
+                                                         rel->relid,
+                                                         JOIN_INNER, NULL));
+
+    /* Rescans spread over the outer rows share the cached heap pages */
+    while ((relid = bms_next_member(required_outer, relid)) >= 0)
+    {
+        RelOptInfo *outer_rel;
+
+        if (relid >= root->simple_rel_array_size)
+        {
+            continue;
+        }
+
+        outer_rel = root->simple_rel_array[relid];
+        if (outer_rel != NULL)
+        {
+            loop_count = Max(loop_count, outer_rel->rows);
+        }
+    }
+
+    get_tablespace_page_costs(rel->reltablespace, &spc_random_page_cost,
+                              NULL);
+    pages_fetched = index_pages_fetched(edges_fetched * loop_count,
+                                        rel->pages, (double) rel->pages,
+                                        root);
+    run_cost = (pages_fetched * spc_random_page_cost) / loop_count;
+
+    /* The vertex lookup and the label check of each incident edge */
+    run_cost += cpu_operator_cost * (1.0 + avg_degree);
+
+    /* The edge lookups and the quals of the fetched edges */
+    cost_qual_eval(&qual_cost,
+                   list_concat_copy(rel->baserestrictinfo,
+                                    cp->path.param_info->ppi_clauses),
+                   root);
+    run_cost += edges_fetched * (cpu_operator_cost + cpu_tuple_cost +
+                                 qual_cost.per_tuple);
+    run_cost += cp->path.pathtarget->cost.per_tuple * cp->path.rows;
+
+    /* Scanning every entity and adding it to the hash tables */
+    load_cost = graph_size * (cpu_tuple_cost + cpu_operator_cost);
+
+    cp->path.startup_cost = qual_cost.startup +
+                            cp->path.pathtarget->cost.startup +
+                            load_cost / loop_count;
+    cp->path.total_cost = cp->path.startup_cost + run_cost;
+
+    cp->flags = 0;
+
+    /* No child paths, the edges are read directly */
+    cp->custom_paths = NIL;
+    /* The clause binding the vertex and the direction to expand in */
+    cp->custom_private = list_make2(rinfo, makeInteger(outgoing ? 1 : 0));
+    cp->methods = &cypher_graph_expand_path_methods;
+
+    return cp;
+}
@@ -19,12 +19,21 @@
 
 #include "postgres.h"
 
+#include "nodes/nodeFuncs.h"
+#include "optimizer/optimizer.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "optimizer/restrictinfo.h"
+#include "utils/lsyscache.h"
 
+#include "catalog/ag_label.h"
+#include "catalog/ag_label_stats.h"
+#include "commands/label_commands.h"
 #include "optimizer/cypher_pathnode.h"
 #include "optimizer/cypher_paths.h"
+#include "utils/ag_cache.h"
 #include "utils/ag_func.h"
+#include "utils/ag_guc.h"
 
 typedef enum cypher_clause_kind
 {
@@ -48,6 +57,19 @@ static void handle_cypher_delete_clause(PlannerInfo *root, RelOptInfo *rel,
                                         Index rti, RangeTblEntry *rte);
 static void handle_cypher_merge_clause(PlannerInfo *root, RelOptInfo *rel,
                                         Index rti, RangeTblEntry *rte);
+static void add_graph_expand_paths(PlannerInfo *root, RelOptInfo *rel,
+                                   RangeTblEntry *rte);
+static void add_graph_expand_paths_for_clauses(PlannerInfo *root,
+                                               RelOptInfo *rel,
+                                               List *clauses,
+                                               double avg_degree,
+                                               double graph_size);
+static bool is_graph_expand_clause(RestrictInfo *rinfo, RelOptInfo *rel,
+                                   bool *outgoing);
+static bool ec_member_is_edge_endpoint(PlannerInfo *root, RelOptInfo *rel,
+                                       EquivalenceClass *ec,
+                                       EquivalenceMember *em, void *arg);
+static bool has_cypher_write_clause(Node *node, void *context);
 
 void set_rel_pathlist_init(void)
 {
@@ -81,6 +103,7 @@ static void set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti,
         handle_cypher_merge_clause(root, rel, rti, rte);
         break;
     case CYPHER_CLAUSE_NONE:
+        add_graph_expand_paths(root, rel, rte);
         break;
     default:
         ereport(ERROR, (errmsg_internal("invalid cypher_clause_kind")));
@@ -226,3 +249,225 @@ static void handle_cypher_merge_clause(PlannerInfo *root, RelOptInfo *rel,
 
     add_path(rel, (Path *)cp);
 }
+
+/*
+ * Adds Graph Expand paths for an edge label relation that is joined to a
+ * vertex on start_id or end_id, one for each usable join clause. They are
+ * not considered in queries that write to the graph, whose later clauses
+ * have to see edges the context does not know about.
+ *
+ * The paths are costed from the graph statistics of age_analyze_graph(),
+ * including a load of the graph's global context, whether or not this
+ * backend has it loaded, so that the plan does not depend on what ran
+ * before. Graphs without statistics get no paths.
+ */
+static void add_graph_expand_paths(PlannerInfo *root, RelOptInfo *rel,
+                                   RangeTblEntry *rte)
+{
+    label_cache_data *label_cache;
+    PlannerInfo *top_root = root;
+    Oid graph_oid;
+    int64 num_vertices;
+    int64 num_edges;
+    double avg_degree;
+
+    if (!age_enable_graph_expand || rte->rtekind != RTE_RELATION || rte->inh)
+    {
+        return;
+    }
+
+    label_cache = search_label_relation_cache(rte->relid);
+    if (label_cache == NULL || label_cache->kind != LABEL_KIND_EDGE)
+    {
+        return;
+    }
+
+    while (top_root->parent_root != NULL)
+    {
+        top_root = top_root->parent_root;
+    }
+    if (has_cypher_write_clause((Node *) top_root->parse, NULL))
+    {
+        return;
+    }
+
+    /* the default labels stand for all vertices and all edges */
+    graph_oid = label_cache->graph;
+    if (!get_label_stats(graph_oid,
+                         get_label_id(AG_DEFAULT_LABEL_VERTEX, graph_oid),
+                         &num_vertices) ||
+        !get_label_stats(graph_oid,
+                         get_label_id(AG_DEFAULT_LABEL_EDGE, graph_oid),
+                         &num_edges))
+    {
+        return;
+    }
+
+    avg_degree = (num_vertices > 0) ? (double) num_edges / num_vertices : 0.0;
+
+    /* "e.start_id = v.id" is usually merged into an EquivalenceClass */
+    if (rel->has_eclass_joins)
+    {
+        List *clauses;
+
+        clauses = generate_implied_equalities_for_column(
+            root, rel, ec_member_is_edge_endpoint, NULL,
+            rel->lateral_referencers);
+
+        add_graph_expand_paths_for_clauses(root, rel, clauses, avg_degree,
+                                           num_vertices + num_edges);
+    }
+
+    /* OPTIONAL MATCH joins leave it as a loose join clause */
+    add_graph_expand_paths_for_clauses(root, rel, rel->joininfo, avg_degree,
+                                       num_vertices + num_edges);
+}
+
+static void add_graph_expand_paths_for_clauses(PlannerInfo *root,
+                                               RelOptInfo *rel,
+                                               List *clauses,
+                                               double avg_degree,
+                                               double graph_size)
+{
+    ListCell *lc;
+
+    foreach (lc, clauses)
+    {
+        RestrictInfo *rinfo = lfirst_node(RestrictInfo, lc);
+        Relids required_outer;
+        bool outgoing;
+
+        if (rinfo->pseudoconstant ||
+            !restriction_is_securely_promotable(rinfo, rel) ||
+            !is_graph_expand_clause(rinfo, rel, &outgoing) ||
+            !join_clause_is_movable_to(rinfo, rel))
+        {
+            continue;
+        }
+
+        required_outer = bms_union(rinfo->required_relids, rel->lateral_relids);
+        required_outer = bms_del_member(required_outer, rel->relid);
+        if (bms_is_empty(required_outer))
+        {
+            continue;
+        }
+
+        add_path(rel, (Path *) create_cypher_graph_expand_path(root, rel,
+                                                               rinfo,
+                                                               outgoing,
+                                                               required_outer,
+                                                               avg_degree,
+                                                               graph_size));
+    }
+}
+
+/*
+ * Checks if rinfo is "start_id = expr" or "end_id = expr", or the commuted
+ * form, where expr does not reference the edge relation. outgoing is set
+ * when it binds start_id, so that the vertex's out-edges are expanded.
+ */
+static bool is_graph_expand_clause(RestrictInfo *rinfo, RelOptInfo *rel,
+                                   bool *outgoing)
+{
+    OpExpr *op;
+    Node *edge_side;
+    Node *vertex_side;
+    Var *var;
+
+    if (!is_opclause(rinfo->clause))
+    {
+        return false;
+    }
+
+    op = (OpExpr *) rinfo->clause;
+    if (list_length(op->args) != 2 ||
+        exprType(linitial(op->args)) != GRAPHIDOID ||
+        exprType(lsecond(op->args)) != GRAPHIDOID ||
+        !op_mergejoinable(op->opno, GRAPHIDOID))
+    {
+        return false;
+    }
+
+    if (bms_equal(rinfo->left_relids, rel->relids) &&
+        !bms_overlap(rinfo->right_relids, rel->relids))
+    {
+        edge_side = linitial(op->args);
+        vertex_side = lsecond(op->args);
+    }
+    else if (bms_equal(rinfo->right_relids, rel->relids) &&
+             !bms_overlap(rinfo->left_relids, rel->relids))
+    {
+        edge_side = lsecond(op->args);
+        vertex_side = linitial(op->args);
+    }
+    else
+    {
+        return false;
+    }
+
+    if (!IsA(edge_side, Var) || contain_volatile_functions(vertex_side))
+    {
+        return false;
+    }
+
+    var = (Var *) edge_side;
+    if (var->varno != rel->relid || var->varlevelsup != 0)
+    {
+        return false;
+    }
+
+    if (var->varattno == Anum_ag_label_edge_table_start_id)
+    {
+        *outgoing = true;
+        return true;
+    }
+    if (var->varattno == Anum_ag_label_edge_table_end_id)
+    {
+        *outgoing = false;
+        return true;
+    }
+
+    return false;
+}
+
+static bool ec_member_is_edge_endpoint(PlannerInfo *root, RelOptInfo *rel,
+                                       EquivalenceClass *ec,
+                                       EquivalenceMember *em, void *arg)
+{
+    Var *var = (Var *) em->em_expr;
+
+    return (IsA(var, Var) && var->varno == rel->relid &&
+            var->varlevelsup == 0 &&
+            (var->varattno == Anum_ag_label_edge_table_start_id ||
+             var->varattno == Anum_ag_label_edge_table_end_id));
+}
+
+/* Checks if a query calls any of the Cypher clause functions that write */
+static bool has_cypher_write_clause(Node *node, void *context)
+{
+    if (node == NULL)
+    {
+        return false;
+    }
+
+    if (IsA(node, FuncExpr))
+    {
+        FuncExpr *fe = (FuncExpr *) node;
+
+        if (is_oid_ag_func(fe->funcid, CREATE_CLAUSE_FUNCTION_NAME) ||
+            is_oid_ag_func(fe->funcid, SET_CLAUSE_FUNCTION_NAME) ||
+            is_oid_ag_func(fe->funcid, DELETE_CLAUSE_FUNCTION_NAME) ||
+            is_oid_ag_func(fe->funcid, MERGE_CLAUSE_FUNCTION_NAME))
+        {
+            return true;
+        }
+    }
+
+    if (IsA(node, Query))
+    {
+        return query_tree_walker((Query *) node, has_cypher_write_clause,
+                                 context, 0);
+    }
+
+    return expression_tree_walker(node, has_cypher_write_clause, context);
+}
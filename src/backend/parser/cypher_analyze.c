@@ -33,6 +33,7 @@
 #include "parser/cypher_clause.h"
 #include "parser/cypher_parser.h"
 #include "utils/ag_func.h"
+#include "utils/ag_query_cache.h"
 #include "utils/age_session_info.h"
 
 typedef bool (*cypher_expression_condition)(Node *expr);
@@ -62,11 +63,9 @@ static int get_query_location(const int location, const char *source_str);
 static Query *analyze_cypher(List *stmt, ParseState *parent_pstate,
                              const char *query_str, int query_loc,
                              char *graph_name, uint32 graph_oid, Param *params);
-static Query *analyze_cypher_and_coerce(List *stmt, RangeTblFunction *rtfunc,
-                                        ParseState *parent_pstate,
-                                        const char *query_str, int query_loc,
-                                        char *graph_name, uint32 graph_oid,
-                                        Param *params);
+static Query *analyze_cypher_and_coerce(Query *subquery,
+                                        RangeTblFunction *rtfunc,
+                                        ParseState *parent_pstate);
 
 void post_parse_analyze_init(void)
 {
@@ -389,7 +388,9 @@ static void convert_cypher_to_subquery(RangeTblEntry *rte, ParseState *pstate)
     Param *params = NULL;
     errpos_ecb_state ecb_state = {{0}};
     List *stmt = NULL;
+    Query *subquery = NULL;
     Query *query = NULL;
+    bool ends_with_dml = false;
 
     /*
      * We cannot apply this feature directly to SELECT subquery because the
@@ -567,39 +568,55 @@ static void convert_cypher_to_subquery(RangeTblEntry *rte, ParseState *pstate)
     }
 
     /*
-     * install error context callback to adjust an error position for
-     * parse_cypher() since locations that parse_cypher() stores are 0 based
+     * The same query may have been analyzed before by this backend. If so,
+     * both the parsing and the analysis are skipped.
      */
-    setup_errpos_ecb(&ecb_state, pstate, query_loc);
+    subquery = search_cypher_query_cache(graph_oid, query_str, params,
+                                         &ends_with_dml);
+    if (subquery == NULL)
+    {
+        Node *popped_node;
 
-    stmt = parse_cypher(query_str);
+        /*
+         * install error context callback to adjust an error position for
+         * parse_cypher() since locations that parse_cypher() stores are 0
+         * based
+         */
+        setup_errpos_ecb(&ecb_state, pstate, query_loc);
 
-    /*
-     * Extract any extra node passed up and assign it to the global variable
-     * 'extra_node' - if it wasn't already set. It will be at the end of the
-     * stmt list and needs to be removed for normal processing, regardless.
-     * It is done this way to allow utility commands to be processed against the
-     * AGE query tree. Currently, only EXPLAIN is passed here. But, it need not
-     * just be EXPLAIN - so long as it is carefully documented and carefully
-     * done.
-     */
-    if (extra_node == NULL)
-    {
-        extra_node = llast(stmt);
-        stmt = list_delete_ptr(stmt, extra_node);
-    }
-    else
-    {
-        Node *temp = llast(stmt);
+        stmt = parse_cypher(query_str);
 
-        ereport(WARNING,
-                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                 errmsg("too many extra_nodes passed from parser")));
+        /*
+         * Extract any extra node passed up and assign it to the global
+         * variable 'extra_node' - if it wasn't already set. It will be at the
+         * end of the stmt list and needs to be removed for normal processing,
+         * regardless. It is done this way to allow utility commands to be
+         * processed against the AGE query tree. Currently, only EXPLAIN is
+         * passed here. But, it need not just be EXPLAIN - so long as it is
+         * carefully documented and carefully done.
+         */
+        popped_node = llast(stmt);
+        if (extra_node == NULL)
+        {
+            extra_node = popped_node;
+        }
+        else
+        {
+            ereport(WARNING,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("too many extra_nodes passed from parser")));
+        }
+        stmt = list_delete_ptr(stmt, popped_node);
 
-        stmt = list_delete_ptr(stmt, temp);
-    }
+        cancel_errpos_ecb(&ecb_state);
 
-    cancel_errpos_ecb(&ecb_state);
+        ends_with_dml = (is_ag_node(llast(stmt), cypher_create) ||
+                         is_ag_node(llast(stmt), cypher_set) ||
+                         is_ag_node(llast(stmt), cypher_delete) ||
+                         is_ag_node(llast(stmt), cypher_merge) ||
+                         is_ag_node(llast(stmt), cypher_create_index) ||
+                         is_ag_node(llast(stmt), cypher_drop_index));
+    }
 
     Assert(pstate->p_expr_kind == EXPR_KIND_NONE);
     pstate->p_expr_kind = EXPR_KIND_FROM_SUBSELECT;
@@ -612,8 +629,7 @@ static void convert_cypher_to_subquery(RangeTblEntry *rte, ParseState *pstate)
      * coercion logic applied to them because we are forcing the column
      * definition list to be a particular way in this case.
      */
-    if (is_ag_node(llast(stmt), cypher_create) || is_ag_node(llast(stmt), cypher_set) ||
-        is_ag_node(llast(stmt), cypher_delete) || is_ag_node(llast(stmt), cypher_merge))
+    if (ends_with_dml)
     {
         /* column definition list must be ... AS relname(colname agtype) ... */
         if (!(rtfunc->funccolcount == 1 &&
@@ -625,15 +641,28 @@ static void convert_cypher_to_subquery(RangeTblEntry *rte, ParseState *pstate)
                      errhint("... cypher($$ ... CREATE ... $$) AS t(c agtype) ..."),
                      parser_errposition(pstate, exprLocation(rtfunc->funcexpr))));
         }
+    }
+
+    if (subquery == NULL)
+    {
+        subquery = analyze_cypher(stmt, pstate, query_str, query_loc,
+                                  graph_name_str, graph_oid, params);
 
-        query = analyze_cypher(stmt, pstate, query_str, query_loc,
-                               graph_name_str, graph_oid, params);
+        /* EXPLAIN inside the query string is not part of the analyzed tree */
+        if (extra_node == NULL)
+        {
+            store_cypher_query_cache(graph_oid, query_str, params,
+                                     ends_with_dml, subquery);
+        }
+    }
+
+    if (ends_with_dml)
+    {
+        query = subquery;
     }
     else
     {
-        query = analyze_cypher_and_coerce(stmt, rtfunc, pstate, query_str,
-                                          query_loc, graph_name_str, graph_oid,
-                                          params);
+        query = analyze_cypher_and_coerce(subquery, rtfunc, pstate);
     }
 
     pstate->p_lateral_active = false;
@@ -1004,16 +1033,13 @@ static Query *analyze_cypher(List *stmt, ParseState *parent_pstate,
  * BY), we cannot apply the coercion directly to the expressions of the target
  * entries. Therefore, we do the coercion by doing SELECT over subquery.
  */
-static Query *analyze_cypher_and_coerce(List *stmt, RangeTblFunction *rtfunc,
-                                        ParseState *parent_pstate,
-                                        const char *query_str, int query_loc,
-                                        char *graph_name, uint32 graph_oid,
-                                        Param *params)
+static Query *analyze_cypher_and_coerce(Query *subquery,
+                                        RangeTblFunction *rtfunc,
+                                        ParseState *parent_pstate)
 {
     ParseState *pstate;
     Query *query;
     const bool lateral = false;
-    Query *subquery;
     ParseNamespaceItem *pnsi;
     int rtindex;
     ListCell *lt;
@@ -1029,19 +1055,10 @@ static Query *analyze_cypher_and_coerce(List *stmt, RangeTblFunction *rtfunc,
     query->commandType = CMD_SELECT;
 
     /*
-     * Below is similar to transform_prev_cypher_clause().
+     * Below is similar to transform_prev_cypher_clause(). subquery has been
+     * analyzed by analyze_cypher() already.
      */
 
-    Assert(pstate->p_expr_kind == EXPR_KIND_NONE);
-    pstate->p_expr_kind = EXPR_KIND_FROM_SUBSELECT;
-    pstate->p_lateral_active = lateral;
-
-    subquery = analyze_cypher(stmt, pstate, query_str, query_loc, graph_name,
-                              graph_oid, (Param *)params);
-
-    pstate->p_lateral_active = false;
-    pstate->p_expr_kind = EXPR_KIND_NONE;
-
     /* ALIAS Syntax makes `RESJUNK`. So, It must be skipping. */
     foreach(lt, subquery->targetList)
     {
@@ -26,6 +26,9 @@
 
 #include "access/heapam.h"
 #include "catalog/pg_aggregate.h"
+#include "catalog/pg_collation.h"
+#include "catalog/pg_inherits.h"
+#include "catalog/pg_type.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/optimizer.h"
@@ -39,11 +42,13 @@
 #include "parser/parsetree.h"
 #include "parser/parse_relation.h"
 #include "rewrite/rewriteHandler.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/lsyscache.h"
 
 #include "catalog/ag_graph.h"
 #include "catalog/ag_label.h"
+#include "commands/index_commands.h"
 #include "commands/label_commands.h"
 #include "parser/cypher_analyze.h"
 #include "parser/cypher_clause.h"
@@ -123,7 +128,11 @@ static Query *transform_cypher_match_pattern(cypher_parsestate *cpstate,
 static List *transform_match_entities(cypher_parsestate *cpstate, Query *query,
                                       cypher_path *path);
 static void transform_match_pattern(cypher_parsestate *cpstate, Query *query,
-                                    List *pattern, Node *where);
+                                    List *pattern, Node *where,
+                                    bool allow_multiway_join);
+static bool label_has_children(cypher_parsestate *cpstate, char *label);
+static List *make_multiway_join_quals(cypher_parsestate *cpstate,
+                                      List *entities);
 static List *transform_match_path(cypher_parsestate *cpstate, Query *query,
                                   cypher_path *path);
 static Expr *transform_cypher_edge(cypher_parsestate *cpstate,
@@ -134,6 +143,8 @@ static Expr *transform_cypher_node(cypher_parsestate *cpstate,
                                    bool output_node, bool valid_label);
 static bool match_check_valid_label(cypher_match *match,
                                     cypher_parsestate *cpstate);
+static Node *make_label_name_expr(cypher_parsestate *cpstate,
+                                  ParseNamespaceItem *pnsi, Node *id);
 static Node *make_vertex_expr(cypher_parsestate *cpstate,
                               ParseNamespaceItem *pnsi);
 static Node *make_edge_expr(cypher_parsestate *cpstate,
@@ -175,6 +186,9 @@ static Node *create_property_constraints(cypher_parsestate *cpstate,
                                          transform_entity *entity,
                                          Node *property_constraints,
                                          Node *prop_expr);
+static List *make_property_index_quals(cypher_parsestate *cpstate,
+                                       transform_entity *entity,
+                                       Node *property_constraints);
 static TargetEntry *findTarget(List *targetList, char *resname);
 static transform_entity *transform_VLE_edge_entity(cypher_parsestate *cpstate,
                                                    cypher_relationship *rel,
@@ -297,6 +311,17 @@ static Query *transform_cypher_call_stmt(cypher_parsestate *cpstate,
 static Query *transform_cypher_call_subquery(cypher_parsestate *cpstate,
                                              cypher_clause *clause);
 
+/* schema commands */
+static Query *transform_cypher_create_index(cypher_parsestate *cpstate,
+                                            cypher_clause *clause);
+static Query *transform_cypher_drop_index(cypher_parsestate *cpstate,
+                                          cypher_clause *clause);
+static Query *make_schema_command_query(cypher_parsestate *cpstate,
+                                        cypher_clause *clause,
+                                        char *function_name, List *args,
+                                        int location);
+static Const *make_name_const(char *name);
+
 /* transform */
 #define PREV_CYPHER_CLAUSE_ALIAS AGE_DEFAULT_ALIAS_PREFIX"previous_cypher_clause"
 #define CYPHER_OPT_RIGHT_ALIAS AGE_DEFAULT_ALIAS_PREFIX"cypher_optional_right"
@@ -517,6 +542,14 @@ Query *transform_cypher_clause(cypher_parsestate *cpstate,
     {
         result = transform_cypher_call_stmt(cpstate, clause);
     }
+    else if (is_ag_node(self, cypher_create_index))
+    {
+        result = transform_cypher_create_index(cpstate, clause);
+    }
+    else if (is_ag_node(self, cypher_drop_index))
+    {
+        result = transform_cypher_drop_index(cpstate, clause);
+    }
     else if (is_ag_node(self, cypher_list_comprehension))
     {
         result = transform_cypher_list_comprehension(cpstate, clause);
@@ -1402,6 +1435,198 @@ static Query *transform_cypher_call_subquery(cypher_parsestate *cpstate,
     return query;
 }
 
+/*
+ * CREATE INDEX [name] [IF NOT EXISTS] FOR (n:Label) ON (n.key [, ...])
+ * CREATE INDEX [name] [IF NOT EXISTS] FOR ()-[r:Label]-() ON (r.key [, ...])
+ *
+ * The index is created when the query runs, by
+ * _cypher_create_property_index(), on the same expression as n.key is
+ * transformed into. So, the planner can use it for the n.key predicates of
+ * MATCH without any rewriting.
+ *
+ * CREATE CONSTRAINT [name] [IF NOT EXISTS] FOR (n:Label)
+ *     REQUIRE n.key IS UNIQUE
+ * CREATE CONSTRAINT [name] [IF NOT EXISTS] FOR (n:Label)
+ *     REQUIRE (n.key [, ...]) IS UNIQUE
+ *
+ * The constraint is the same index, only unique.
+ */
+static Query *transform_cypher_create_index(cypher_parsestate *cpstate,
+                                            cypher_clause *clause)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    cypher_create_index *self = (cypher_create_index *)clause->self;
+    char *command = self->unique ? "CREATE CONSTRAINT" : "CREATE INDEX";
+    char *var_name;
+    char *label;
+    char label_kind;
+    Node *props;
+    Datum *keys;
+    int nkeys = 0;
+    ListCell *lc;
+    List *args;
+
+    if (is_ag_node(self->entity, cypher_node))
+    {
+        cypher_node *node = (cypher_node *)self->entity;
+
+        var_name = node->name;
+        label = node->label;
+        label_kind = LABEL_KIND_VERTEX;
+        props = node->props;
+    }
+    else
+    {
+        cypher_relationship *rel = (cypher_relationship *)self->entity;
+
+        if (rel->varlen != NULL)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_SYNTAX_ERROR),
+                     errmsg("%s does not support variable length relationships",
+                            command),
+                     parser_errposition(pstate, rel->location)));
+        }
+
+        var_name = rel->name;
+        label = rel->label;
+        label_kind = LABEL_KIND_EDGE;
+        props = rel->props;
+    }
+
+    if (var_name == NULL || label == NULL || props != NULL)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_SYNTAX_ERROR),
+                 errmsg("%s expects (n:Label) or ()-[r:Label]-()", command),
+                 parser_errposition(pstate, self->location)));
+    }
+
+    keys = palloc(sizeof(Datum) * list_length(self->properties));
+    foreach (lc, self->properties)
+    {
+        Node *prop = lfirst(lc);
+        A_Indirection *indir;
+        ColumnRef *cr;
+
+        if (!IsA(prop, A_Indirection) ||
+            !IsA(((A_Indirection *)prop)->arg, ColumnRef))
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_SYNTAX_ERROR),
+                     errmsg("%s expects properties of \"%s\"", command,
+                            var_name),
+                     parser_errposition(pstate, exprLocation(prop))));
+        }
+
+        indir = (A_Indirection *)prop;
+        cr = (ColumnRef *)indir->arg;
+        if (list_length(cr->fields) != 1 ||
+            strcmp(strVal(linitial(cr->fields)), var_name) != 0 ||
+            list_length(indir->indirection) != 1 ||
+            !IsA(linitial(indir->indirection), String))
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_SYNTAX_ERROR),
+                     errmsg("%s expects properties of \"%s\"", command,
+                            var_name),
+                     parser_errposition(pstate, cr->location)));
+        }
+
+        keys[nkeys++] = CStringGetTextDatum(strVal(linitial(indir->indirection)));
+    }
+
+    args = list_make3(make_name_const(cpstate->graph_name),
+                      make_name_const(label),
+                      makeConst(CHAROID, -1, InvalidOid, 1,
+                                CharGetDatum(label_kind), false, true));
+    args = lappend(args,
+                   makeConst(TEXTARRAYOID, -1, DEFAULT_COLLATION_OID, -1,
+                             PointerGetDatum(construct_array(
+                                 keys, nkeys, TEXTOID, -1, false,
+                                 TYPALIGN_INT)),
+                             false, false));
+    args = lappend(args, self->name != NULL ?
+                         (Node *)make_name_const(self->name) :
+                         (Node *)makeNullConst(NAMEOID, -1, C_COLLATION_OID));
+    args = lappend(args, makeBoolConst(self->if_not_exists, false));
+    args = lappend(args, makeBoolConst(self->unique, false));
+
+    return make_schema_command_query(cpstate, clause,
+                                     CREATE_PROPERTY_INDEX_FUNCTION_NAME, args,
+                                     self->location);
+}
+
+/* DROP INDEX name [IF EXISTS] or DROP CONSTRAINT name [IF EXISTS] */
+static Query *transform_cypher_drop_index(cypher_parsestate *cpstate,
+                                          cypher_clause *clause)
+{
+    cypher_drop_index *self = (cypher_drop_index *)clause->self;
+    List *args;
+
+    args = list_make4(make_name_const(cpstate->graph_name),
+                      make_name_const(self->name),
+                      makeBoolConst(self->if_exists, false),
+                      makeBoolConst(self->unique, false));
+
+    return make_schema_command_query(cpstate, clause,
+                                     DROP_PROPERTY_INDEX_FUNCTION_NAME, args,
+                                     self->location);
+}
+
+/*
+ * SELECT ag_catalog.<function_name>(<args>)
+ *
+ * Schema commands stand alone. The function does the work when the query
+ * runs and returns no rows.
+ */
+static Query *make_schema_command_query(cypher_parsestate *cpstate,
+                                        cypher_clause *clause,
+                                        char *function_name, List *args,
+                                        int location)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    Query *query;
+    FuncCall *func;
+    Node *expr;
+    TargetEntry *tle;
+
+    if (clause->prev != NULL || clause->next != NULL)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_SYNTAX_ERROR),
+                 errmsg("schema commands cannot be combined with other clauses"),
+                 parser_errposition(pstate, location)));
+    }
+
+    query = makeNode(Query);
+    query->commandType = CMD_SELECT;
+
+    func = makeFuncCall(list_make2(makeString("ag_catalog"),
+                                   makeString(function_name)),
+                        args, COERCE_EXPLICIT_CALL, location);
+    expr = transform_cypher_expr(cpstate, (Node *)func,
+                                 EXPR_KIND_SELECT_TARGET);
+
+    tle = makeTargetEntry((Expr *)expr, pstate->p_next_resno++, function_name,
+                          false);
+    query->targetList = list_make1(tle);
+
+    query->rtable = pstate->p_rtable;
+    query->rteperminfos = pstate->p_rteperminfos;
+    query->jointree = makeFromExpr(NIL, NULL);
+    query->hasTargetSRFs = pstate->p_hasTargetSRFs;
+
+    return query;
+}
+
+static Const *make_name_const(char *name)
+{
+    return makeConst(NAMEOID, -1, C_COLLATION_OID, NAMEDATALEN,
+                     DirectFunctionCall1(namein, CStringGetDatum(name)),
+                     false, false);
+}
+
 /*
  * Transform the Delete clause. Creates a _cypher_delete_clause
  * and passes the necessary information that is needed in the
@@ -3332,6 +3557,8 @@ static Query *transform_cypher_match_pattern(cypher_parsestate *cpstate,
     }
     else
     {
+        bool allow_multiway_join = true;
+
         if (clause->prev)
         {
             RangeTblEntry *rte;
@@ -3358,6 +3585,12 @@ static Query *transform_cypher_match_pattern(cypher_parsestate *cpstate,
                 rte->security_barrier = true;
             }
 
+            /*
+             * The global graph context would not see what the predecessor
+             * chain writes, so cycles are joined by the planner instead.
+             */
+            allow_multiway_join = !has_dml;
+
             rtindex = list_length(pstate->p_rtable);
             /* rte is the first RangeTblEntry in pstate */
             if (rtindex != 1)
@@ -3395,7 +3628,8 @@ static Query *transform_cypher_match_pattern(cypher_parsestate *cpstate,
             }
         }
 
-        transform_match_pattern(cpstate, query, self->pattern, where);
+        transform_match_pattern(cpstate, query, self->pattern, where,
+                                allow_multiway_join);
     }
 
     markTargetListOrigins(pstate, query->targetList);
@@ -3787,13 +4021,15 @@ static ParseNamespaceItem *transform_RangeFunction(cypher_parsestate *cpstate,
 }
 
 static void transform_match_pattern(cypher_parsestate *cpstate, Query *query,
-                                    List *pattern, Node *where)
+                                    List *pattern, Node *where,
+                                    bool allow_multiway_join)
 {
     ParseState *pstate = (ParseState *)cpstate;
     ListCell *lc;
     List *quals = NIL;
     Expr *q = NULL;
     Expr *expr = NULL;
+    int num_prev_entities = list_length(cpstate->entities);
 
     /*
      * Loop through a comma separated list of paths like (u)-[e]-(v), (w), (x)
@@ -3811,6 +4047,19 @@ static void transform_match_pattern(cypher_parsestate *cpstate, Query *query,
         quals = list_concat(quals, qual);
     }
 
+    /*
+     * Join a cyclic pattern over the adjacency of the global graph. The
+     * function enumerates every cycle of the graph before the quals apply,
+     * so a WHERE clause, which may anchor the pattern, keeps the plain join.
+     */
+    if (allow_multiway_join && age_enable_multiway_join && where == NULL)
+    {
+        List *entities = list_copy_tail(cpstate->entities, num_prev_entities);
+
+        quals = list_concat(quals,
+                            make_multiway_join_quals(cpstate, entities));
+    }
+
     if (quals != NIL)
     {
         q = makeBoolExpr(AND_EXPR, quals, -1);
@@ -3871,6 +4120,334 @@ static void transform_match_pattern(cypher_parsestate *cpstate, Query *query,
     query->jointree = makeFromExpr(cpstate->pstate.p_joinlist, (Node *)expr);
 }
 
+/*
+ * If the vertices and edges of a MATCH pattern form a cycle, adds
+ *
+ *     ag_catalog.age_match_cycle(graph, vertex_labels, edge_labels,
+ *                                edge_starts, edge_ends, edge_directed)
+ *
+ * to the FROM clause and returns the quals that equate the id of each
+ * vertex and edge with its element of the function's vertex_ids and
+ * edge_ids. The function joins the whole pattern by intersecting adjacency
+ * lists, so the planner can drive the join from it instead of building the
+ * partial paths of the cycle edge by edge. The path quals are kept, so the
+ * result does not change.
+ *
+ * Patterns with VLE edges, with variables from a previous clause, or with
+ * invalid labels are left alone, as are acyclic ones, which the planner
+ * joins without blowing up already. So are patterns with a label that other
+ * labels inherit from, since the function matches label ids exactly, and
+ * patterns with property maps, which the function does not start from.
+ */
+static List *make_multiway_join_quals(cypher_parsestate *cpstate,
+                                      List *entities)
+{
+    List *vertices = NIL;
+    List *edges = NIL;
+    transform_entity *edge = NULL;
+    int prev_index = -1;
+    int32 *parents;
+    int32 *edge_starts;
+    int32 *edge_ends;
+    bool *edge_directed;
+    Datum *vertex_labels;
+    Datum *edge_labels;
+    Datum *values;
+    bool cyclic = false;
+    int num_vertices;
+    int num_edges;
+    int i;
+    ListCell *lc;
+    FuncCall *func;
+    RangeFunction *rf;
+    Alias *alias;
+    List *args;
+    List *quals = NIL;
+
+    /*
+     * Collect the distinct vertices and the edges. The entities of a path
+     * alternate between vertices and edges, so each edge's endpoints are
+     * the vertices around it.
+     */
+    edge_starts = palloc(sizeof(int32) * (list_length(entities) + 1));
+    edge_ends = palloc(sizeof(int32) * (list_length(entities) + 1));
+    edge_directed = palloc(sizeof(bool) * (list_length(entities) + 1));
+
+    foreach (lc, entities)
+    {
+        transform_entity *entity = lfirst(lc);
+        ListCell *lc2;
+        int index = 0;
+
+        if (entity->type == ENT_PATH)
+        {
+            continue;
+        }
+
+        /* only entities that scan a label table in this clause qualify */
+        if (entity->type == ENT_VLE_EDGE || entity->expr == NULL ||
+            !IsA(entity->expr, RowExpr))
+        {
+            return NIL;
+        }
+
+        /* a property map anchors the pattern, which the plain join uses */
+        if ((entity->type == ENT_EDGE && entity->entity.rel->props != NULL) ||
+            (entity->type == ENT_VERTEX && entity->entity.node->props != NULL))
+        {
+            return NIL;
+        }
+
+        if (entity->type == ENT_EDGE)
+        {
+            foreach (lc2, edges)
+            {
+                transform_entity *other = lfirst(lc2);
+
+                if (strcmp(other->entity.rel->name,
+                           entity->entity.rel->name) == 0)
+                {
+                    return NIL;
+                }
+            }
+
+            edges = lappend(edges, entity);
+            edge = entity;
+            continue;
+        }
+
+        foreach (lc2, vertices)
+        {
+            transform_entity *other = lfirst(lc2);
+
+            if (strcmp(other->entity.node->name,
+                       entity->entity.node->name) == 0)
+            {
+                break;
+            }
+            index++;
+        }
+        if (lc2 == NULL)
+        {
+            vertices = lappend(vertices, entity);
+        }
+
+        /* this vertex ends the edge that follows the previous vertex */
+        if (edge != NULL)
+        {
+            i = list_length(edges) - 1;
+            switch (edge->entity.rel->dir)
+            {
+                case CYPHER_REL_DIR_LEFT:
+                    edge_starts[i] = index;
+                    edge_ends[i] = prev_index;
+                    edge_directed[i] = true;
+                    break;
+                case CYPHER_REL_DIR_RIGHT:
+                    edge_starts[i] = prev_index;
+                    edge_ends[i] = index;
+                    edge_directed[i] = true;
+                    break;
+                default:
+                    edge_starts[i] = prev_index;
+                    edge_ends[i] = index;
+                    edge_directed[i] = false;
+                    break;
+            }
+            edge = NULL;
+        }
+        prev_index = index;
+    }
+
+    num_vertices = list_length(vertices);
+    num_edges = list_length(edges);
+
+    /* the pattern is cyclic if an edge joins vertices already connected */
+    parents = palloc(sizeof(int32) * (num_vertices + 1));
+    for (i = 0; i < num_vertices; i++)
+    {
+        parents[i] = i;
+    }
+    for (i = 0; i < num_edges && !cyclic; i++)
+    {
+        int32 start = edge_starts[i];
+        int32 end = edge_ends[i];
+
+        while (parents[start] != start)
+        {
+            start = parents[start];
+        }
+        while (parents[end] != end)
+        {
+            end = parents[end];
+        }
+
+        cyclic = (start == end);
+        parents[start] = end;
+    }
+
+    if (!cyclic)
+    {
+        return NIL;
+    }
+
+    vertex_labels = palloc(sizeof(Datum) * num_vertices);
+    i = 0;
+    foreach (lc, vertices)
+    {
+        cypher_node *node = ((transform_entity *)lfirst(lc))->entity.node;
+
+        if (label_has_children(cpstate, node->label))
+        {
+            return NIL;
+        }
+
+        vertex_labels[i++] = CStringGetTextDatum(node->label != NULL ?
+                                                 node->label :
+                                                 AG_DEFAULT_LABEL_VERTEX);
+    }
+
+    edge_labels = palloc(sizeof(Datum) * num_edges);
+    values = palloc(sizeof(Datum) * num_edges * 3);
+    i = 0;
+    foreach (lc, edges)
+    {
+        cypher_relationship *rel =
+            ((transform_entity *)lfirst(lc))->entity.rel;
+
+        if (label_has_children(cpstate, rel->label))
+        {
+            return NIL;
+        }
+
+        edge_labels[i] = CStringGetTextDatum(rel->label != NULL ?
+                                             rel->label :
+                                             AG_DEFAULT_LABEL_EDGE);
+        values[i] = Int32GetDatum(edge_starts[i]);
+        values[num_edges + i] = Int32GetDatum(edge_ends[i]);
+        values[num_edges * 2 + i] = BoolGetDatum(edge_directed[i]);
+        i++;
+    }
+
+    /* the arguments are constants already, which the transform passes on */
+    args = list_make1(makeConst(NAMEOID, -1, C_COLLATION_OID, NAMEDATALEN,
+                                DirectFunctionCall1(namein,
+                                    CStringGetDatum(cpstate->graph_name)),
+                                false, false));
+    args = lappend(args,
+                   makeConst(TEXTARRAYOID, -1, DEFAULT_COLLATION_OID, -1,
+                             PointerGetDatum(construct_array(
+                                 vertex_labels, num_vertices, TEXTOID, -1,
+                                 false, TYPALIGN_INT)),
+                             false, false));
+    args = lappend(args,
+                   makeConst(TEXTARRAYOID, -1, DEFAULT_COLLATION_OID, -1,
+                             PointerGetDatum(construct_array(
+                                 edge_labels, num_edges, TEXTOID, -1, false,
+                                 TYPALIGN_INT)),
+                             false, false));
+    args = lappend(args,
+                   makeConst(INT4ARRAYOID, -1, InvalidOid, -1,
+                             PointerGetDatum(construct_array(
+                                 values, num_edges, INT4OID, 4, true,
+                                 TYPALIGN_INT)),
+                             false, false));
+    args = lappend(args,
+                   makeConst(INT4ARRAYOID, -1, InvalidOid, -1,
+                             PointerGetDatum(construct_array(
+                                 values + num_edges, num_edges, INT4OID, 4,
+                                 true, TYPALIGN_INT)),
+                             false, false));
+    args = lappend(args,
+                   makeConst(BOOLARRAYOID, -1, InvalidOid, -1,
+                             PointerGetDatum(construct_array(
+                                 values + num_edges * 2, num_edges, BOOLOID,
+                                 1, true, TYPALIGN_CHAR)),
+                             false, false));
+
+    func = makeFuncCall(list_make2(makeString("ag_catalog"),
+                                   makeString("age_match_cycle")),
+                        args, COERCE_EXPLICIT_CALL, -1);
+
+    rf = makeNode(RangeFunction);
+    rf->lateral = false;
+    rf->ordinality = false;
+    rf->is_rowsfrom = false;
+    rf->functions = list_make1(list_make2(func, NIL));
+
+    alias = makeNode(Alias);
+    alias->aliasname = get_next_default_alias(cpstate);
+    alias->colnames = NIL;
+    rf->alias = alias;
+
+    append_VLE_Func_to_FromClause(cpstate, (Node *)rf);
+
+    /* <entity>.id = <alias>.vertex_ids[i] and <alias>.edge_ids[i] */
+    for (i = 0; i < num_vertices + num_edges; i++)
+    {
+        transform_entity *entity;
+        A_Indirection *indir = makeNode(A_Indirection);
+        A_Indices *ind = makeNode(A_Indices);
+        ColumnRef *cr = makeNode(ColumnRef);
+        A_Const *n = makeNode(A_Const);
+        char *col_name;
+
+        if (i < num_vertices)
+        {
+            entity = list_nth(vertices, i);
+            col_name = "vertex_ids";
+            n->val.ival.ival = i + 1;
+        }
+        else
+        {
+            entity = list_nth(edges, i - num_vertices);
+            col_name = "edge_ids";
+            n->val.ival.ival = i - num_vertices + 1;
+        }
+
+        n->val.ival.type = T_Integer;
+        n->location = -1;
+
+        ind->is_slice = false;
+        ind->uidx = (Node *)n;
+
+        cr->fields = list_make2(makeString(alias->aliasname),
+                                makeString(col_name));
+        cr->location = -1;
+
+        indir->arg = (Node *)cr;
+        indir->indirection = list_make1(ind);
+
+        quals = lappend(quals,
+                        makeSimpleA_Expr(AEXPR_OP, "=",
+                                         make_qual(cpstate, entity, "id"),
+                                         (Node *)indir, -1));
+    }
+
+    return quals;
+}
+
+/*
+ * Returns true if the table of the label is inherited by other label tables.
+ * The default labels, which match any label, are not checked. Adding a child
+ * invalidates the plans that scan the parent, so the pattern is transformed
+ * again when it happens.
+ */
+static bool label_has_children(cypher_parsestate *cpstate, char *label)
+{
+    Oid relid;
+
+    if (label == NULL || strcmp(label, AG_DEFAULT_LABEL_VERTEX) == 0 ||
+        strcmp(label, AG_DEFAULT_LABEL_EDGE) == 0)
+    {
+        return false;
+    }
+
+    relid = get_label_relation(label, cpstate->graph_oid);
+
+    return OidIsValid(relid) && has_subclass(relid);
+}
+
 /*
  * Creates a FuncCall node that will prevent an edge from being joined
  * to twice.
@@ -4702,6 +5279,7 @@ static Node *create_property_constraints(cypher_parsestate *cpstate,
     Node *const_expr;
     Node *last_srf = pstate->p_last_srf;
     ParseNamespaceItem *pnsi;
+    List *index_quals = NIL;
 
     Assert(entity->type != ENT_PATH);
 
@@ -4729,6 +5307,13 @@ static Node *create_property_constraints(cypher_parsestate *cpstate,
         {
             prop_expr = transformExpr(pstate, (Node *)cr, EXPR_KIND_WHERE);
         }
+
+        /* the entity is scanned by this clause, so its indexes matter */
+        if (age_enable_containment)
+        {
+            index_quals = make_property_index_quals(cpstate, entity,
+                                                    property_constraints);
+        }
     }
 
     /* use cypher to get the constraints' transform node */
@@ -4737,18 +5322,33 @@ static Node *create_property_constraints(cypher_parsestate *cpstate,
 
     if (age_enable_containment)
     {
+        Node *containment;
+
         if ((entity->type == ENT_VERTEX && entity->entity.node->use_equals) ||
             ((entity->type == ENT_EDGE || entity->type == ENT_VLE_EDGE) &&
              entity->entity.rel->use_equals))
         {
-            return (Node *)make_op(pstate, list_make1(makeString("@>>")),
-                                   prop_expr, const_expr, last_srf, -1);
+            containment = (Node *)make_op(pstate,
+                                          list_make1(makeString("@>>")),
+                                          prop_expr, const_expr, last_srf,
+                                          -1);
         }
         else
         {
-            return (Node *)make_op(pstate, list_make1(makeString("@>")),
-                                   prop_expr, const_expr, last_srf, -1);
+            containment = (Node *)make_op(pstate,
+                                          list_make1(makeString("@>")),
+                                          prop_expr, const_expr, last_srf,
+                                          -1);
+        }
+
+        if (index_quals != NIL)
+        {
+            return (Node *)makeBoolExpr(AND_EXPR,
+                                        lappend(index_quals, containment),
+                                        -1);
         }
+
+        return containment;
     }
     else
     {
@@ -4789,6 +5389,94 @@ static Node *create_property_constraints(cypher_parsestate *cpstate,
     }
 }
 
+/*
+ * Containment cannot use the btree indexes on the properties of the label,
+ * which CREATE INDEX makes. For each key of the property map that such an
+ * index leads with, returns n.key = value, which the containment implies, so
+ * that the planner can scan the index. Lists, maps, and nulls are compared
+ * differently by containment, so they are left to it.
+ */
+static List *make_property_index_quals(cypher_parsestate *cpstate,
+                                       transform_entity *entity,
+                                       Node *property_constraints)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    cypher_map *map;
+    char *label;
+    Oid label_relation;
+    List *index_keys = NIL;
+    List *quals = NIL;
+    ListCell *lc;
+    int i;
+
+    if (!is_ag_node(property_constraints, cypher_map))
+    {
+        return NIL;
+    }
+
+    if (entity->type == ENT_VERTEX)
+    {
+        label = entity->entity.node->label != NULL ?
+                entity->entity.node->label : AG_DEFAULT_LABEL_VERTEX;
+    }
+    else if (entity->type == ENT_EDGE)
+    {
+        label = entity->entity.rel->label != NULL ?
+                entity->entity.rel->label : AG_DEFAULT_LABEL_EDGE;
+    }
+    else
+    {
+        return NIL;
+    }
+
+    label_relation = get_label_relation(label, cpstate->graph_oid);
+    if (!OidIsValid(label_relation))
+    {
+        return NIL;
+    }
+
+    foreach (lc, get_label_property_indexes(label_relation))
+    {
+        property_index *index = lfirst(lc);
+
+        index_keys = list_append_unique(index_keys, linitial(index->keys));
+    }
+
+    map = (cypher_map *)property_constraints;
+    for (i = 0; index_keys != NIL && i < list_length(map->keyvals); i += 2)
+    {
+        String *key = list_nth(map->keyvals, i);
+        Node *val = list_nth(map->keyvals, i + 1);
+        ColumnRef *cr;
+        A_Indirection *indir;
+        Node *lhs;
+        Node *rhs;
+
+        if (!list_member(index_keys, key) || is_ag_node(val, cypher_map) ||
+            is_ag_node(val, cypher_list) ||
+            (IsA(val, A_Const) && ((A_Const *)val)->isnull))
+        {
+            continue;
+        }
+
+        cr = makeNode(ColumnRef);
+        cr->fields = list_make1(makeString(get_entity_name(entity)));
+        cr->location = -1;
+
+        indir = makeNode(A_Indirection);
+        indir->arg = (Node *)cr;
+        indir->indirection = list_make1(makeString(strVal(key)));
+
+        lhs = transform_cypher_expr(cpstate, (Node *)indir, EXPR_KIND_WHERE);
+        rhs = transform_cypher_expr(cpstate, val, EXPR_KIND_WHERE);
+
+        quals = lappend(quals, make_op(pstate, list_make1(makeString("=")),
+                                       lhs, rhs, pstate->p_last_srf, -1));
+    }
+
+    return quals;
+}
+
 /*
  * For the given path, transform each entity within the path, create
  * the path variable if needed, and construct the quals to enforce the
@@ -6277,24 +6965,48 @@ static Expr *transform_cypher_node(cypher_parsestate *cpstate,
     return expr;
 }
 
-static Node *make_edge_expr(cypher_parsestate *cpstate,
-                            ParseNamespaceItem *pnsi)
+/*
+ * Make the expression for the label of the entities scanned through pnsi.
+ *
+ * The label of an entity is the one its id was made for, which is the label
+ * of the table that stores it. When the table of pnsi is not inherited by
+ * other label tables, every entity scanned has its label, and the label is a
+ * constant, so no row looks it up. Otherwise, it is looked up from the id of
+ * each entity with _label_name(). Making a label table a parent invalidates
+ * the plans made with the constant, and they are analyzed again.
+ */
+static Node *make_label_name_expr(cypher_parsestate *cpstate,
+                                  ParseNamespaceItem *pnsi, Node *id)
 {
-    ParseState *pstate = (ParseState *)cpstate;
+    Oid relid = pnsi->p_rte->relid;
     Oid label_name_func_oid;
-    Node *id, *start_id, *end_id;
     Const *graph_oid_const;
-    Node *props;
     List *label_name_args;
     FuncExpr *label_name_func_expr;
-    RowExpr *row_expr;
 
-    /* Get raw column references */
-    id = scanNSItemForColumn(pstate, pnsi, 0, AG_EDGE_COLNAME_ID, -1);
+    if (!has_subclass(relid))
+    {
+        label_cache_data *lcd = search_label_relation_cache(relid);
 
-    start_id = scanNSItemForColumn(pstate, pnsi, 0, AG_EDGE_COLNAME_START_ID, -1);
+        if (lcd != NULL)
+        {
+            char *label_name = NameStr(lcd->name);
+            Datum label;
 
-    end_id = scanNSItemForColumn(pstate, pnsi, 0, AG_EDGE_COLNAME_END_ID, -1);
+            /* the same as _label_name() */
+            if (IS_AG_DEFAULT_LABEL(label_name))
+            {
+                label = string_to_agtype("");
+            }
+            else
+            {
+                label = string_to_agtype(label_name);
+            }
+
+            return (Node *)makeConst(AGTYPEOID, -1, InvalidOid, -1, label,
+                                     false, false);
+        }
+    }
 
     label_name_func_oid = get_ag_func_oid("_label_name", 2, OIDOID,
                                           GRAPHIDOID);
@@ -6310,6 +7022,27 @@ static Node *make_edge_expr(cypher_parsestate *cpstate,
                                         InvalidOid, COERCE_EXPLICIT_CALL);
     label_name_func_expr->location = -1;
 
+    return (Node *)label_name_func_expr;
+}
+
+static Node *make_edge_expr(cypher_parsestate *cpstate,
+                            ParseNamespaceItem *pnsi)
+{
+    ParseState *pstate = (ParseState *)cpstate;
+    Node *id, *start_id, *end_id;
+    Node *label_name_expr;
+    Node *props;
+    RowExpr *row_expr;
+
+    /* Get raw column references */
+    id = scanNSItemForColumn(pstate, pnsi, 0, AG_EDGE_COLNAME_ID, -1);
+
+    start_id = scanNSItemForColumn(pstate, pnsi, 0, AG_EDGE_COLNAME_START_ID, -1);
+
+    end_id = scanNSItemForColumn(pstate, pnsi, 0, AG_EDGE_COLNAME_END_ID, -1);
+
+    label_name_expr = make_label_name_expr(cpstate, pnsi, id);
+
     props = scanNSItemForColumn(pstate, pnsi, 0, AG_EDGE_COLNAME_PROPERTIES, -1);
 
     /*
@@ -6318,7 +7051,7 @@ static Node *make_edge_expr(cypher_parsestate *cpstate,
      * Implicit cast to agtype is used when needed.
      */
     row_expr = makeNode(RowExpr);
-    row_expr->args = list_make5(id, label_name_func_expr, end_id, start_id, props);
+    row_expr->args = list_make5(id, label_name_expr, end_id, start_id, props);
     row_expr->row_typeid = EDGEOID;
     row_expr->row_format = COERCE_EXPLICIT_CALL;
     row_expr->colnames = list_make5(makeString("id"),
@@ -6334,31 +7067,16 @@ static Node *make_vertex_expr(cypher_parsestate *cpstate,
                               ParseNamespaceItem *pnsi)
 {
     ParseState *pstate = (ParseState *)cpstate;
-    Oid label_name_func_oid;
     Node *id;
-    Const *graph_oid_const;
+    Node *label_name_expr;
     Node *props;
-    List *label_name_args;
-    FuncExpr *label_name_func_expr;
     RowExpr *row_expr;
 
     Assert(pnsi != NULL);
 
     id = scanNSItemForColumn(pstate, pnsi, 0, AG_VERTEX_COLNAME_ID, -1);
 
-    label_name_func_oid = get_ag_func_oid("_label_name", 2, OIDOID,
-                                          GRAPHIDOID);
-
-    graph_oid_const = makeConst(OIDOID, -1, InvalidOid, sizeof(Oid),
-                                ObjectIdGetDatum(cpstate->graph_oid), false,
-                                true);
-
-    label_name_args = list_make2(graph_oid_const, id);
-
-    label_name_func_expr = makeFuncExpr(label_name_func_oid, AGTYPEOID,
-                                        label_name_args, InvalidOid,
-                                        InvalidOid, COERCE_EXPLICIT_CALL);
-    label_name_func_expr->location = -1;
+    label_name_expr = make_label_name_expr(cpstate, pnsi, id);
 
     props = scanNSItemForColumn(pstate, pnsi, 0, AG_VERTEX_COLNAME_PROPERTIES,
                                 -1);
@@ -6369,7 +7087,7 @@ static Node *make_vertex_expr(cypher_parsestate *cpstate,
      * Implicit cast to agtype is used when needed.
      */
     row_expr = makeNode(RowExpr);
-    row_expr->args = list_make3(id, label_name_func_expr, props);
+    row_expr->args = list_make3(id, label_name_expr, props);
     row_expr->row_typeid = VERTEXOID;
     row_expr->row_format = COERCE_EXPLICIT_CALL;
     row_expr->colnames = list_make3(makeString("id"),
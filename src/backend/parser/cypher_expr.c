@@ -691,7 +691,20 @@ static Node *transform_AEXPR_IN(cypher_parsestate *cpstate, A_Expr *a)
 
         allexprs = list_concat(list_make1(lexpr), rnonvars);
 
-        scalar_type = AGTYPEOID;
+        /*
+         * id(), start_id(), and end_id() of an entity are graphids. Keep them
+         * as they are and compare them with an array of graphids, which the
+         * planner folds into a constant that constraint exclusion can use to
+         * skip the tables of other labels.
+         */
+        if (exprType(lexpr) == GRAPHIDOID)
+        {
+            scalar_type = GRAPHIDOID;
+        }
+        else
+        {
+            scalar_type = AGTYPEOID;
+        }
 
         /* verify they are a common type */
         if (!verify_common_type(scalar_type, allexprs))
@@ -709,13 +722,13 @@ static Node *transform_AEXPR_IN(cypher_parsestate *cpstate, A_Expr *a)
         {
             Node *rexpr = (Node *) lfirst(l);
 
-            rexpr = coerce_to_common_type(pstate, rexpr, AGTYPEOID, "IN");
+            rexpr = coerce_to_common_type(pstate, rexpr, scalar_type, "IN");
             aexprs = lappend(aexprs, rexpr);
         }
         newa = makeNode(ArrayExpr);
-        newa->array_typeid = get_array_type(AGTYPEOID);
+        newa->array_typeid = get_array_type(scalar_type);
         /* array_collid will be set by parse_collate.c */
-        newa->element_typeid = AGTYPEOID;
+        newa->element_typeid = scalar_type;
         newa->elements = aexprs;
         newa->multidims = false;
         result = (Node *) make_scalar_array_op(pstate, a->name, useOr,
@@ -85,19 +85,19 @@
 /* keywords in alphabetical order */
 %token <keyword> ALL ANALYZE AND ANY_P AS ASC ASCENDING
                  BY
-                 CALL CASE COALESCE CONTAINS COUNT CREATE
-                 DELETE DESC DESCENDING DETACH DISTINCT
+                 CALL CASE COALESCE CONSTRAINT CONTAINS COUNT CREATE
+                 DELETE DESC DESCENDING DETACH DISTINCT DROP
                  ELSE END_P ENDS EXISTS EXPLAIN
-                 FALSE_P
-                 IN IS
+                 FALSE_P FOR
+                 IF_P IN INDEX IS
                  LIMIT
                  MATCH MERGE
                  NONE NOT NULL_P
                  ON OPERATOR OPTIONAL OR ORDER
-                 REMOVE RETURN
+                 REMOVE REQUIRE RETURN
                  SET SINGLE SKIP STARTS
                  THEN TRUE_P
-                 UNION UNWIND
+                 UNION UNIQUE UNWIND
                  VERBOSE
                  WHEN WHERE WITH
                  XOR
@@ -145,6 +145,12 @@
 %type <node> merge
 %type <merge_actions> merge_actions_opt merge_actions merge_action
 
+/* schema commands */
+%type <node> schema_command index_pattern
+%type <list> constraint_properties property_value_list
+%type <string> index_name_opt
+%type <boolean> if_not_exists_opt if_exists_opt
+
 /* CALL ... YIELD clause */
 %type <node> call_stmt yield_item
 %type <list> yield_item_list
@@ -178,6 +184,7 @@
 %type <string> property_key_name var_name var_name_alias var_name_opt label_name
 %type <string> symbolic_name schema_name type_name
 %type <keyword> reserved_keyword safe_keywords conflicted_keywords
+               unreserved_keyword
 %type <list> func_name
 
 /* types */
@@ -388,6 +395,151 @@ cypher_stmt:
         }
     ;
 
+/*
+ * schema commands
+ *
+ * They are parsed as updating clauses to share the prefix of CREATE with the
+ * CREATE clause. The transform makes sure that they stand alone.
+ */
+
+schema_command:
+    CREATE INDEX index_name_opt if_not_exists_opt FOR index_pattern
+    ON '(' expr_list ')'
+        {
+            cypher_create_index *n;
+
+            n = make_ag_node(cypher_create_index);
+            n->name = $3;
+            n->if_not_exists = $4;
+            n->entity = $6;
+            n->properties = $9;
+            n->unique = false;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    | CREATE CONSTRAINT index_name_opt if_not_exists_opt FOR index_pattern
+    REQUIRE constraint_properties IS UNIQUE
+        {
+            cypher_create_index *n;
+
+            n = make_ag_node(cypher_create_index);
+            n->name = $3;
+            n->if_not_exists = $4;
+            n->entity = $6;
+            n->properties = $8;
+            n->unique = true;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    | DROP INDEX symbolic_name if_exists_opt
+        {
+            cypher_drop_index *n;
+
+            n = make_ag_node(cypher_drop_index);
+            n->name = $3;
+            n->if_exists = $4;
+            n->unique = false;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    | DROP CONSTRAINT symbolic_name if_exists_opt
+        {
+            cypher_drop_index *n;
+
+            n = make_ag_node(cypher_drop_index);
+            n->name = $3;
+            n->if_exists = $4;
+            n->unique = true;
+            n->location = @1;
+
+            $$ = (Node *)n;
+        }
+    ;
+
+constraint_properties:
+    property_value
+        {
+            $$ = list_make1($1);
+        }
+    | '(' property_value_list ')'
+        {
+            $$ = $2;
+        }
+    ;
+
+property_value_list:
+    property_value
+        {
+            $$ = list_make1($1);
+        }
+    | property_value_list ',' property_value
+        {
+            $$ = lappend($1, $3);
+        }
+    ;
+
+/*
+ * An unnamed index is followed by IF or FOR, so the name cannot be one of the
+ * unreserved keywords.
+ */
+index_name_opt:
+    /* empty */
+        {
+            $$ = NULL;
+        }
+    | IDENTIFIER
+    ;
+
+if_not_exists_opt:
+    /* empty */
+        {
+            $$ = false;
+        }
+    | IF_P NOT EXISTS
+        {
+            $$ = true;
+        }
+    ;
+
+if_exists_opt:
+    /* empty */
+        {
+            $$ = false;
+        }
+    | IF_P EXISTS
+        {
+            $$ = true;
+        }
+    ;
+
+/*
+ * (n:Label) or ()-[r:Label]-() for the vertices or the edges of a label. The
+ * end vertices of the relationship form only mark it as such.
+ */
+index_pattern:
+    path_node
+    | path_node path_relationship path_node
+        {
+            cypher_node *start = (cypher_node *)$1;
+            cypher_node *end = (cypher_node *)$3;
+
+            if (start->name != NULL || start->label != NULL ||
+                start->props != NULL || end->name != NULL ||
+                end->label != NULL || end->props != NULL)
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_SYNTAX_ERROR),
+                         errmsg("the end vertices of the relationship must be empty"),
+                         ag_scanner_errposition(@1, scanner)));
+            }
+
+            $$ = $2;
+        }
+    ;
+
 call_stmt:
     CALL expr_func_norm
         {
@@ -606,6 +758,7 @@ updating_clause:
     | remove
     | delete
     | merge
+    | schema_command
     ;
 
 subquery_stmt:
@@ -2391,6 +2544,11 @@ type_name:
 
 symbolic_name:
     IDENTIFIER
+    | unreserved_keyword
+        {
+            /* we don't need to copy it, as it already has been */
+            $$ = (char *) $1;
+        }
     ;
 
 schema_name:
@@ -2540,6 +2698,21 @@ safe_keywords:
     | YIELD      { $$ = KEYWORD_STRDUP($1); }
     ;
 
+/*
+ * Keywords that were identifiers before the schema commands were added.
+ * They are accepted wherever a symbolic name is, so that queries using them
+ * as variable, label, or property names keep working.
+ */
+unreserved_keyword:
+    CONSTRAINT { $$ = KEYWORD_STRDUP($1); }
+    | DROP     { $$ = KEYWORD_STRDUP($1); }
+    | FOR      { $$ = KEYWORD_STRDUP($1); }
+    | IF_P     { $$ = KEYWORD_STRDUP($1); }
+    | INDEX    { $$ = KEYWORD_STRDUP($1); }
+    | REQUIRE  { $$ = KEYWORD_STRDUP($1); }
+    | UNIQUE   { $$ = KEYWORD_STRDUP($1); }
+    ;
+
 conflicted_keywords:
     END_P     { $$ = KEYWORD_STRDUP($1); }
     | FALSE_P { $$ = KEYWORD_STRDUP($1); }
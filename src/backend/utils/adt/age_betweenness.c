@@ -0,0 +1,415 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Betweenness centrality with Brandes' algorithm.
+ *
+ * Each source contributes one BFS over the CSR, followed by a pass over the
+ * BFS order in reverse that accumulates the pair dependencies. The BFS order
+ * array doubles as the queue and the stack, and the per-vertex arrays are
+ * reset through it, so a source that reaches k vertices costs O(k) plus its
+ * edges, not O(n).
+ *
+ * When a sample size is passed, only that many randomly chosen sources are
+ * used and the scores are scaled up by n / sample_size, which gives an
+ * unbiased estimate. With enough work, the sources are handed out to
+ * parallel workers through a shared counter. Every participant accumulates
+ * into its own score array in the DSM segment, and the leader sums them.
+ */
+
+#include "postgres.h"
+
+#include "access/parallel.h"
+#include "common/pg_prng.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "utils/builtins.h"
+
+#include "utils/age_graph_csr.h"
+
+/* shm_toc keys of the betweenness parallel DSM segment */
+#define BC_KEY_SHARED  UINT64CONST(0xA6E0000000000201)
+#define BC_KEY_SOURCES UINT64CONST(0xA6E0000000000202)
+#define BC_KEY_SCORES  UINT64CONST(0xA6E0000000000203)
+
+/*
+ * Below this many source times adjacency slot visits, the leader runs every
+ * source itself.
+ */
+#define BC_MIN_PARALLEL_WORK 10000000
+
+/* betweenness state shared by all participants */
+typedef struct BetweennessShared
+{
+    int32 num_sources;
+    int num_slots;                 /* score arrays, one per participant */
+    pg_atomic_uint32 next_source;
+    pg_atomic_uint32 next_slot;
+} BetweennessShared;
+
+/* per participant scratch space of the Brandes passes */
+typedef struct BrandesState
+{
+    GraphCSR *csr;
+    int32 *dist;       /* BFS distance, -1 when not reached */
+    float8 *sigma;     /* number of shortest paths from the source */
+    float8 *delta;     /* dependency of the source on the vertex */
+    int32 *order;      /* vertices in BFS order */
+} BrandesState;
+
+PGDLLEXPORT void age_betweenness_worker(dsm_segment *seg, shm_toc *toc);
+
+static void brandes_accumulate(BrandesState *bs, int32 source,
+                               float8 *scores);
+static void betweenness_participate(GraphCSR *csr, BetweennessShared *shared,
+                                    int32 *sources, float8 *scores);
+static float8 *run_betweenness(GraphCSR *csr, int32 *sources,
+                               int32 num_sources);
+
+/* runs one Brandes pass from source, adding the dependencies to scores */
+static void brandes_accumulate(BrandesState *bs, int32 source,
+                               float8 *scores)
+{
+    GraphCSR *csr = bs->csr;
+    int32 count = 1;
+    int32 head = 0;
+    int32 i;
+
+    bs->dist[source] = 0;
+    bs->sigma[source] = 1.0;
+    bs->order[0] = source;
+
+    while (head < count)
+    {
+        int32 v = bs->order[head++];
+        int64 slot;
+
+        for (slot = csr->offsets[v]; slot < csr->offsets[v + 1]; slot++)
+        {
+            int32 w = csr->targets[slot];
+
+            if (bs->dist[w] < 0)
+            {
+                bs->dist[w] = bs->dist[v] + 1;
+                bs->order[count++] = w;
+            }
+            if (bs->dist[w] == bs->dist[v] + 1)
+            {
+                bs->sigma[w] += bs->sigma[v];
+            }
+        }
+    }
+
+    /* accumulate the dependencies over the successors, farthest first */
+    for (i = count - 1; i >= 0; i--)
+    {
+        int32 w = bs->order[i];
+        int64 slot;
+
+        for (slot = csr->offsets[w]; slot < csr->offsets[w + 1]; slot++)
+        {
+            int32 x = csr->targets[slot];
+
+            if (bs->dist[x] == bs->dist[w] + 1)
+            {
+                bs->delta[w] += bs->sigma[w] / bs->sigma[x] *
+                                (1.0 + bs->delta[x]);
+            }
+        }
+
+        if (w != source)
+        {
+            scores[w] += bs->delta[w];
+        }
+    }
+
+    /* reset the vertices this source reached */
+    for (i = 0; i < count; i++)
+    {
+        int32 w = bs->order[i];
+
+        bs->dist[w] = -1;
+        bs->sigma[w] = 0.0;
+        bs->delta[w] = 0.0;
+    }
+}
+
+/*
+ * Claims sources from the shared counter until none are left, accumulating
+ * into this participant's own score array.
+ */
+static void betweenness_participate(GraphCSR *csr, BetweennessShared *shared,
+                                    int32 *sources, float8 *scores)
+{
+    BrandesState bs;
+    Size n = Max((Size) csr->num_vertices, 1);
+    uint32 slot;
+    uint32 i;
+    Size v;
+
+    slot = pg_atomic_fetch_add_u32(&shared->next_slot, 1);
+    if (slot >= (uint32) shared->num_slots)
+    {
+        elog(ERROR, "betweenness: no score array left for participant");
+    }
+    scores += slot * (Size) csr->num_vertices;
+
+    bs.csr = csr;
+    bs.dist = palloc_extended(sizeof(int32) * n, MCXT_ALLOC_HUGE);
+    bs.sigma = palloc_extended(sizeof(float8) * n,
+                               MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+    bs.delta = palloc_extended(sizeof(float8) * n,
+                               MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+    bs.order = palloc_extended(sizeof(int32) * n, MCXT_ALLOC_HUGE);
+    for (v = 0; v < n; v++)
+    {
+        bs.dist[v] = -1;
+    }
+
+    while ((i = pg_atomic_fetch_add_u32(&shared->next_source, 1)) <
+           (uint32) shared->num_sources)
+    {
+        brandes_accumulate(&bs, sources[i], scores);
+
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    pfree(bs.dist);
+    pfree(bs.sigma);
+    pfree(bs.delta);
+    pfree(bs.order);
+}
+
+/* entry point of the betweenness parallel workers */
+void age_betweenness_worker(dsm_segment *seg, shm_toc *toc)
+{
+    GraphCSR *csr = attach_graph_csr_dsm(toc);
+
+    betweenness_participate(csr, shm_toc_lookup(toc, BC_KEY_SHARED, false),
+                            shm_toc_lookup(toc, BC_KEY_SOURCES, false),
+                            shm_toc_lookup(toc, BC_KEY_SCORES, false));
+}
+
+/*
+ * Runs Brandes' algorithm from the passed sources and returns the summed,
+ * unscaled dependency of every vertex.
+ */
+static float8 *run_betweenness(GraphCSR *csr, int32 *sources,
+                               int32 num_sources)
+{
+    BetweennessShared local_shared;
+    BetweennessShared *shared = &local_shared;
+    ParallelContext *pcxt = NULL;
+    Size n = (Size) csr->num_vertices;
+    float8 *scores = NULL;
+    float8 *result = NULL;
+    int nworkers;
+    int s;
+    Size v;
+
+    nworkers = get_graph_algorithm_workers((int64) num_sources *
+                                           Max(csr->num_edges, 1),
+                                           BC_MIN_PARALLEL_WORK);
+
+    if (nworkers > 0)
+    {
+        Size scores_size = sizeof(float8) * n * (nworkers + 1);
+        int32 *shared_sources;
+
+        EnterParallelMode();
+        pcxt = CreateParallelContext("age", "age_betweenness_worker",
+                                     nworkers);
+
+        shm_toc_estimate_chunk(&pcxt->estimator, sizeof(BetweennessShared));
+        shm_toc_estimate_chunk(&pcxt->estimator,
+                               sizeof(int32) * (num_sources + 1));
+        shm_toc_estimate_chunk(&pcxt->estimator, scores_size);
+        shm_toc_estimate_keys(&pcxt->estimator, 3);
+        estimate_graph_csr_dsm(pcxt, csr);
+
+        InitializeParallelDSM(pcxt);
+        store_graph_csr_dsm(pcxt, csr);
+
+        shared = shm_toc_allocate(pcxt->toc, sizeof(BetweennessShared));
+        shared->num_slots = nworkers + 1;
+        shm_toc_insert(pcxt->toc, BC_KEY_SHARED, shared);
+
+        shared_sources = shm_toc_allocate(pcxt->toc,
+                                          sizeof(int32) * (num_sources + 1));
+        memcpy(shared_sources, sources, sizeof(int32) * num_sources);
+        shm_toc_insert(pcxt->toc, BC_KEY_SOURCES, shared_sources);
+
+        scores = shm_toc_allocate(pcxt->toc, scores_size);
+        memset(scores, 0, scores_size);
+        shm_toc_insert(pcxt->toc, BC_KEY_SCORES, scores);
+    }
+    else
+    {
+        shared->num_slots = 1;
+        scores = palloc_extended(sizeof(float8) * Max(n, 1),
+                                 MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+    }
+
+    shared->num_sources = num_sources;
+    pg_atomic_init_u32(&shared->next_source, 0);
+    pg_atomic_init_u32(&shared->next_slot, 0);
+
+    if (pcxt != NULL)
+    {
+        /* the leader takes sources as well, whether or not workers start */
+        LaunchParallelWorkers(pcxt);
+        betweenness_participate(csr, shared, sources, scores);
+        WaitForParallelWorkersToFinish(pcxt);
+
+        result = palloc_extended(sizeof(float8) * Max(n, 1),
+                                 MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+        for (s = 0; s < shared->num_slots; s++)
+        {
+            for (v = 0; v < n; v++)
+            {
+                result[v] += scores[s * n + v];
+            }
+        }
+
+        DestroyParallelContext(pcxt);
+        ExitParallelMode();
+    }
+    else
+    {
+        betweenness_participate(csr, shared, sources, scores);
+        result = scores;
+    }
+
+    return result;
+}
+
+PG_FUNCTION_INFO_V1(age_betweenness);
+
+/*
+ * age_betweenness(graph_name, edge_label, sample_size, seed, direction)
+ *
+ * Returns the betweenness centrality of every vertex: the number of
+ * shortest paths between other vertices that pass through it, with each
+ * pair's paths weighted by their share. Paths follow the out-edges by
+ * default; with direction 'both' the graph is undirected and every pair is
+ * counted once. Parallel edges and self loops do not change shortest paths
+ * and are ignored.
+ *
+ * sample_size limits the computation to that many random sources, chosen
+ * with seed, and scales the result to estimate the exact scores. NULL, or a
+ * sample at least as large as the graph, computes the exact scores.
+ */
+Datum age_betweenness(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    pg_prng_state prng;
+    int32 *sources = NULL;
+    float8 *scores = NULL;
+    float8 scale = 1.0;
+    int32 num_sources;
+    int direction;
+    int32 i;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("betweenness: graph name cannot be NULL")));
+    }
+    if (!PG_ARGISNULL(2) && PG_GETARG_INT32(2) < 1)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("betweenness: sample_size must be at least 1")));
+    }
+
+    direction = parse_csr_direction("betweenness",
+                                    PG_ARGISNULL(4) ? "out" :
+                                    text_to_cstring(PG_GETARG_TEXT_PP(4)));
+
+    csr = build_graph_csr_by_name("betweenness", NameStr(*PG_GETARG_NAME(0)),
+                                  get_name_arg_or_null(fcinfo, 1), direction,
+                                  false);
+    make_graph_csr_neighbor_sets(csr);
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    sources = palloc_extended(sizeof(int32) *
+                              ((Size) csr->num_vertices + 1),
+                              MCXT_ALLOC_HUGE);
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        sources[i] = i;
+    }
+    num_sources = csr->num_vertices;
+
+    /* pick the sample with a partial Fisher-Yates shuffle */
+    if (!PG_ARGISNULL(2) && PG_GETARG_INT32(2) < csr->num_vertices)
+    {
+        num_sources = PG_GETARG_INT32(2);
+
+        if (PG_ARGISNULL(3))
+        {
+            pg_prng_seed(&prng, pg_prng_uint64(&pg_global_prng_state));
+        }
+        else
+        {
+            pg_prng_seed(&prng, (uint64) PG_GETARG_INT64(3));
+        }
+
+        for (i = 0; i < num_sources; i++)
+        {
+            int32 j = (int32) pg_prng_uint64_range(&prng, i,
+                                                   csr->num_vertices - 1);
+            int32 tmp = sources[i];
+
+            sources[i] = sources[j];
+            sources[j] = tmp;
+        }
+
+        scale = (float8) csr->num_vertices / (float8) num_sources;
+    }
+
+    if (direction == CSR_DIRECTION_BOTH)
+    {
+        scale *= 0.5;
+    }
+
+    scores = run_betweenness(csr, sources, num_sources);
+
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        Datum values[2];
+        bool nulls[2] = {false, false};
+
+        values[0] = GRAPHID_GET_DATUM(csr->vertex_ids[i]);
+        values[1] = Float8GetDatum(scores[i] * scale);
+
+        tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+    }
+
+    pfree(scores);
+    pfree(sources);
+    free_graph_csr(csr);
+
+    PG_RETURN_NULL();
+}
@@ -0,0 +1,665 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Worst-case optimal join of cyclic MATCH patterns.
+ *
+ * Joining a cyclic pattern one edge at a time, the way the planner does,
+ * can build intermediate results much larger than the output: a triangle
+ * first enumerates every path of two edges. age_match_cycle binds the
+ * pattern's vertices one at a time instead, in the manner of a leapfrog
+ * triejoin. The candidates for a vertex are the intersection of the sorted
+ * CSR rows of its already bound neighbors in the pattern, found by
+ * leapfrogging a cursor per row, so a partial match is only extended when
+ * every pattern edge among its vertices can be bound. Once all vertices are
+ * bound, the edges between them are enumerated from the same rows.
+ *
+ * A cyclic MATCH pattern is joined with this function when
+ * age.enable_multiway_join is on (see transform_match_pattern). The
+ * function's result is equated with the ids of the pattern's entities and
+ * the pattern's own quals are kept, so it only needs to return every match
+ * once. It does not check property constraints or that the edges of a
+ * match are distinct.
+ */
+
+#include "postgres.h"
+
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "utils/builtins.h"
+
+#include "catalog/ag_graph.h"
+#include "catalog/ag_label.h"
+#include "commands/label_commands.h"
+#include "utils/ag_cache.h"
+#include "utils/age_graph_csr.h"
+
+/* the CSRs built for one call, one per edge label and direction */
+typedef struct cycle_csr
+{
+    Oid edge_label_table_oid;
+    int direction;
+    GraphCSR *csr;
+} cycle_csr;
+
+/*
+ * A pattern edge between the vertex being bound and the earlier bound
+ * vertex. The rows of csr are those of the earlier vertex.
+ */
+typedef struct cycle_constraint
+{
+    int32 vertex;
+    GraphCSR *csr;
+} cycle_constraint;
+
+/* a cursor over the sorted targets of one CSR row */
+typedef struct cycle_cursor
+{
+    int32 *targets;
+    int64 pos;
+    int64 end;
+} cycle_cursor;
+
+typedef struct cycle_match_state
+{
+    /* the pattern */
+    int32 num_vertices;
+    int32 num_edges;
+    int32 *vertex_label_ids;    /* INVALID_LABEL_ID for any vertex label */
+    int32 *edge_starts;
+    int32 *edge_ends;
+    GraphCSR **edge_csrs;       /* rows of start list end, per edge */
+
+    /* the vertices in bind order, and what to intersect for each */
+    int32 *order;
+    int32 *constraint_starts;   /* num_vertices + 1 offsets */
+    cycle_constraint *constraints;
+    cycle_cursor *cursors;      /* one per constraint */
+
+    /* the match being built */
+    int32 *bindings;            /* vertex ordinal per pattern vertex */
+    graphid *edge_ids;          /* edge per pattern edge */
+
+    /* the graph */
+    GRAPH_global_context *ggctx;
+    int32 num_graph_vertices;
+    graphid *vertex_ids;        /* ordinal -> vertex graphid */
+    cycle_csr *csrs;
+    int num_csrs;
+
+    Tuplestorestate *tuple_store;
+    TupleDesc tupdesc;
+    MemoryContext tuple_context;
+} cycle_match_state;
+
+static GraphCSR *get_cycle_csr(cycle_match_state *state,
+                               Oid edge_label_table_oid, int direction);
+static void order_pattern_vertices(cycle_match_state *state,
+                                   bool *edge_directed,
+                                   Oid *edge_label_table_oids);
+static void seek_cursor(cycle_cursor *cursor, int32 value);
+static int32 leapfrog_next(cycle_cursor *cursors, int num_cursors);
+static void bind_vertex(cycle_match_state *state, int32 depth);
+static void try_vertex(cycle_match_state *state, int32 depth, int32 ordinal);
+static void bind_edge(cycle_match_state *state, int32 edge);
+static void emit_match(cycle_match_state *state);
+
+/*
+ * Returns the CSR of the edge label and direction, building and sorting it
+ * on first use. Self loops are kept, since two pattern vertices may be
+ * bound to the same graph vertex.
+ */
+static GraphCSR *get_cycle_csr(cycle_match_state *state,
+                               Oid edge_label_table_oid, int direction)
+{
+    GraphCSR *csr;
+    int i;
+
+    for (i = 0; i < state->num_csrs; i++)
+    {
+        if (state->csrs[i].edge_label_table_oid == edge_label_table_oid &&
+            state->csrs[i].direction == direction)
+        {
+            return state->csrs[i].csr;
+        }
+    }
+
+    csr = build_graph_csr(state->ggctx, direction, edge_label_table_oid,
+                          true);
+    sort_graph_csr_rows(csr);
+
+    state->csrs[state->num_csrs].edge_label_table_oid = edge_label_table_oid;
+    state->csrs[state->num_csrs].direction = direction;
+    state->csrs[state->num_csrs].csr = csr;
+    state->num_csrs++;
+
+    return csr;
+}
+
+/*
+ * Picks the bind order of the pattern vertices and the constraints of each.
+ * The first vertex is the one with the most pattern edges. Every following
+ * one is the vertex with the most edges to those already ordered, so its
+ * candidates are intersected from as many rows as possible. A vertex with
+ * none starts another connected component and is scanned in full.
+ */
+static void order_pattern_vertices(cycle_match_state *state,
+                                   bool *edge_directed,
+                                   Oid *edge_label_table_oids)
+{
+    int32 num_vertices = state->num_vertices;
+    int32 num_edges = state->num_edges;
+    int32 *degrees = palloc0(sizeof(int32) * num_vertices);
+    int32 *positions = palloc(sizeof(int32) * num_vertices);
+    int32 num_constraints = 0;
+    int32 depth;
+    int32 e;
+    int32 v;
+
+    for (v = 0; v < num_vertices; v++)
+    {
+        positions[v] = -1;
+    }
+
+    for (e = 0; e < num_edges; e++)
+    {
+        if (state->edge_starts[e] != state->edge_ends[e])
+        {
+            degrees[state->edge_starts[e]]++;
+            degrees[state->edge_ends[e]]++;
+        }
+    }
+
+    state->order = palloc(sizeof(int32) * num_vertices);
+    state->constraint_starts = palloc(sizeof(int32) * (num_vertices + 1));
+    state->constraints = palloc(sizeof(cycle_constraint) * (num_edges + 1));
+    state->cursors = palloc(sizeof(cycle_cursor) * (num_edges + 1));
+
+    for (depth = 0; depth < num_vertices; depth++)
+    {
+        int32 best = -1;
+        int32 best_links = -1;
+
+        for (v = 0; v < num_vertices; v++)
+        {
+            int32 links = 0;
+
+            if (positions[v] >= 0)
+            {
+                continue;
+            }
+
+            for (e = 0; e < num_edges; e++)
+            {
+                int32 start = state->edge_starts[e];
+                int32 end = state->edge_ends[e];
+
+                if ((start == v && end != v && positions[end] >= 0) ||
+                    (end == v && start != v && positions[start] >= 0))
+                {
+                    links++;
+                }
+            }
+
+            if (links > best_links ||
+                (links == best_links && degrees[v] > degrees[best]))
+            {
+                best = v;
+                best_links = links;
+            }
+        }
+
+        state->order[depth] = best;
+        state->constraint_starts[depth] = num_constraints;
+
+        /* the rows of the earlier vertex list the candidates for this one */
+        for (e = 0; e < num_edges; e++)
+        {
+            int32 start = state->edge_starts[e];
+            int32 end = state->edge_ends[e];
+            cycle_constraint *constraint;
+            int direction;
+
+            if (start == best && end != best && positions[end] >= 0)
+            {
+                direction = edge_directed[e] ? CSR_DIRECTION_IN :
+                                               CSR_DIRECTION_BOTH;
+                v = end;
+            }
+            else if (end == best && start != best && positions[start] >= 0)
+            {
+                direction = edge_directed[e] ? CSR_DIRECTION_OUT :
+                                               CSR_DIRECTION_BOTH;
+                v = start;
+            }
+            else
+            {
+                continue;
+            }
+
+            constraint = &state->constraints[num_constraints++];
+            constraint->vertex = v;
+            constraint->csr = get_cycle_csr(state, edge_label_table_oids[e],
+                                            direction);
+        }
+
+        positions[best] = depth;
+    }
+    state->constraint_starts[num_vertices] = num_constraints;
+
+    pfree(degrees);
+    pfree(positions);
+}
+
+/* moves the cursor to its first target that is not less than value */
+static void seek_cursor(cycle_cursor *cursor, int32 value)
+{
+    int64 low = cursor->pos;
+    int64 high;
+    int64 step = 1;
+
+    if (low >= cursor->end || cursor->targets[low] >= value)
+    {
+        return;
+    }
+
+    /* gallop ahead, since the cursor usually moves a short way */
+    high = low + 1;
+    while (high < cursor->end && cursor->targets[high] < value)
+    {
+        low = high;
+        step *= 2;
+        high = low + step;
+    }
+    high = Min(high, cursor->end);
+
+    /* targets[low] < value, and targets[high] >= value unless at the end */
+    while (high - low > 1)
+    {
+        int64 mid = low + (high - low) / 2;
+
+        if (cursor->targets[mid] < value)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    cursor->pos = high;
+}
+
+/*
+ * Leapfrogs the cursors to the next target that all of them share, and
+ * returns it, or -1 once one of them runs out. Each cursor in turn seeks the
+ * largest target seen so far, until num_cursors of them agree on it. The
+ * caller moves past the returned target by seeking the first cursor.
+ */
+static int32 leapfrog_next(cycle_cursor *cursors, int num_cursors)
+{
+    int32 value;
+    int matched = 1;
+    int i = 0;
+
+    if (cursors[0].pos >= cursors[0].end)
+    {
+        return -1;
+    }
+    value = cursors[0].targets[cursors[0].pos];
+
+    while (matched < num_cursors)
+    {
+        cycle_cursor *cursor;
+
+        i = (i + 1) % num_cursors;
+        cursor = &cursors[i];
+
+        seek_cursor(cursor, value);
+        if (cursor->pos >= cursor->end)
+        {
+            return -1;
+        }
+
+        if (cursor->targets[cursor->pos] == value)
+        {
+            matched++;
+        }
+        else
+        {
+            value = cursor->targets[cursor->pos];
+            matched = 1;
+        }
+    }
+
+    return value;
+}
+
+/* binds the vertex at depth of the bind order to each of its candidates */
+static void bind_vertex(cycle_match_state *state, int32 depth)
+{
+    int32 first;
+    int32 num_constraints;
+    int32 ordinal;
+    int32 i;
+
+    if (depth == state->num_vertices)
+    {
+        bind_edge(state, 0);
+        return;
+    }
+
+    CHECK_FOR_INTERRUPTS();
+
+    first = state->constraint_starts[depth];
+    num_constraints = state->constraint_starts[depth + 1] - first;
+
+    if (num_constraints == 0)
+    {
+        for (ordinal = 0; ordinal < state->num_graph_vertices; ordinal++)
+        {
+            try_vertex(state, depth, ordinal);
+        }
+        return;
+    }
+
+    /* each depth has its own cursors, so deeper ones do not disturb them */
+    for (i = 0; i < num_constraints; i++)
+    {
+        cycle_constraint *constraint = &state->constraints[first + i];
+        cycle_cursor *cursor = &state->cursors[first + i];
+        int32 bound = state->bindings[constraint->vertex];
+
+        cursor->targets = constraint->csr->targets;
+        cursor->pos = constraint->csr->offsets[bound];
+        cursor->end = constraint->csr->offsets[bound + 1];
+    }
+
+    while ((ordinal = leapfrog_next(&state->cursors[first],
+                                    num_constraints)) >= 0)
+    {
+        try_vertex(state, depth, ordinal);
+        seek_cursor(&state->cursors[first], ordinal + 1);
+    }
+}
+
+/*
+ * Binds the vertex at depth to the graph vertex, if its label matches and
+ * it has the self loops the pattern asks for, and moves on to the next one.
+ */
+static void try_vertex(cycle_match_state *state, int32 depth, int32 ordinal)
+{
+    int32 v = state->order[depth];
+    int32 label_id = state->vertex_label_ids[v];
+    int32 e;
+
+    if (label_id != INVALID_LABEL_ID &&
+        get_graphid_label_id(state->vertex_ids[ordinal]) != label_id)
+    {
+        return;
+    }
+
+    for (e = 0; e < state->num_edges; e++)
+    {
+        if (state->edge_starts[e] == v && state->edge_ends[e] == v &&
+            !graph_csr_has_neighbor(state->edge_csrs[e], ordinal, ordinal))
+        {
+            return;
+        }
+    }
+
+    state->bindings[v] = ordinal;
+    bind_vertex(state, depth + 1);
+}
+
+/* binds the pattern edge to each graph edge between its bound endpoints */
+static void bind_edge(cycle_match_state *state, int32 edge)
+{
+    GraphCSR *csr;
+    int32 start;
+    int32 end;
+    int64 low;
+    int64 high;
+
+    if (edge == state->num_edges)
+    {
+        emit_match(state);
+        return;
+    }
+
+    csr = state->edge_csrs[edge];
+    start = state->bindings[state->edge_starts[edge]];
+    end = state->bindings[state->edge_ends[edge]];
+
+    /* find the first slot of the row of start that targets end */
+    low = csr->offsets[start];
+    high = csr->offsets[start + 1];
+    while (low < high)
+    {
+        int64 mid = low + (high - low) / 2;
+
+        if (csr->targets[mid] < end)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    for (; low < csr->offsets[start + 1] && csr->targets[low] == end; low++)
+    {
+        state->edge_ids[edge] = csr->edge_ids[low];
+        bind_edge(state, edge + 1);
+    }
+}
+
+/* adds the bound vertices and edges to the result */
+static void emit_match(cycle_match_state *state)
+{
+    MemoryContext oldctx;
+    graphid *vertex_ids;
+    Datum values[2];
+    bool nulls[2] = {false, false};
+    int32 v;
+
+    oldctx = MemoryContextSwitchTo(state->tuple_context);
+
+    vertex_ids = palloc(sizeof(graphid) * state->num_vertices);
+    for (v = 0; v < state->num_vertices; v++)
+    {
+        vertex_ids[v] = state->vertex_ids[state->bindings[v]];
+    }
+
+    values[0] = PointerGetDatum(make_graphid_array(vertex_ids,
+                                                   state->num_vertices));
+    values[1] = PointerGetDatum(make_graphid_array(state->edge_ids,
+                                                   state->num_edges));
+
+    tuplestore_putvalues(state->tuple_store, state->tupdesc, values, nulls);
+
+    MemoryContextSwitchTo(oldctx);
+    MemoryContextReset(state->tuple_context);
+}
+
+/*
+ * age_match_cycle(graph_name, vertex_labels, edge_labels, edge_starts,
+ *                 edge_ends, edge_directed)
+ *
+ * Returns the matches of a pattern of vertices and edges in the graph. The
+ * pattern vertices are numbered by their position in vertex_labels, and
+ * pattern edge i goes from vertex edge_starts[i] to vertex edge_ends[i],
+ * either way when edge_directed[i] is false. The default vertex and edge
+ * labels match any label. Each match is returned as the ids of its vertices
+ * and of its edges, in pattern order. Different pattern vertices may be
+ * bound to the same graph vertex.
+ */
+PG_FUNCTION_INFO_V1(age_match_cycle);
+
+Datum age_match_cycle(PG_FUNCTION_ARGS)
+{
+    cycle_match_state state;
+    char *graph_name = NameStr(*PG_GETARG_NAME(0));
+    ArrayType *vertex_labels = PG_GETARG_ARRAYTYPE_P(1);
+    ArrayType *edge_labels = PG_GETARG_ARRAYTYPE_P(2);
+    ArrayType *edge_starts = PG_GETARG_ARRAYTYPE_P(3);
+    ArrayType *edge_ends = PG_GETARG_ARRAYTYPE_P(4);
+    ArrayType *edge_directed = PG_GETARG_ARRAYTYPE_P(5);
+    Datum *vertex_label_names;
+    Datum *edge_label_names;
+    Datum *start_values;
+    Datum *end_values;
+    Datum *directed_values;
+    bool *directed;
+    Oid *edge_label_table_oids;
+    Oid graph_oid;
+    int num_vertices;
+    int num_edges;
+    int nelems;
+    int i;
+
+    memset(&state, 0, sizeof(state));
+
+    state.ggctx = get_graph_context_by_name("match_cycle", graph_name);
+    graph_oid = get_graph_oid(graph_name);
+
+    deconstruct_array(vertex_labels, TEXTOID, -1, false, TYPALIGN_INT,
+                      &vertex_label_names, NULL, &num_vertices);
+    deconstruct_array(edge_labels, TEXTOID, -1, false, TYPALIGN_INT,
+                      &edge_label_names, NULL, &num_edges);
+    deconstruct_array(edge_starts, INT4OID, 4, true, TYPALIGN_INT,
+                      &start_values, NULL, &nelems);
+    if (nelems == num_edges)
+    {
+        deconstruct_array(edge_ends, INT4OID, 4, true, TYPALIGN_INT,
+                          &end_values, NULL, &nelems);
+    }
+    if (nelems == num_edges)
+    {
+        deconstruct_array(edge_directed, BOOLOID, 1, true, TYPALIGN_CHAR,
+                          &directed_values, NULL, &nelems);
+    }
+    if (nelems != num_edges)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+                 errmsg("match_cycle: the edge arrays must have the same length")));
+    }
+
+    if (num_vertices == 0)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("match_cycle: the pattern must have a vertex")));
+    }
+
+    state.num_vertices = num_vertices;
+    state.num_edges = num_edges;
+    state.vertex_label_ids = palloc(sizeof(int32) * num_vertices);
+    state.edge_starts = palloc(sizeof(int32) * (num_edges + 1));
+    state.edge_ends = palloc(sizeof(int32) * (num_edges + 1));
+    state.edge_csrs = palloc(sizeof(GraphCSR *) * (num_edges + 1));
+    directed = palloc(sizeof(bool) * (num_edges + 1));
+    edge_label_table_oids = palloc(sizeof(Oid) * (num_edges + 1));
+
+    for (i = 0; i < num_vertices; i++)
+    {
+        char *label_name = TextDatumGetCString(vertex_label_names[i]);
+        label_cache_data *lcd;
+
+        if (strcmp(label_name, AG_DEFAULT_LABEL_VERTEX) == 0)
+        {
+            state.vertex_label_ids[i] = INVALID_LABEL_ID;
+            continue;
+        }
+
+        lcd = search_label_name_graph_cache(label_name, graph_oid);
+        if (lcd == NULL || lcd->kind != LABEL_KIND_VERTEX)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("match_cycle: \"%s\" is not a vertex label",
+                            label_name)));
+        }
+        state.vertex_label_ids[i] = lcd->id;
+    }
+
+    for (i = 0; i < num_edges; i++)
+    {
+        char *label_name = TextDatumGetCString(edge_label_names[i]);
+
+        state.edge_starts[i] = DatumGetInt32(start_values[i]);
+        state.edge_ends[i] = DatumGetInt32(end_values[i]);
+        directed[i] = DatumGetBool(directed_values[i]);
+
+        if (state.edge_starts[i] < 0 || state.edge_starts[i] >= num_vertices ||
+            state.edge_ends[i] < 0 || state.edge_ends[i] >= num_vertices)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("match_cycle: edge %d has no such vertex", i)));
+        }
+
+        edge_label_table_oids[i] =
+            (strcmp(label_name, AG_DEFAULT_LABEL_EDGE) == 0) ?
+                InvalidOid :
+                get_edge_label_table_oid_by_name("match_cycle", graph_oid,
+                                                 label_name);
+    }
+
+    /* a CSR per edge for the edge lists, plus at most one per constraint */
+    state.csrs = palloc(sizeof(cycle_csr) * (num_edges * 2 + 1));
+    for (i = 0; i < num_edges; i++)
+    {
+        state.edge_csrs[i] = get_cycle_csr(&state, edge_label_table_oids[i],
+                                           directed[i] ? CSR_DIRECTION_OUT :
+                                                         CSR_DIRECTION_BOTH);
+    }
+
+    order_pattern_vertices(&state, directed, edge_label_table_oids);
+
+    state.num_graph_vertices =
+        (int32) get_graph_num_loaded_vertices(state.ggctx);
+    if (state.num_csrs > 0)
+    {
+        state.vertex_ids = state.csrs[0].csr->vertex_ids;
+    }
+    else
+    {
+        /* a pattern without edges still needs the vertex ordinals */
+        state.vertex_ids = build_graph_csr(state.ggctx, CSR_DIRECTION_OUT,
+                                           InvalidOid, false)->vertex_ids;
+    }
+
+    state.bindings = palloc(sizeof(int32) * num_vertices);
+    state.edge_ids = palloc(sizeof(graphid) * (num_edges + 1));
+
+    state.tuple_store = begin_graph_algorithm_srf(fcinfo, &state.tupdesc);
+    state.tuple_context = AllocSetContextCreate(CurrentMemoryContext,
+                                                "age_match_cycle tuples",
+                                                ALLOCSET_SMALL_SIZES);
+
+    bind_vertex(&state, 0);
+
+    MemoryContextDelete(state.tuple_context);
+
+    PG_RETURN_NULL();
+}
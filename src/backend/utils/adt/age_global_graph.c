@@ -20,6 +20,7 @@
 #include "postgres.h"
 
 #include "access/heapam.h"
+#include "access/xact.h"
 #include "catalog/namespace.h"
 #include "commands/trigger.h"
 #include "common/hashfn.h"
@@ -98,6 +99,22 @@ static VersionMode version_mode = VERSION_MODE_UNKNOWN;
 /* For PG < 17 shmem path */
 static GraphVersionState *shmem_version_state = NULL;
 
+/*
+ * A graph that the current transaction has written to. Its version counter
+ * is incremented once more when the transaction ends. See
+ * increment_graph_version().
+ */
+typedef struct pending_graph_version
+{
+    Oid graph_oid;
+    /* incremented since this backend last read the graph's version */
+    bool incremented;
+} pending_graph_version;
+
+/* list of pending_graph_version, allocated in TopTransactionContext */
+static List *pending_graph_versions = NIL;
+static bool graph_version_callbacks_registered = false;
+
 /* internal data structures implementation */
 
 /* vertex entry for the vertex_hashtable */
@@ -109,6 +126,7 @@ typedef struct vertex_entry
     VertexEdgeArray edges_self;    /* self-loop edge graphids (flat array) */
     Oid vertex_label_table_oid;    /* the label table oid */
     ItemPointerData tid;           /* physical tuple location for lazy fetch */
+    int32 ordinal;                 /* dense load order, 0..num_vertices - 1 */
 } vertex_entry;
 
 /*
@@ -146,6 +164,7 @@ typedef struct GRAPH_global_context
     TransactionId xmin;            /* snapshot fallback: transaction xmin */
     TransactionId xmax;            /* snapshot fallback: transaction xmax */
     CommandId curcid;              /* snapshot fallback: command id */
+    uint32 xcnt;                   /* running transactions of the snapshot */
     int64 num_loaded_vertices;     /* number of loaded vertices in this graph */
     int64 num_loaded_edges;        /* number of loaded edges in this graph */
     ListGraphId *vertices;         /* vertices for vertex hashtable cleanup */
@@ -230,6 +249,13 @@ static bool insert_vertex_edge(GRAPH_global_context *ggctx,
 static bool insert_vertex_entry(GRAPH_global_context *ggctx, graphid vertex_id,
                                 Oid vertex_label_table_oid,
                                 ItemPointerData tid);
+static void add_to_graph_version(GraphVersionState *state, Oid graph_oid);
+static pending_graph_version *get_pending_graph_version(Oid graph_oid);
+static void graph_version_xact_callback(XactEvent event, void *arg);
+static void graph_version_subxact_callback(SubXactEvent event,
+                                           SubTransactionId mySubid,
+                                           SubTransactionId parentSubid,
+                                           void *arg);
 /* definitions */
 
 /*
@@ -276,6 +302,30 @@ bool is_ggctx_invalid(GRAPH_global_context *ggctx)
                 ggctx->curcid != snap->curcid);
     }
 }
+
+/*
+ * Whether the context has every vertex and edge that the snapshot sees, which
+ * is stricter than it being valid: the graph has not changed since the
+ * context was loaded, and no transaction has completed since then either.
+ * The version counter is incremented again when a transaction that wrote to
+ * the graph ends, but a prepared transaction may be committed without that.
+ *
+ * An xid assigned after a snapshot is taken is not below its xmax, and xmax
+ * only moves when a transaction completes. So, of the transactions running
+ * below the same xmax at two snapshots, the later one's can only have lost
+ * some; if it has as many, none has completed.
+ */
+bool is_ggctx_current(GRAPH_global_context *ggctx, Snapshot snapshot)
+{
+    if (is_ggctx_invalid(ggctx))
+    {
+        return false;
+    }
+
+    return (ggctx->xmin == snapshot->xmin &&
+            ggctx->xmax == snapshot->xmax &&
+            ggctx->xcnt == snapshot->xcnt);
+}
 /*
  * Fast hash function for graphid (int64) keys.
  *
@@ -623,6 +673,19 @@ static bool insert_vertex_entry(GRAPH_global_context *ggctx, graphid vertex_id,
     ve->vertex_label_table_oid = vertex_label_table_oid;
     /* set the TID for lazy property fetch */
     ve->tid = tid;
+    /*
+     * The dense ordinal is the load order of the vertex. It matches the
+     * position of the vertex in ggctx->vertices and lets the graph
+     * algorithms index flat arrays instead of hashing graphids.
+     */
+    if (ggctx->num_loaded_vertices >= PG_INT32_MAX)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+                 errmsg("too many vertices in graph \"%s\"",
+                        ggctx->graph_name)));
+    }
+    ve->ordinal = (int32) ggctx->num_loaded_vertices;
     /*
      * MemSet above already zeroed the embedded VertexEdgeArray fields
      * (array=NULL, size=0, capacity=0); no explicit NIL assignment needed.
@@ -1144,10 +1207,21 @@ GRAPH_global_context *manage_GRAPH_global_contexts(char *graph_name,
     /* set the graph version counter for cache invalidation */
     new_ggctx->graph_version = get_graph_version(graph_oid);
 
+    /* the next write of this transaction must invalidate the context */
+    {
+        pending_graph_version *pending = get_pending_graph_version(graph_oid);
+
+        if (pending != NULL)
+        {
+            pending->incremented = false;
+        }
+    }
+
     /* set snapshot fields for SNAPSHOT fallback mode */
     new_ggctx->xmin = GetActiveSnapshot()->xmin;
     new_ggctx->xmax = GetActiveSnapshot()->xmax;
     new_ggctx->curcid = GetActiveSnapshot()->curcid;
+    new_ggctx->xcnt = GetActiveSnapshot()->xcnt;
 
     /* initialize our vertices list */
     new_ggctx->vertices = NULL;
@@ -1381,6 +1455,22 @@ ListGraphId *get_graph_vertices(GRAPH_global_context *ggctx)
     return ggctx->vertices;
 }
 
+/* graph statistics accessors */
+int64 get_graph_num_loaded_vertices(GRAPH_global_context *ggctx)
+{
+    return ggctx->num_loaded_vertices;
+}
+
+int64 get_graph_num_loaded_edges(GRAPH_global_context *ggctx)
+{
+    return ggctx->num_loaded_edges;
+}
+
+Oid get_graph_context_oid(GRAPH_global_context *ggctx)
+{
+    return ggctx->graph_oid;
+}
+
 /* vertex_entry accessor functions */
 graphid get_vertex_entry_id(vertex_entry *ve)
 {
@@ -1408,6 +1498,11 @@ Oid get_vertex_entry_label_table_oid(vertex_entry *ve)
     return ve->vertex_label_table_oid;
 }
 
+int32 get_vertex_entry_ordinal(vertex_entry *ve)
+{
+    return ve->ordinal;
+}
+
 /*
  * Fetch vertex properties on demand from the heap via stored TID.
  *
@@ -1482,6 +1577,11 @@ Oid get_edge_entry_label_table_oid(edge_entry *ee)
     return ee->edge_label_table_oid;
 }
 
+ItemPointer get_edge_entry_tid(edge_entry *ee)
+{
+    return &ee->tid;
+}
+
 /*
  * Fetch edge properties on demand from the heap via stored TID.
  * See get_vertex_entry_properties for memory and safety notes.
@@ -1934,18 +2034,145 @@ uint64 get_graph_version(Oid graph_oid)
 /*
  * Increment the version counter for a graph.
  * Called after any graph mutation (Cypher or SQL trigger).
- * Lock-free for existing entries; acquires LWLock only to allocate new slots.
+ *
+ * The counter is incremented by the first write of a transaction to the
+ * graph, and by the next one after this backend has read the counter again
+ * to load a context. The other writes can be skipped: no context of this
+ * backend was loaded since the last increment, and the other backends cannot
+ * see the changes yet. Instead, the counter is incremented once more when the
+ * transaction ends, after its changes have become visible or have been rolled
+ * back. Otherwise, a context loaded by another backend before the commit would
+ * remain valid without the changes.
  */
 void increment_graph_version(Oid graph_oid)
 {
     GraphVersionState *state = get_version_state();
-    int i;
+    pending_graph_version *pending;
 
     if (state == NULL)
     {
         return;
     }
 
+    pending = get_pending_graph_version(graph_oid);
+    if (pending != NULL && pending->incremented)
+    {
+        return;
+    }
+
+    if (pending == NULL)
+    {
+        MemoryContext oldctx;
+
+        if (!graph_version_callbacks_registered)
+        {
+            RegisterXactCallback(graph_version_xact_callback, NULL);
+            RegisterSubXactCallback(graph_version_subxact_callback, NULL);
+            graph_version_callbacks_registered = true;
+        }
+
+        oldctx = MemoryContextSwitchTo(TopTransactionContext);
+        pending = palloc(sizeof(pending_graph_version));
+        pending->graph_oid = graph_oid;
+        pending_graph_versions = lappend(pending_graph_versions, pending);
+        MemoryContextSwitchTo(oldctx);
+    }
+
+    add_to_graph_version(state, graph_oid);
+    pending->incremented = true;
+}
+
+/* the graph's entry in pending_graph_versions, NULL if it has none */
+static pending_graph_version *get_pending_graph_version(Oid graph_oid)
+{
+    ListCell *lc;
+
+    foreach(lc, pending_graph_versions)
+    {
+        pending_graph_version *pending = lfirst(lc);
+
+        if (pending->graph_oid == graph_oid)
+        {
+            return pending;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Increment the graphs written to by the transaction when it ends. A prepared
+ * transaction is committed later, maybe by another backend; its graphs are
+ * incremented when it is prepared, which is the best that can be done.
+ */
+static void graph_version_xact_callback(XactEvent event, void *arg)
+{
+    GraphVersionState *state;
+    ListCell *lc;
+
+    if (pending_graph_versions == NIL ||
+        (event != XACT_EVENT_COMMIT && event != XACT_EVENT_PARALLEL_COMMIT &&
+         event != XACT_EVENT_ABORT && event != XACT_EVENT_PARALLEL_ABORT &&
+         event != XACT_EVENT_PREPARE))
+    {
+        return;
+    }
+
+    state = get_version_state();
+
+    foreach(lc, pending_graph_versions)
+    {
+        pending_graph_version *pending = lfirst(lc);
+
+        if (state != NULL)
+        {
+            add_to_graph_version(state, pending->graph_oid);
+        }
+    }
+
+    /* the list goes away with TopTransactionContext */
+    pending_graph_versions = NIL;
+}
+
+/*
+ * A context loaded after a write that is rolled back to a savepoint has the
+ * rolled back changes, so the graphs written to must be incremented again.
+ */
+static void graph_version_subxact_callback(SubXactEvent event,
+                                           SubTransactionId mySubid,
+                                           SubTransactionId parentSubid,
+                                           void *arg)
+{
+    GraphVersionState *state;
+    ListCell *lc;
+
+    if (event != SUBXACT_EVENT_ABORT_SUB || pending_graph_versions == NIL)
+    {
+        return;
+    }
+
+    state = get_version_state();
+
+    foreach(lc, pending_graph_versions)
+    {
+        pending_graph_version *pending = lfirst(lc);
+
+        if (state != NULL)
+        {
+            add_to_graph_version(state, pending->graph_oid);
+        }
+        pending->incremented = true;
+    }
+}
+
+/*
+ * Increment the version counter of the graph in the shared state.
+ * Lock-free for existing entries; acquires LWLock only to allocate new slots.
+ */
+static void add_to_graph_version(GraphVersionState *state, Oid graph_oid)
+{
+    int i;
+
     /* try to find existing entry (lock-free) */
     for (i = 0; i < state->num_entries; i++)
     {
@@ -0,0 +1,1714 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Whole graph algorithms over the GRAPH global context.
+ *
+ * These are SQL-facing set returning functions. Each one resolves the graph
+ * (and optional edge label) into a GraphCSR, runs over the dense vertex
+ * ordinals, and materializes its result into a tuplestore. The functions
+ * that build a GraphCSR also accept the name of a projection made with
+ * age_project_graph in place of a graph name.
+ */
+
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "common/pg_prng.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include <math.h>
+#include "utils/builtins.h"
+#include "utils/hsearch.h"
+
+#include "catalog/ag_graph.h"
+#include "utils/age_graph_csr.h"
+
+/* neighborhood similarity metrics */
+typedef enum similarity_metric
+{
+    SIMILARITY_JACCARD,
+    SIMILARITY_OVERLAP,
+    SIMILARITY_ADAMIC_ADAR,
+    SIMILARITY_COMMON_NEIGHBORS
+} similarity_metric;
+
+/*
+ * Forward push state of a vertex touched by personalized PageRank. Entries
+ * live in a dynahash table keyed by vertex graphid, which never moves them,
+ * so the push queue can point at them directly.
+ */
+typedef struct ppr_entry
+{
+    graphid vertex_id;      /* hash key */
+    float8 estimate;        /* settled PageRank mass */
+    float8 residual;        /* mass that still has to be pushed */
+    graphid *neighbors;     /* out-neighbors, resolved on first use */
+    int32 degree;           /* number of neighbors, -1 until resolved */
+    bool queued;            /* in the push queue */
+} ppr_entry;
+
+/* FIFO ring buffer of the vertices whose residual exceeds the threshold */
+typedef struct ppr_queue
+{
+    ppr_entry **items;
+    int64 head;
+    int64 count;
+    int64 capacity;
+} ppr_queue;
+
+/* personalized PageRank forward push state */
+typedef struct ppr_context
+{
+    GRAPH_global_context *ggctx;
+    Oid edge_label_table_oid;
+    HTAB *entries;
+    ppr_queue queue;
+    float8 epsilon;
+    ppr_entry **seeds;
+    int num_seeds;
+} ppr_context;
+
+/* a scored vertex ordinal, used for top-k selection */
+typedef struct scored_vertex
+{
+    int32 ordinal;
+    float8 score;
+} scored_vertex;
+
+static int32 *get_start_ordinals(GraphCSR *csr, FunctionCallInfo fcinfo,
+                                 int argno, int32 *num_starts);
+static int32 next_walk_vertex(GraphCSR *csr, int32 prev, int32 curr,
+                              float8 inv_p, float8 inv_q, float8 max_weight,
+                              bool biased, pg_prng_state *prng);
+static similarity_metric parse_similarity_metric(const char *funcname,
+                                                 const char *metric);
+static float8 similarity_score(similarity_metric metric, int64 common,
+                               float8 adamic_adar, int64 size_a,
+                               int64 size_b);
+static int compare_scored_vertices(const void *a, const void *b);
+static int compare_graphids(const void *a, const void *b);
+static graphid *get_neighbor_set(GRAPH_global_context *ggctx,
+                                 graphid vertex_id, Oid edge_label_table_oid,
+                                 int64 *size);
+static void ppr_resolve_neighbors(ppr_context *pctx, ppr_entry *entry);
+static ppr_entry *ppr_add_residual(ppr_context *pctx, graphid vertex_id,
+                                   float8 amount);
+static void ppr_enqueue(ppr_queue *queue, ppr_entry *entry);
+static ppr_entry *ppr_dequeue(ppr_queue *queue);
+static int compare_ppr_entries(const void *a, const void *b);
+static int32 *get_topological_order(const char *funcname, GraphCSR *csr);
+
+/*
+ * Helper function to resolve a graphid[] argument into CSR ordinals. A NULL
+ * argument selects every vertex of the graph. Ids that are not vertices of
+ * the graph are skipped.
+ */
+static int32 *get_start_ordinals(GraphCSR *csr, FunctionCallInfo fcinfo,
+                                 int argno, int32 *num_starts)
+{
+    int32 *ordinals = NULL;
+    int32 count = 0;
+    int32 i;
+
+    if (PG_ARGISNULL(argno))
+    {
+        ordinals = palloc_extended(sizeof(int32) *
+                                   ((Size) csr->num_vertices + 1),
+                                   MCXT_ALLOC_HUGE);
+        for (i = 0; i < csr->num_vertices; i++)
+        {
+            ordinals[i] = i;
+        }
+        *num_starts = csr->num_vertices;
+    }
+    else
+    {
+        graphid *ids = NULL;
+        int nids = 0;
+
+        ids = get_graphid_array_values(PG_GETARG_ARRAYTYPE_P(argno), &nids);
+        ordinals = palloc(sizeof(int32) * (nids + 1));
+        for (i = 0; i < nids; i++)
+        {
+            int32 ordinal = graph_csr_find_ordinal(csr, ids[i]);
+
+            if (ordinal >= 0)
+            {
+                ordinals[count++] = ordinal;
+            }
+        }
+        pfree(ids);
+        *num_starts = count;
+    }
+
+    return ordinals;
+}
+
+/*
+ * age_degree_centrality(graph_name, direction, edge_label)
+ *
+ * Returns the degree of every vertex in the graph, along with its degree
+ * centrality (the degree normalized by the maximum possible degree, n - 1).
+ * Self loops count toward both the in and out degree, which matches
+ * age_vertex_stats.
+ */
+PG_FUNCTION_INFO_V1(age_degree_centrality);
+
+Datum age_degree_centrality(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    char *graph_name = NULL;
+    char *label_name = NULL;
+    char *direction_str = NULL;
+    int direction;
+    int32 i;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("degree_centrality: graph name cannot be NULL")));
+    }
+
+    graph_name = NameStr(*PG_GETARG_NAME(0));
+    if (!PG_ARGISNULL(1))
+    {
+        direction_str = text_to_cstring(PG_GETARG_TEXT_PP(1));
+    }
+    label_name = get_name_arg_or_null(fcinfo, 2);
+
+    direction = parse_csr_direction("degree_centrality", direction_str);
+
+    /*
+     * Self loops are listed once, in their vertex's row. They are counted
+     * again below for the undirected view, so that they count once per
+     * direction, just like age_vertex_stats does.
+     */
+    csr = build_graph_csr_by_name("degree_centrality", graph_name, label_name,
+                                  direction, true);
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        Datum values[3];
+        bool nulls[3] = {false, false, false};
+        int64 degree = csr->offsets[i + 1] - csr->offsets[i];
+        int64 j;
+
+        if (direction == CSR_DIRECTION_BOTH)
+        {
+            for (j = csr->offsets[i]; j < csr->offsets[i + 1]; j++)
+            {
+                if (csr->targets[j] == i)
+                {
+                    degree++;
+                }
+            }
+        }
+
+        values[0] = GRAPHID_GET_DATUM(csr->vertex_ids[i]);
+        values[1] = Int64GetDatum(degree);
+        values[2] = Float8GetDatum((csr->num_vertices > 1) ?
+                                   (float8) degree /
+                                   (float8) (csr->num_vertices - 1) : 0.0);
+
+        tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+    }
+
+    free_graph_csr(csr);
+
+    PG_RETURN_NULL();
+}
+
+/*
+ * age_kcore(graph_name)
+ *
+ * Returns the core number of every vertex, computed over the undirected view
+ * of the graph with self loops ignored. Parallel edges count toward the
+ * degree with their multiplicity.
+ *
+ * This is the O(V + E) bucket peeling algorithm of Batagelj and Zaversnik:
+ * vertices are kept in an array sorted by their current degree, with bin[d]
+ * marking where the degree d bucket starts. Peeling a vertex moves each of
+ * its higher degree neighbors one bucket down with a single swap.
+ */
+PG_FUNCTION_INFO_V1(age_kcore);
+
+Datum age_kcore(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    int64 *degree = NULL;
+    int64 *bin = NULL;
+    int32 *vert = NULL;
+    int32 *pos = NULL;
+    int64 max_degree = 0;
+    int64 start = 0;
+    int32 n;
+    int32 i;
+    int64 d;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("kcore: graph name cannot be NULL")));
+    }
+
+    csr = build_graph_csr_by_name("kcore", NameStr(*PG_GETARG_NAME(0)), NULL,
+                                  CSR_DIRECTION_BOTH, false);
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    n = csr->num_vertices;
+
+    degree = palloc_extended(sizeof(int64) * ((Size) n + 1), MCXT_ALLOC_HUGE);
+    vert = palloc_extended(sizeof(int32) * ((Size) n + 1), MCXT_ALLOC_HUGE);
+    pos = palloc_extended(sizeof(int32) * ((Size) n + 1), MCXT_ALLOC_HUGE);
+
+    for (i = 0; i < n; i++)
+    {
+        degree[i] = csr->offsets[i + 1] - csr->offsets[i];
+        max_degree = Max(max_degree, degree[i]);
+    }
+
+    /* bucket sort the vertices by degree */
+    bin = palloc0(sizeof(int64) * (max_degree + 1));
+    for (i = 0; i < n; i++)
+    {
+        bin[degree[i]]++;
+    }
+    for (d = 0; d <= max_degree; d++)
+    {
+        int64 count = bin[d];
+
+        bin[d] = start;
+        start += count;
+    }
+    for (i = 0; i < n; i++)
+    {
+        pos[i] = (int32) bin[degree[i]];
+        vert[pos[i]] = i;
+        bin[degree[i]]++;
+    }
+    /* restore the bucket starts */
+    for (d = max_degree; d > 0; d--)
+    {
+        bin[d] = bin[d - 1];
+    }
+    bin[0] = 0;
+
+    /* peel the vertices in order of their current degree */
+    for (i = 0; i < n; i++)
+    {
+        int32 v = vert[i];
+        int64 slot;
+
+        CHECK_FOR_INTERRUPTS();
+
+        for (slot = csr->offsets[v]; slot < csr->offsets[v + 1]; slot++)
+        {
+            int32 u = csr->targets[slot];
+
+            if (degree[u] > degree[v])
+            {
+                int64 du = degree[u];
+                int32 pu = pos[u];
+                int32 pw = (int32) bin[du];
+                int32 w = vert[pw];
+
+                /* swap u with the first vertex of its bucket */
+                if (u != w)
+                {
+                    pos[u] = pw;
+                    vert[pu] = w;
+                    pos[w] = pu;
+                    vert[pw] = u;
+                }
+
+                bin[du]++;
+                degree[u]--;
+            }
+        }
+    }
+
+    /* degree[] now holds the core numbers */
+    for (i = 0; i < n; i++)
+    {
+        Datum values[2];
+        bool nulls[2] = {false, false};
+
+        values[0] = GRAPHID_GET_DATUM(csr->vertex_ids[i]);
+        values[1] = Int64GetDatum(degree[i]);
+
+        tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+    }
+
+    pfree(degree);
+    pfree(bin);
+    pfree(vert);
+    pfree(pos);
+    free_graph_csr(csr);
+
+    PG_RETURN_NULL();
+}
+
+/*
+ * Helper function to pick the next vertex of a walk that is at curr and came
+ * from prev (-1 on the first step). Returns -1 when curr has no out-edges.
+ *
+ * Biased (node2vec) transitions weigh a candidate x by 1/p when it returns
+ * to prev, by 1 when x is also a neighbor of prev, and by 1/q otherwise.
+ * Rather than building the alias tables for every (prev, curr) pair, the
+ * candidate is drawn uniformly and accepted with probability
+ * weight / max_weight, which only needs a binary search in the sorted row
+ * of prev.
+ */
+static int32 next_walk_vertex(GraphCSR *csr, int32 prev, int32 curr,
+                              float8 inv_p, float8 inv_q, float8 max_weight,
+                              bool biased, pg_prng_state *prng)
+{
+    int64 start = csr->offsets[curr];
+    int64 degree = csr->offsets[curr + 1] - start;
+
+    if (degree == 0)
+    {
+        return -1;
+    }
+
+    if (!biased || prev < 0)
+    {
+        return csr->targets[start + (int64) pg_prng_uint64_range(prng, 0,
+                                                                 degree - 1)];
+    }
+
+    for (;;)
+    {
+        int32 candidate;
+        float8 weight;
+
+        candidate = csr->targets[start +
+                                 (int64) pg_prng_uint64_range(prng, 0,
+                                                              degree - 1)];
+
+        if (candidate == prev)
+        {
+            weight = inv_p;
+        }
+        else if (graph_csr_has_neighbor(csr, prev, candidate))
+        {
+            weight = 1.0;
+        }
+        else
+        {
+            weight = inv_q;
+        }
+
+        if (pg_prng_double(prng) * max_weight < weight)
+        {
+            return candidate;
+        }
+    }
+}
+
+/*
+ * age_random_walks(graph_name, start_ids, walk_length, walks_per_node, p, q,
+ *                  seed)
+ *
+ * Generates walks_per_node random walks from each start vertex (every vertex
+ * when start_ids is NULL), following out-edges. Each walk is returned as a
+ * graphid[] of up to walk_length vertices; a walk ends early when it reaches
+ * a vertex without out-edges. With p = q = 1 the walks are uniform, otherwise
+ * they use the node2vec second order transitions. A non NULL seed makes the
+ * output reproducible.
+ */
+PG_FUNCTION_INFO_V1(age_random_walks);
+
+Datum age_random_walks(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    MemoryContext tmp_cxt;
+    MemoryContext old_cxt;
+    pg_prng_state prng;
+    graphid *walk = NULL;
+    int32 *starts = NULL;
+    int32 num_starts = 0;
+    int32 walk_length;
+    int32 walks_per_node;
+    float8 p;
+    float8 q;
+    float8 max_weight;
+    bool biased;
+    int32 i;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("random_walks: graph name cannot be NULL")));
+    }
+
+    walk_length = PG_ARGISNULL(2) ? 10 : PG_GETARG_INT32(2);
+    walks_per_node = PG_ARGISNULL(3) ? 1 : PG_GETARG_INT32(3);
+    p = PG_ARGISNULL(4) ? 1.0 : PG_GETARG_FLOAT8(4);
+    q = PG_ARGISNULL(5) ? 1.0 : PG_GETARG_FLOAT8(5);
+
+    if (walk_length < 1)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("random_walks: walk_length must be at least 1")));
+    }
+    if (walks_per_node < 0)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("random_walks: walks_per_node cannot be negative")));
+    }
+    if (!(p > 0.0) || !(q > 0.0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("random_walks: p and q must be greater than 0")));
+    }
+
+    if (PG_ARGISNULL(6))
+    {
+        pg_prng_seed(&prng, pg_prng_uint64(&pg_global_prng_state));
+    }
+    else
+    {
+        pg_prng_seed(&prng, (uint64) PG_GETARG_INT64(6));
+    }
+
+    csr = build_graph_csr_by_name("random_walks", NameStr(*PG_GETARG_NAME(0)),
+                                  NULL, CSR_DIRECTION_OUT, true);
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    starts = get_start_ordinals(csr, fcinfo, 1, &num_starts);
+
+    /* biased walks check prev's neighbors with a binary search */
+    biased = (p != 1.0 || q != 1.0);
+    if (biased)
+    {
+        sort_graph_csr_rows(csr);
+    }
+    max_weight = Max(1.0, Max(1.0 / p, 1.0 / q));
+
+    walk = palloc(sizeof(graphid) * walk_length);
+
+    tmp_cxt = AllocSetContextCreate(CurrentMemoryContext,
+                                    "age_random_walks temporary cxt",
+                                    ALLOCSET_DEFAULT_SIZES);
+
+    for (i = 0; i < num_starts; i++)
+    {
+        int32 w;
+
+        for (w = 0; w < walks_per_node; w++)
+        {
+            Datum values[2];
+            bool nulls[2] = {false, false};
+            int32 prev = -1;
+            int32 curr = starts[i];
+            int32 length = 0;
+
+            CHECK_FOR_INTERRUPTS();
+
+            walk[length++] = csr->vertex_ids[curr];
+            while (length < walk_length)
+            {
+                int32 next = next_walk_vertex(csr, prev, curr, 1.0 / p,
+                                              1.0 / q, max_weight, biased,
+                                              &prng);
+
+                if (next < 0)
+                {
+                    break;
+                }
+
+                walk[length++] = csr->vertex_ids[next];
+                prev = curr;
+                curr = next;
+            }
+
+            /* use the tmp context so we can clean up after each walk */
+            old_cxt = MemoryContextSwitchTo(tmp_cxt);
+
+            values[0] = GRAPHID_GET_DATUM(csr->vertex_ids[starts[i]]);
+            values[1] = PointerGetDatum(make_graphid_array(walk, length));
+
+            tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+
+            MemoryContextSwitchTo(old_cxt);
+            MemoryContextReset(tmp_cxt);
+        }
+    }
+
+    MemoryContextDelete(tmp_cxt);
+    pfree(walk);
+    pfree(starts);
+    free_graph_csr(csr);
+
+    PG_RETURN_NULL();
+}
+
+/* helper function to parse a similarity metric name */
+static similarity_metric parse_similarity_metric(const char *funcname,
+                                                 const char *metric)
+{
+    if (metric == NULL || pg_strcasecmp(metric, "jaccard") == 0)
+    {
+        return SIMILARITY_JACCARD;
+    }
+    else if (pg_strcasecmp(metric, "overlap") == 0)
+    {
+        return SIMILARITY_OVERLAP;
+    }
+    else if (pg_strcasecmp(metric, "adamic_adar") == 0)
+    {
+        return SIMILARITY_ADAMIC_ADAR;
+    }
+    else if (pg_strcasecmp(metric, "common_neighbors") == 0)
+    {
+        return SIMILARITY_COMMON_NEIGHBORS;
+    }
+
+    ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+             errmsg("%s: invalid metric \"%s\"", funcname, metric),
+             errhint("Valid metrics are \"jaccard\", \"overlap\", \"adamic_adar\", and \"common_neighbors\".")));
+
+    /* keep the compiler quiet */
+    return SIMILARITY_JACCARD;
+}
+
+/*
+ * Helper function to compute a similarity score from the number of common
+ * neighbors, the summed Adamic-Adar weights of those neighbors, and the
+ * sizes of both neighbor sets.
+ */
+static float8 similarity_score(similarity_metric metric, int64 common,
+                               float8 adamic_adar, int64 size_a,
+                               int64 size_b)
+{
+    switch (metric)
+    {
+    case SIMILARITY_JACCARD:
+        if (size_a + size_b - common == 0)
+        {
+            return 0.0;
+        }
+        return (float8) common / (float8) (size_a + size_b - common);
+
+    case SIMILARITY_OVERLAP:
+        if (Min(size_a, size_b) == 0)
+        {
+            return 0.0;
+        }
+        return (float8) common / (float8) Min(size_a, size_b);
+
+    case SIMILARITY_ADAMIC_ADAR:
+        return adamic_adar;
+
+    case SIMILARITY_COMMON_NEIGHBORS:
+        return (float8) common;
+    }
+
+    /* keep the compiler quiet */
+    return 0.0;
+}
+
+/* qsort comparator for scored_vertex, by descending score then ordinal */
+static int compare_scored_vertices(const void *a, const void *b)
+{
+    const scored_vertex *sa = (const scored_vertex *) a;
+    const scored_vertex *sb = (const scored_vertex *) b;
+
+    if (sa->score != sb->score)
+    {
+        return (sa->score > sb->score) ? -1 : 1;
+    }
+    if (sa->ordinal != sb->ordinal)
+    {
+        return (sa->ordinal < sb->ordinal) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/* qsort comparator for graphids */
+static int compare_graphids(const void *a, const void *b)
+{
+    graphid ga = *(const graphid *) a;
+    graphid gb = *(const graphid *) b;
+
+    if (ga == gb)
+    {
+        return 0;
+    }
+
+    return (ga < gb) ? -1 : 1;
+}
+
+/*
+ * Helper function to return the sorted set of distinct neighbors of a
+ * vertex, ignoring edge direction and self loops. Only edges of the
+ * passed label are followed when edge_label_table_oid is valid. The other
+ * vertex of a dangling edge is not loaded, so it is left out, as it is from
+ * the CSR.
+ */
+static graphid *get_neighbor_set(GRAPH_global_context *ggctx,
+                                 graphid vertex_id, Oid edge_label_table_oid,
+                                 int64 *size)
+{
+    vertex_entry *ve = NULL;
+    VertexEdgeArray *edges_out = NULL;
+    VertexEdgeArray *edges_in = NULL;
+    graphid *neighbors = NULL;
+    int64 count = 0;
+    int64 distinct = 0;
+    int64 i;
+
+    ve = get_vertex_entry(ggctx, vertex_id);
+    if (ve == NULL)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("similarity: vertex %ld does not exist", vertex_id)));
+    }
+
+    edges_out = get_vertex_entry_edges_out_array(ve);
+    edges_in = get_vertex_entry_edges_in_array(ve);
+    neighbors = palloc(sizeof(graphid) *
+                       (edges_out->size + edges_in->size + 1));
+
+    for (i = 0; i < edges_out->size; i++)
+    {
+        edge_entry *ee = get_edge_entry(ggctx, edges_out->array[i]);
+        graphid neighbor = get_edge_entry_end_vertex_id(ee);
+
+        if ((!OidIsValid(edge_label_table_oid) ||
+             get_edge_entry_label_table_oid(ee) == edge_label_table_oid) &&
+            get_vertex_entry(ggctx, neighbor) != NULL)
+        {
+            neighbors[count++] = neighbor;
+        }
+    }
+    for (i = 0; i < edges_in->size; i++)
+    {
+        edge_entry *ee = get_edge_entry(ggctx, edges_in->array[i]);
+        graphid neighbor = get_edge_entry_start_vertex_id(ee);
+
+        if ((!OidIsValid(edge_label_table_oid) ||
+             get_edge_entry_label_table_oid(ee) == edge_label_table_oid) &&
+            get_vertex_entry(ggctx, neighbor) != NULL)
+        {
+            neighbors[count++] = neighbor;
+        }
+    }
+
+    qsort(neighbors, count, sizeof(graphid), compare_graphids);
+
+    /* remove the parallel edges */
+    for (i = 0; i < count; i++)
+    {
+        if (distinct == 0 || neighbors[distinct - 1] != neighbors[i])
+        {
+            neighbors[distinct++] = neighbors[i];
+        }
+    }
+
+    *size = distinct;
+    return neighbors;
+}
+
+/*
+ * age_node_similarity(graph_name, edge_label, metric, top_k)
+ *
+ * For every vertex, returns its top_k most similar vertices by neighborhood
+ * similarity, ignoring edge direction. Only vertices that share at least one
+ * neighbor with the source are candidates. Ties are broken by vertex load
+ * order.
+ *
+ * The common neighbor counts of a source are accumulated by walking its
+ * two-hop neighborhood over the sorted neighbor sets of the CSR, into a
+ * dense per-vertex array that is reset through the list of touched vertices.
+ */
+PG_FUNCTION_INFO_V1(age_node_similarity);
+
+Datum age_node_similarity(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    similarity_metric metric;
+    int32 *common = NULL;
+    float8 *adamic_adar = NULL;
+    float8 *inv_log_degree = NULL;
+    int32 *touched = NULL;
+    scored_vertex *candidates = NULL;
+    int32 top_k;
+    int32 n;
+    int32 u;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("node_similarity: graph name cannot be NULL")));
+    }
+
+    metric = parse_similarity_metric("node_similarity",
+                                     PG_ARGISNULL(2) ? NULL :
+                                     text_to_cstring(PG_GETARG_TEXT_PP(2)));
+    top_k = PG_ARGISNULL(3) ? 10 : PG_GETARG_INT32(3);
+    if (top_k < 1)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("node_similarity: top_k must be at least 1")));
+    }
+
+    csr = build_graph_csr_by_name("node_similarity",
+                                  NameStr(*PG_GETARG_NAME(0)),
+                                  get_name_arg_or_null(fcinfo, 1),
+                                  CSR_DIRECTION_BOTH, false);
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    make_graph_csr_neighbor_sets(csr);
+    n = csr->num_vertices;
+
+    common = palloc_extended(sizeof(int32) * ((Size) n + 1),
+                             MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+    touched = palloc_extended(sizeof(int32) * ((Size) n + 1),
+                              MCXT_ALLOC_HUGE);
+    candidates = palloc_extended(sizeof(scored_vertex) * ((Size) n + 1),
+                                 MCXT_ALLOC_HUGE);
+
+    if (metric == SIMILARITY_ADAMIC_ADAR)
+    {
+        adamic_adar = palloc_extended(sizeof(float8) * ((Size) n + 1),
+                                      MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+        inv_log_degree = palloc_extended(sizeof(float8) * ((Size) n + 1),
+                                         MCXT_ALLOC_HUGE);
+
+        for (u = 0; u < n; u++)
+        {
+            int64 degree = csr->offsets[u + 1] - csr->offsets[u];
+
+            inv_log_degree[u] = (degree > 1) ? 1.0 / log((float8) degree) :
+                                               0.0;
+        }
+    }
+
+    for (u = 0; u < n; u++)
+    {
+        int64 size_u = csr->offsets[u + 1] - csr->offsets[u];
+        int32 num_touched = 0;
+        int64 zs;
+        int32 t;
+
+        CHECK_FOR_INTERRUPTS();
+
+        /* count the common neighbors of u with every two-hop vertex */
+        for (zs = csr->offsets[u]; zs < csr->offsets[u + 1]; zs++)
+        {
+            int32 z = csr->targets[zs];
+            int64 vs;
+
+            for (vs = csr->offsets[z]; vs < csr->offsets[z + 1]; vs++)
+            {
+                int32 v = csr->targets[vs];
+
+                if (v == u)
+                {
+                    continue;
+                }
+
+                if (common[v] == 0)
+                {
+                    touched[num_touched++] = v;
+                }
+                common[v]++;
+
+                if (adamic_adar != NULL)
+                {
+                    adamic_adar[v] += inv_log_degree[z];
+                }
+            }
+        }
+
+        /* score the candidates and reset the accumulators */
+        for (t = 0; t < num_touched; t++)
+        {
+            int32 v = touched[t];
+
+            candidates[t].ordinal = v;
+            candidates[t].score =
+                similarity_score(metric, common[v],
+                                 (adamic_adar != NULL) ? adamic_adar[v] : 0.0,
+                                 size_u,
+                                 csr->offsets[v + 1] - csr->offsets[v]);
+
+            common[v] = 0;
+            if (adamic_adar != NULL)
+            {
+                adamic_adar[v] = 0.0;
+            }
+        }
+
+        qsort(candidates, num_touched, sizeof(scored_vertex),
+              compare_scored_vertices);
+
+        for (t = 0; t < num_touched && t < top_k; t++)
+        {
+            Datum values[3];
+            bool nulls[3] = {false, false, false};
+
+            values[0] = GRAPHID_GET_DATUM(csr->vertex_ids[u]);
+            values[1] =
+                GRAPHID_GET_DATUM(csr->vertex_ids[candidates[t].ordinal]);
+            values[2] = Float8GetDatum(candidates[t].score);
+
+            tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+        }
+    }
+
+    pfree(common);
+    pfree(touched);
+    pfree(candidates);
+    pfree_if_not_null(adamic_adar);
+    pfree_if_not_null(inv_log_degree);
+    free_graph_csr(csr);
+
+    PG_RETURN_NULL();
+}
+
+/*
+ * age_similarity(graph_name, a, b, metric, edge_label)
+ *
+ * Returns the neighborhood similarity of two vertices, ignoring edge
+ * direction. This only touches the neighborhoods of a, b, and (for
+ * Adamic-Adar) their common neighbors, so it does not build a CSR.
+ */
+PG_FUNCTION_INFO_V1(age_similarity);
+
+Datum age_similarity(PG_FUNCTION_ARGS)
+{
+    GRAPH_global_context *ggctx = NULL;
+    similarity_metric metric;
+    Oid edge_label_table_oid = InvalidOid;
+    graphid *set_a = NULL;
+    graphid *set_b = NULL;
+    int64 size_a = 0;
+    int64 size_b = 0;
+    int64 common = 0;
+    float8 adamic_adar = 0.0;
+    int64 i = 0;
+    int64 j = 0;
+
+    if (PG_ARGISNULL(0) || PG_ARGISNULL(1) || PG_ARGISNULL(2))
+    {
+        PG_RETURN_NULL();
+    }
+
+    metric = parse_similarity_metric("similarity",
+                                     PG_ARGISNULL(3) ? NULL :
+                                     text_to_cstring(PG_GETARG_TEXT_PP(3)));
+
+    ggctx = get_graph_context_by_name("similarity",
+                                      NameStr(*PG_GETARG_NAME(0)));
+    edge_label_table_oid =
+        get_edge_label_table_oid_by_name("similarity",
+                                         get_graph_context_oid(ggctx),
+                                         get_name_arg_or_null(fcinfo, 4));
+
+    set_a = get_neighbor_set(ggctx, AG_GETARG_GRAPHID(1),
+                             edge_label_table_oid, &size_a);
+    set_b = get_neighbor_set(ggctx, AG_GETARG_GRAPHID(2),
+                             edge_label_table_oid, &size_b);
+
+    /* intersect the sorted neighbor sets */
+    while (i < size_a && j < size_b)
+    {
+        if (set_a[i] < set_b[j])
+        {
+            i++;
+        }
+        else if (set_a[i] > set_b[j])
+        {
+            j++;
+        }
+        else
+        {
+            common++;
+
+            if (metric == SIMILARITY_ADAMIC_ADAR)
+            {
+                graphid *set_z = NULL;
+                int64 size_z = 0;
+
+                set_z = get_neighbor_set(ggctx, set_a[i],
+                                         edge_label_table_oid, &size_z);
+                if (size_z > 1)
+                {
+                    adamic_adar += 1.0 / log((float8) size_z);
+                }
+                pfree(set_z);
+            }
+
+            i++;
+            j++;
+        }
+    }
+
+    pfree(set_a);
+    pfree(set_b);
+
+    PG_RETURN_FLOAT8(similarity_score(metric, common, adamic_adar, size_a,
+                                      size_b));
+}
+
+/*
+ * Helper function to resolve the out-neighbors of a personalized PageRank
+ * entry. Self loops count as out-edges back to the vertex itself. The end
+ * vertex of a dangling edge is not loaded, so no mass is pushed onto it, and
+ * a vertex without an entry is a dangling node.
+ */
+static void ppr_resolve_neighbors(ppr_context *pctx, ppr_entry *entry)
+{
+    vertex_entry *ve = NULL;
+    VertexEdgeArray *edges_out = NULL;
+    VertexEdgeArray *edges_self = NULL;
+    int32 count = 0;
+    int32 i;
+
+    ve = get_vertex_entry(pctx->ggctx, entry->vertex_id);
+    if (ve == NULL)
+    {
+        entry->neighbors = NULL;
+        entry->degree = 0;
+        return;
+    }
+
+    edges_out = get_vertex_entry_edges_out_array(ve);
+    edges_self = get_vertex_entry_edges_self_array(ve);
+
+    entry->neighbors = palloc(sizeof(graphid) *
+                              (edges_out->size + edges_self->size + 1));
+
+    for (i = 0; i < edges_out->size; i++)
+    {
+        edge_entry *ee = get_edge_entry(pctx->ggctx, edges_out->array[i]);
+
+        graphid end_id;
+
+        if (OidIsValid(pctx->edge_label_table_oid) &&
+            get_edge_entry_label_table_oid(ee) != pctx->edge_label_table_oid)
+        {
+            continue;
+        }
+
+        end_id = get_edge_entry_end_vertex_id(ee);
+        if (get_vertex_entry(pctx->ggctx, end_id) != NULL)
+        {
+            entry->neighbors[count++] = end_id;
+        }
+    }
+    for (i = 0; i < edges_self->size; i++)
+    {
+        edge_entry *ee = get_edge_entry(pctx->ggctx, edges_self->array[i]);
+
+        if (!OidIsValid(pctx->edge_label_table_oid) ||
+            get_edge_entry_label_table_oid(ee) == pctx->edge_label_table_oid)
+        {
+            entry->neighbors[count++] = entry->vertex_id;
+        }
+    }
+
+    entry->degree = count;
+}
+
+/*
+ * Adds residual mass to a vertex, creating its entry on first touch, and
+ * queues it once its residual per out-edge reaches epsilon.
+ */
+static ppr_entry *ppr_add_residual(ppr_context *pctx, graphid vertex_id,
+                                   float8 amount)
+{
+    ppr_entry *entry = NULL;
+    bool found = false;
+
+    entry = (ppr_entry *) hash_search(pctx->entries, &vertex_id, HASH_ENTER,
+                                      &found);
+    if (!found)
+    {
+        entry->estimate = 0.0;
+        entry->residual = 0.0;
+        entry->neighbors = NULL;
+        entry->degree = -1;
+        entry->queued = false;
+    }
+
+    entry->residual += amount;
+
+    if (!entry->queued)
+    {
+        if (entry->degree < 0)
+        {
+            ppr_resolve_neighbors(pctx, entry);
+        }
+
+        if (entry->residual >= pctx->epsilon * Max(entry->degree, 1))
+        {
+            ppr_enqueue(&pctx->queue, entry);
+        }
+    }
+
+    return entry;
+}
+
+static void ppr_enqueue(ppr_queue *queue, ppr_entry *entry)
+{
+    if (queue->count == queue->capacity)
+    {
+        int64 new_capacity = Max(queue->capacity * 2, 64);
+        ppr_entry **items = palloc_extended(sizeof(ppr_entry *) *
+                                            new_capacity, MCXT_ALLOC_HUGE);
+        int64 i;
+
+        /* unwrap the ring into the new array */
+        for (i = 0; i < queue->count; i++)
+        {
+            items[i] = queue->items[(queue->head + i) % queue->capacity];
+        }
+
+        pfree_if_not_null(queue->items);
+        queue->items = items;
+        queue->head = 0;
+        queue->capacity = new_capacity;
+    }
+
+    queue->items[(queue->head + queue->count) % queue->capacity] = entry;
+    queue->count++;
+    entry->queued = true;
+}
+
+static ppr_entry *ppr_dequeue(ppr_queue *queue)
+{
+    ppr_entry *entry = queue->items[queue->head];
+
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    entry->queued = false;
+
+    return entry;
+}
+
+/* qsort comparator for ppr_entry pointers, by descending estimate then id */
+static int compare_ppr_entries(const void *a, const void *b)
+{
+    const ppr_entry *ea = *(const ppr_entry *const *) a;
+    const ppr_entry *eb = *(const ppr_entry *const *) b;
+
+    if (ea->estimate != eb->estimate)
+    {
+        return (ea->estimate > eb->estimate) ? -1 : 1;
+    }
+    if (ea->vertex_id != eb->vertex_id)
+    {
+        return (ea->vertex_id < eb->vertex_id) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/*
+ * age_personalized_pagerank(graph_name, seed_ids, alpha, epsilon, top_k,
+ *                           edge_label)
+ *
+ * Approximates the PageRank personalized to a seed set with the forward push
+ * algorithm (Andersen, Chung, and Lang). alpha is the restart probability.
+ * A vertex is pushed while its residual is at least epsilon per out-edge,
+ * so the work is bounded by 1 / (alpha * epsilon) and only the neighborhood
+ * the mass actually reaches is touched; no CSR is built. The residual of a
+ * vertex without out-edges restarts at the seeds. Returns the top_k vertices
+ * by score, ties broken by graphid.
+ */
+PG_FUNCTION_INFO_V1(age_personalized_pagerank);
+
+Datum age_personalized_pagerank(PG_FUNCTION_ARGS)
+{
+    ppr_context pctx;
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    HASHCTL ctl;
+    HASH_SEQ_STATUS seq;
+    MemoryContext ppr_cxt;
+    MemoryContext old_cxt;
+    graphid *seed_ids = NULL;
+    int num_seed_ids = 0;
+    ppr_entry **ranked = NULL;
+    ppr_entry *entry = NULL;
+    float8 alpha = 0.15;
+    int64 num_ranked = 0;
+    int32 top_k = 10;
+    int64 i;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("personalized_pagerank: graph name cannot be NULL")));
+    }
+    if (PG_ARGISNULL(1))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("personalized_pagerank: seed_ids cannot be NULL")));
+    }
+
+    MemSet(&pctx, 0, sizeof(pctx));
+    pctx.epsilon = 1e-6;
+
+    if (!PG_ARGISNULL(2))
+    {
+        alpha = PG_GETARG_FLOAT8(2);
+    }
+    if (!PG_ARGISNULL(3))
+    {
+        pctx.epsilon = PG_GETARG_FLOAT8(3);
+    }
+    if (!PG_ARGISNULL(4))
+    {
+        top_k = PG_GETARG_INT32(4);
+    }
+
+    if (!(alpha > 0.0 && alpha <= 1.0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("personalized_pagerank: alpha must be greater than 0 and at most 1")));
+    }
+    if (!(pctx.epsilon > 0.0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("personalized_pagerank: epsilon must be greater than 0")));
+    }
+    if (top_k < 1)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("personalized_pagerank: top_k must be at least 1")));
+    }
+
+    pctx.ggctx = get_graph_context_by_name("personalized_pagerank",
+                                           NameStr(*PG_GETARG_NAME(0)));
+    pctx.edge_label_table_oid =
+        get_edge_label_table_oid_by_name("personalized_pagerank",
+                                         get_graph_context_oid(pctx.ggctx),
+                                         get_name_arg_or_null(fcinfo, 5));
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    seed_ids = get_graphid_array_values(PG_GETARG_ARRAYTYPE_P(1),
+                                        &num_seed_ids);
+
+    ppr_cxt = AllocSetContextCreate(CurrentMemoryContext,
+                                    "age_personalized_pagerank cxt",
+                                    ALLOCSET_DEFAULT_SIZES);
+    old_cxt = MemoryContextSwitchTo(ppr_cxt);
+
+    MemSet(&ctl, 0, sizeof(ctl));
+    ctl.keysize = sizeof(graphid);
+    ctl.entrysize = sizeof(ppr_entry);
+    ctl.hash = graphid_hash;
+    ctl.hcxt = ppr_cxt;
+    pctx.entries = hash_create("age_personalized_pagerank entries", 1024,
+                               &ctl, HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+    /* spread the initial residual evenly over the seeds that exist */
+    pctx.seeds = palloc(sizeof(ppr_entry *) * (num_seed_ids + 1));
+    for (i = 0; i < num_seed_ids; i++)
+    {
+        if (get_vertex_entry(pctx.ggctx, seed_ids[i]) != NULL)
+        {
+            seed_ids[pctx.num_seeds++] = seed_ids[i];
+        }
+    }
+    for (i = 0; i < pctx.num_seeds; i++)
+    {
+        pctx.seeds[i] = ppr_add_residual(&pctx, seed_ids[i],
+                                         1.0 / pctx.num_seeds);
+    }
+
+    while (pctx.queue.count > 0)
+    {
+        float8 residual;
+        float8 share;
+        int32 j;
+
+        CHECK_FOR_INTERRUPTS();
+
+        entry = ppr_dequeue(&pctx.queue);
+        residual = entry->residual;
+
+        entry->estimate += alpha * residual;
+        entry->residual = 0.0;
+
+        if (entry->degree > 0)
+        {
+            share = (1.0 - alpha) * residual / entry->degree;
+            for (j = 0; j < entry->degree; j++)
+            {
+                ppr_add_residual(&pctx, entry->neighbors[j], share);
+            }
+        }
+        else
+        {
+            share = (1.0 - alpha) * residual / pctx.num_seeds;
+            for (j = 0; j < pctx.num_seeds; j++)
+            {
+                ppr_add_residual(&pctx, pctx.seeds[j]->vertex_id, share);
+            }
+        }
+    }
+
+    /* rank the vertices that received any mass */
+    ranked = palloc_extended(sizeof(ppr_entry *) *
+                             (hash_get_num_entries(pctx.entries) + 1),
+                             MCXT_ALLOC_HUGE);
+    hash_seq_init(&seq, pctx.entries);
+    while ((entry = (ppr_entry *) hash_seq_search(&seq)) != NULL)
+    {
+        if (entry->estimate > 0.0)
+        {
+            ranked[num_ranked++] = entry;
+        }
+    }
+    qsort(ranked, num_ranked, sizeof(ppr_entry *), compare_ppr_entries);
+
+    MemoryContextSwitchTo(old_cxt);
+
+    for (i = 0; i < num_ranked && i < top_k; i++)
+    {
+        Datum values[2];
+        bool nulls[2] = {false, false};
+
+        values[0] = GRAPHID_GET_DATUM(ranked[i]->vertex_id);
+        values[1] = Float8GetDatum(ranked[i]->estimate);
+
+        tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+    }
+
+    MemoryContextDelete(ppr_cxt);
+    pfree(seed_ids);
+
+    PG_RETURN_NULL();
+}
+
+/*
+ * Helper function to order the vertices of an OUT CSR topologically, with
+ * Kahn's algorithm. Vertices whose in-degree drops to zero are appended to
+ * the order, which doubles as the FIFO queue, so ties are broken by vertex
+ * ordinal. It errors out when the graph has a cycle, self loops included.
+ */
+static int32 *get_topological_order(const char *funcname, GraphCSR *csr)
+{
+    int64 *in_degree = NULL;
+    int32 *order = NULL;
+    int32 n = csr->num_vertices;
+    int32 head = 0;
+    int32 tail = 0;
+    int32 i;
+    int64 slot;
+
+    in_degree = palloc_extended(sizeof(int64) * ((Size) n + 1),
+                                MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+    order = palloc_extended(sizeof(int32) * ((Size) n + 1), MCXT_ALLOC_HUGE);
+
+    for (slot = 0; slot < csr->num_edges; slot++)
+    {
+        in_degree[csr->targets[slot]]++;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if (in_degree[i] == 0)
+        {
+            order[tail++] = i;
+        }
+    }
+
+    while (head < tail)
+    {
+        int32 v = order[head++];
+
+        CHECK_FOR_INTERRUPTS();
+
+        for (slot = csr->offsets[v]; slot < csr->offsets[v + 1]; slot++)
+        {
+            int32 u = csr->targets[slot];
+
+            if (--in_degree[u] == 0)
+            {
+                order[tail++] = u;
+            }
+        }
+    }
+
+    pfree(in_degree);
+
+    if (tail < n)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("%s: graph contains a cycle", funcname),
+                 errdetail("%d of %d vertices are on or reachable from a cycle.",
+                           n - tail, n)));
+    }
+
+    return order;
+}
+
+/*
+ * age_topological_sort(graph_name, edge_label)
+ *
+ * Returns every vertex with its position in a topological order of the
+ * graph, so that each edge goes from a lower to a higher position. Among the
+ * vertices that are ready at the same time, the one loaded first comes
+ * first. Errors out if the graph is not acyclic. Runs in O(V + E).
+ */
+PG_FUNCTION_INFO_V1(age_topological_sort);
+
+Datum age_topological_sort(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    int32 *order = NULL;
+    int32 i;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("topological_sort: graph name cannot be NULL")));
+    }
+
+    csr = build_graph_csr_by_name("topological_sort",
+                                  NameStr(*PG_GETARG_NAME(0)),
+                                  get_name_arg_or_null(fcinfo, 1),
+                                  CSR_DIRECTION_OUT, true);
+
+    order = get_topological_order("topological_sort", csr);
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        Datum values[2];
+        bool nulls[2] = {false, false};
+
+        values[0] = GRAPHID_GET_DATUM(csr->vertex_ids[order[i]]);
+        values[1] = Int64GetDatum((int64) i + 1);
+
+        tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+    }
+
+    pfree(order);
+    free_graph_csr(csr);
+
+    PG_RETURN_NULL();
+}
+
+/*
+ * age_dag_longest_path(graph_name, edge_label, weight_property)
+ *
+ * Returns the vertices, the edges, and the length of a longest path of an
+ * acyclic graph. Edges weigh the numeric value of weight_property, or 1 when
+ * it is NULL. The distances are relaxed once per edge in topological order,
+ * so this runs in O(V + E) and negative weights are allowed. Of several
+ * longest paths, the one ending at the vertex that comes first in
+ * topological order is returned. Errors out if the graph is not acyclic.
+ */
+PG_FUNCTION_INFO_V1(age_dag_longest_path);
+
+Datum age_dag_longest_path(PG_FUNCTION_ARGS)
+{
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    char *weight_property = NULL;
+    float8 *weights = NULL;
+    float8 *distance = NULL;
+    int64 *pred_slot = NULL;
+    int32 *pred = NULL;
+    int32 *order = NULL;
+    graphid *vertex_path = NULL;
+    graphid *edge_path = NULL;
+    Datum values[3];
+    bool nulls[3] = {false, false, false};
+    float8 length = 0.0;
+    int32 path_length = 0;
+    int32 end = -1;
+    int32 n;
+    int32 i;
+    int32 v;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("dag_longest_path: graph name cannot be NULL")));
+    }
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+    {
+        elog(ERROR, "return type must be a row type");
+    }
+
+    if (!PG_ARGISNULL(2))
+    {
+        weight_property = text_to_cstring(PG_GETARG_TEXT_PP(2));
+    }
+
+    csr = build_graph_csr_by_name("dag_longest_path",
+                                  NameStr(*PG_GETARG_NAME(0)),
+                                  get_name_arg_or_null(fcinfo, 1),
+                                  CSR_DIRECTION_OUT, true);
+
+    order = get_topological_order("dag_longest_path", csr);
+
+    if (weight_property != NULL)
+    {
+        weights = get_graph_csr_edge_weights("dag_longest_path", csr,
+                                             weight_property);
+    }
+
+    n = csr->num_vertices;
+
+    /* every vertex starts a path of its own, of length 0 */
+    distance = palloc_extended(sizeof(float8) * ((Size) n + 1),
+                               MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+    pred = palloc_extended(sizeof(int32) * ((Size) n + 1), MCXT_ALLOC_HUGE);
+    pred_slot = palloc_extended(sizeof(int64) * ((Size) n + 1),
+                                MCXT_ALLOC_HUGE);
+    for (i = 0; i < n; i++)
+    {
+        pred[i] = -1;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        int64 slot;
+
+        CHECK_FOR_INTERRUPTS();
+
+        v = order[i];
+
+        for (slot = csr->offsets[v]; slot < csr->offsets[v + 1]; slot++)
+        {
+            int32 u = csr->targets[slot];
+            float8 d = distance[v] + ((weights != NULL) ? weights[slot] : 1.0);
+
+            if (d > distance[u])
+            {
+                distance[u] = d;
+                pred[u] = v;
+                pred_slot[u] = slot;
+            }
+        }
+
+        if (end < 0 || distance[v] > length)
+        {
+            end = v;
+            length = distance[v];
+        }
+    }
+
+    /* walk the predecessors back from the end of the path */
+    for (v = end; v >= 0; v = pred[v])
+    {
+        path_length++;
+    }
+
+    vertex_path = palloc(sizeof(graphid) * (path_length + 1));
+    edge_path = palloc(sizeof(graphid) * (path_length + 1));
+
+    i = path_length;
+    for (v = end; v >= 0; v = pred[v])
+    {
+        vertex_path[--i] = csr->vertex_ids[v];
+        if (pred[v] >= 0)
+        {
+            edge_path[i - 1] = csr->edge_ids[pred_slot[v]];
+        }
+    }
+
+    values[0] = PointerGetDatum(make_graphid_array(vertex_path, path_length));
+    values[1] = PointerGetDatum(make_graphid_array(edge_path,
+                                                   Max(path_length - 1, 0)));
+    values[2] = Float8GetDatum(length);
+
+    pfree(order);
+    pfree(distance);
+    pfree(pred);
+    pfree(pred_slot);
+    pfree_if_not_null(weights);
+    free_graph_csr(csr);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(BlessTupleDesc(tupdesc),
+                                                      values, nulls)));
+}
+
+/*
+ * age_khop_count(graph_name, start_ids, k, direction, edge_label)
+ *
+ * Counts, for each start vertex, the distinct vertices first reached at each
+ * hop from 1 to k, with a breadth first search that stops at hop k. Nothing
+ * is allocated per start or per path: the queue is a single array of
+ * ordinals and a vertex counts as visited when its slot in the visited array
+ * holds the epoch of the current search, so moving on to the next start is
+ * just an epoch increment. Hops past the reach of a start are not returned.
+ */
+PG_FUNCTION_INFO_V1(age_khop_count);
+
+Datum age_khop_count(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    char *direction_str = NULL;
+    uint32 *visited = NULL;
+    uint32 epoch = 0;
+    int32 *queue = NULL;
+    int32 *starts = NULL;
+    int32 num_starts = 0;
+    int32 k;
+    int direction;
+    int32 i;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("khop_count: graph name cannot be NULL")));
+    }
+
+    k = PG_ARGISNULL(2) ? 1 : PG_GETARG_INT32(2);
+    if (k < 1)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("khop_count: k must be at least 1")));
+    }
+
+    if (!PG_ARGISNULL(3))
+    {
+        direction_str = text_to_cstring(PG_GETARG_TEXT_PP(3));
+    }
+    direction = parse_csr_direction("khop_count", direction_str);
+
+    csr = build_graph_csr_by_name("khop_count", NameStr(*PG_GETARG_NAME(0)),
+                                  get_name_arg_or_null(fcinfo, 4), direction,
+                                  false);
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    starts = get_start_ordinals(csr, fcinfo, 1, &num_starts);
+
+    visited = palloc_extended(sizeof(uint32) * ((Size) csr->num_vertices + 1),
+                              MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+    queue = palloc_extended(sizeof(int32) * ((Size) csr->num_vertices + 1),
+                            MCXT_ALLOC_HUGE);
+
+    for (i = 0; i < num_starts; i++)
+    {
+        int32 head = 0;
+        int32 tail = 0;
+        int32 hop;
+
+        CHECK_FOR_INTERRUPTS();
+
+        /* on wraparound, stale epochs could match again, so start over */
+        if (++epoch == 0)
+        {
+            memset(visited, 0, sizeof(uint32) * csr->num_vertices);
+            epoch = 1;
+        }
+
+        visited[starts[i]] = epoch;
+        queue[tail++] = starts[i];
+
+        for (hop = 1; hop <= k; hop++)
+        {
+            int32 level_end = tail;
+            Datum values[3];
+            bool nulls[3] = {false, false, false};
+
+            /* expand the frontier of the previous hop */
+            while (head < level_end)
+            {
+                int32 v = queue[head++];
+                int64 slot;
+
+                for (slot = csr->offsets[v]; slot < csr->offsets[v + 1];
+                     slot++)
+                {
+                    int32 u = csr->targets[slot];
+
+                    if (visited[u] != epoch)
+                    {
+                        visited[u] = epoch;
+                        queue[tail++] = u;
+                    }
+                }
+            }
+
+            if (tail == level_end)
+            {
+                break;
+            }
+
+            values[0] = GRAPHID_GET_DATUM(csr->vertex_ids[starts[i]]);
+            values[1] = Int32GetDatum(hop);
+            values[2] = Int64GetDatum((int64) (tail - level_end));
+
+            tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+        }
+    }
+
+    pfree(visited);
+    pfree(queue);
+    pfree(starts);
+    free_graph_csr(csr);
+
+    PG_RETURN_NULL();
+}
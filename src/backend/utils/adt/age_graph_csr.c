@@ -0,0 +1,957 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Dense adjacency (CSR) views over the GRAPH global context.
+ *
+ * The global graph cache is keyed by graphid: vertices live in a dynahash
+ * table and every adjacency slot is an edge graphid that has to be resolved
+ * through the edge table. That is fine for path enumeration, but whole graph
+ * algorithms touch every edge many times. These helpers resolve each edge
+ * once, into an array of neighbor ordinals, so the algorithms can run their
+ * inner loops over flat arrays.
+ */
+
+#include "postgres.h"
+
+#include "access/parallel.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "utils/fmgrprotos.h"
+#include "utils/lsyscache.h"
+
+#include "catalog/ag_graph.h"
+#include "catalog/ag_label.h"
+#include "utils/ag_cache.h"
+#include "utils/ag_guc.h"
+#include "utils/age_graph_csr.h"
+
+/* shm_toc keys of a CSR stored in a parallel DSM segment */
+#define CSR_KEY_HEADER  UINT64CONST(0xA6E0000000000101)
+#define CSR_KEY_OFFSETS UINT64CONST(0xA6E0000000000102)
+#define CSR_KEY_TARGETS UINT64CONST(0xA6E0000000000103)
+
+/* sizes of a CSR stored in a parallel DSM segment */
+typedef struct GraphCSRHeader
+{
+    int32 num_vertices;
+    int64 num_edges;
+    int direction;
+} GraphCSRHeader;
+
+/* a CSR slot, used to sort a row's targets together with their edge ids */
+typedef struct csr_slot
+{
+    int32 target;
+    graphid edge_id;
+    int64 projection_edge;
+} csr_slot;
+
+static int compare_csr_slots(const void *a, const void *b);
+static int64 count_adjacency_slots(GRAPH_global_context *ggctx,
+                                   graphid *vertex_ids, int32 num_vertices,
+                                   int direction, bool include_self_loops);
+static int64 append_edge_slots(GraphCSR *csr, VertexEdgeArray *edges,
+                               int64 slot, bool use_end_vertex);
+
+/*
+ * Build the CSR adjacency for the passed GRAPH global context.
+ *
+ * direction selects the out-edges, the in-edges, or both (the undirected
+ * view). When edge_label_table_oid is valid, only edges of that label are
+ * kept. Self loops are listed once, in the row of their vertex, when
+ * include_self_loops is true. Dangling edges, which the context keeps with a
+ * WARNING, are left out, so every target is a valid ordinal.
+ */
+GraphCSR *build_graph_csr(GRAPH_global_context *ggctx, int direction,
+                          Oid edge_label_table_oid, bool include_self_loops)
+{
+    GraphCSR *csr = NULL;
+    GraphIdNode *curr = NULL;
+    int64 max_slots = 0;
+    int64 slot = 0;
+    int32 num_vertices = 0;
+    int32 i = 0;
+
+    Assert(ggctx != NULL);
+    Assert((direction & CSR_DIRECTION_BOTH) != 0);
+
+    num_vertices = (int32) get_graph_num_loaded_vertices(ggctx);
+
+    csr = palloc0(sizeof(GraphCSR));
+    csr->ggctx = ggctx;
+    csr->num_vertices = num_vertices;
+    csr->direction = direction;
+    csr->edge_label_table_oid = edge_label_table_oid;
+    csr->vertex_ids = palloc_extended(sizeof(graphid) *
+                                      ((Size) num_vertices + 1),
+                                      MCXT_ALLOC_HUGE);
+    csr->offsets = palloc_extended(sizeof(int64) *
+                                   ((Size) num_vertices + 1),
+                                   MCXT_ALLOC_HUGE);
+
+    /* the vertices list is in load order, which is the ordinal order */
+    curr = peek_stack_head(get_graph_vertices(ggctx));
+    for (i = 0; i < num_vertices; i++)
+    {
+        Assert(curr != NULL);
+        csr->vertex_ids[i] = get_graphid(curr);
+        curr = next_GraphIdNode(curr);
+    }
+
+    /*
+     * Size the slot arrays from the adjacency array sizes. This is an upper
+     * bound when a label filter is applied or edges are dangling, but it
+     * costs no edge lookups. The offsets only count the slots that are
+     * filled.
+     */
+    max_slots = count_adjacency_slots(ggctx, csr->vertex_ids, num_vertices,
+                                      direction, include_self_loops);
+    csr->targets = palloc_extended(sizeof(int32) * ((Size) max_slots + 1),
+                                   MCXT_ALLOC_HUGE);
+    csr->edge_ids = palloc_extended(sizeof(graphid) * ((Size) max_slots + 1),
+                                    MCXT_ALLOC_HUGE);
+
+    for (i = 0; i < num_vertices; i++)
+    {
+        vertex_entry *ve = get_vertex_entry(ggctx, csr->vertex_ids[i]);
+
+        csr->offsets[i] = slot;
+
+        if (direction & CSR_DIRECTION_OUT)
+        {
+            slot = append_edge_slots(csr,
+                                     get_vertex_entry_edges_out_array(ve),
+                                     slot, true);
+        }
+        if (direction & CSR_DIRECTION_IN)
+        {
+            slot = append_edge_slots(csr,
+                                     get_vertex_entry_edges_in_array(ve),
+                                     slot, false);
+        }
+        if (include_self_loops)
+        {
+            slot = append_edge_slots(csr,
+                                     get_vertex_entry_edges_self_array(ve),
+                                     slot, true);
+        }
+    }
+    csr->offsets[num_vertices] = slot;
+    csr->num_edges = slot;
+
+    return csr;
+}
+
+/*
+ * Build the CSR adjacency for a named projection. The arguments are the same
+ * as for build_graph_csr and the rows are laid out the same way: self loops
+ * are never part of the out or in rows, and are listed once when
+ * include_self_loops is true. The rows are filled with a counting sort of
+ * the projection's edge list, so no hash lookups are needed.
+ */
+GraphCSR *build_projection_csr(GraphProjection *projection, int direction,
+                               Oid edge_label_table_oid,
+                               bool include_self_loops)
+{
+    GraphCSR *csr = NULL;
+    int64 *next = NULL;
+    int32 num_vertices = projection->num_vertices;
+    int64 e;
+    int32 i;
+
+    Assert((direction & CSR_DIRECTION_BOTH) != 0);
+
+    csr = palloc0(sizeof(GraphCSR));
+    csr->projection = projection;
+    csr->num_vertices = num_vertices;
+    csr->direction = direction;
+    csr->edge_label_table_oid = edge_label_table_oid;
+    csr->vertex_ids = palloc_extended(sizeof(graphid) *
+                                      ((Size) num_vertices + 1),
+                                      MCXT_ALLOC_HUGE);
+    memcpy(csr->vertex_ids, projection->vertex_ids,
+           sizeof(graphid) * num_vertices);
+    csr->offsets = palloc_extended(sizeof(int64) *
+                                   ((Size) num_vertices + 1),
+                                   MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+
+    /* count the slots of every row, shifted by one for the prefix sum */
+    for (e = 0; e < projection->num_edges; e++)
+    {
+        int32 start = projection->edge_starts[e];
+        int32 end = projection->edge_ends[e];
+
+        if (OidIsValid(edge_label_table_oid) &&
+            projection->edge_label_oids[e] != edge_label_table_oid)
+        {
+            continue;
+        }
+
+        if (start == end)
+        {
+            if (include_self_loops)
+            {
+                csr->offsets[start + 1]++;
+            }
+            continue;
+        }
+
+        if (direction & CSR_DIRECTION_OUT)
+        {
+            csr->offsets[start + 1]++;
+        }
+        if (direction & CSR_DIRECTION_IN)
+        {
+            csr->offsets[end + 1]++;
+        }
+    }
+
+    for (i = 0; i < num_vertices; i++)
+    {
+        csr->offsets[i + 1] += csr->offsets[i];
+    }
+    csr->num_edges = csr->offsets[num_vertices];
+
+    csr->targets = palloc_extended(sizeof(int32) *
+                                   ((Size) csr->num_edges + 1),
+                                   MCXT_ALLOC_HUGE);
+    csr->edge_ids = palloc_extended(sizeof(graphid) *
+                                    ((Size) csr->num_edges + 1),
+                                    MCXT_ALLOC_HUGE);
+    csr->projection_edges = palloc_extended(sizeof(int64) *
+                                            ((Size) csr->num_edges + 1),
+                                            MCXT_ALLOC_HUGE);
+    next = palloc_extended(sizeof(int64) * ((Size) num_vertices + 1),
+                           MCXT_ALLOC_HUGE);
+    memcpy(next, csr->offsets, sizeof(int64) * num_vertices);
+
+    for (e = 0; e < projection->num_edges; e++)
+    {
+        int32 start = projection->edge_starts[e];
+        int32 end = projection->edge_ends[e];
+        graphid edge_id = projection->edge_ids[e];
+
+        if (OidIsValid(edge_label_table_oid) &&
+            projection->edge_label_oids[e] != edge_label_table_oid)
+        {
+            continue;
+        }
+
+        if (start == end)
+        {
+            if (include_self_loops)
+            {
+                csr->targets[next[start]] = start;
+                csr->edge_ids[next[start]] = edge_id;
+                csr->projection_edges[next[start]++] = e;
+            }
+            continue;
+        }
+
+        if (direction & CSR_DIRECTION_OUT)
+        {
+            csr->targets[next[start]] = end;
+            csr->edge_ids[next[start]] = edge_id;
+            csr->projection_edges[next[start]++] = e;
+        }
+        if (direction & CSR_DIRECTION_IN)
+        {
+            csr->targets[next[end]] = start;
+            csr->edge_ids[next[end]] = edge_id;
+            csr->projection_edges[next[end]++] = e;
+        }
+    }
+
+    pfree(next);
+
+    return csr;
+}
+
+/*
+ * Helper function for the graph algorithm functions to build the CSR of the
+ * graph or projection they were passed. A projection cannot be created with
+ * the name of a graph; a graph created later with the name of a projection
+ * makes the name ambiguous, which is an error. edge_label_name is resolved
+ * against the graph (of the projection) and may be NULL.
+ */
+GraphCSR *build_graph_csr_by_name(const char *funcname, const char *name,
+                                  const char *edge_label_name, int direction,
+                                  bool include_self_loops)
+{
+    GraphProjection *projection = NULL;
+    GRAPH_global_context *ggctx = NULL;
+    Oid edge_label_table_oid;
+
+    projection = find_graph_projection(name);
+    if (projection != NULL)
+    {
+        if (OidIsValid(get_graph_oid(name)))
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_AMBIGUOUS_PARAMETER),
+                     errmsg("%s: \"%s\" is both a graph and a projection",
+                            funcname, name),
+                     errhint("Drop the projection with "
+                             "age_drop_projection().")));
+        }
+
+        edge_label_table_oid =
+            get_edge_label_table_oid_by_name(funcname, projection->graph_oid,
+                                             edge_label_name);
+
+        return build_projection_csr(projection, direction,
+                                    edge_label_table_oid, include_self_loops);
+    }
+
+    ggctx = get_graph_context_by_name(funcname, name);
+    edge_label_table_oid =
+        get_edge_label_table_oid_by_name(funcname,
+                                         get_graph_context_oid(ggctx),
+                                         edge_label_name);
+
+    return build_graph_csr(ggctx, direction, edge_label_table_oid,
+                           include_self_loops);
+}
+
+/* helper function to free a CSR built with build_graph_csr */
+void free_graph_csr(GraphCSR *csr)
+{
+    if (csr == NULL)
+    {
+        return;
+    }
+
+    pfree_if_not_null(csr->vertex_ids);
+    pfree_if_not_null(csr->offsets);
+    pfree_if_not_null(csr->targets);
+    pfree_if_not_null(csr->edge_ids);
+    pfree_if_not_null(csr->projection_edges);
+    pfree(csr);
+}
+
+/*
+ * Helper function to sort the targets of every CSR row in ascending ordinal
+ * order. The edge ids are kept with their targets. Sorted rows allow
+ * neighbor set intersections and graph_csr_has_neighbor.
+ */
+void sort_graph_csr_rows(GraphCSR *csr)
+{
+    csr_slot *slots = NULL;
+    int64 max_row = 0;
+    int32 i;
+
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        max_row = Max(max_row, csr->offsets[i + 1] - csr->offsets[i]);
+    }
+
+    if (max_row < 2)
+    {
+        return;
+    }
+
+    slots = palloc_extended(sizeof(csr_slot) * (Size) max_row,
+                            MCXT_ALLOC_HUGE);
+
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        int64 start = csr->offsets[i];
+        int64 length = csr->offsets[i + 1] - start;
+        int64 j;
+
+        if (length < 2)
+        {
+            continue;
+        }
+
+        for (j = 0; j < length; j++)
+        {
+            slots[j].target = csr->targets[start + j];
+            slots[j].edge_id = csr->edge_ids[start + j];
+            slots[j].projection_edge = (csr->projection_edges != NULL) ?
+                                       csr->projection_edges[start + j] : 0;
+        }
+
+        qsort(slots, length, sizeof(csr_slot), compare_csr_slots);
+
+        for (j = 0; j < length; j++)
+        {
+            csr->targets[start + j] = slots[j].target;
+            csr->edge_ids[start + j] = slots[j].edge_id;
+            if (csr->projection_edges != NULL)
+            {
+                csr->projection_edges[start + j] = slots[j].projection_edge;
+            }
+        }
+    }
+
+    pfree(slots);
+}
+
+/*
+ * Helper function to turn every CSR row into a sorted set of distinct
+ * neighbors. References to the row's own vertex and parallel edges are
+ * removed, keeping the lowest edge id for each neighbor.
+ */
+void make_graph_csr_neighbor_sets(GraphCSR *csr)
+{
+    int64 write = 0;
+    int32 i;
+
+    sort_graph_csr_rows(csr);
+
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        int64 start = csr->offsets[i];
+        int64 end = csr->offsets[i + 1];
+        int32 prev = -1;
+        int64 slot;
+
+        csr->offsets[i] = write;
+
+        for (slot = start; slot < end; slot++)
+        {
+            int32 target = csr->targets[slot];
+
+            if (target == i || target == prev)
+            {
+                continue;
+            }
+
+            csr->targets[write] = target;
+            csr->edge_ids[write] = csr->edge_ids[slot];
+            if (csr->projection_edges != NULL)
+            {
+                csr->projection_edges[write] = csr->projection_edges[slot];
+            }
+            write++;
+            prev = target;
+        }
+    }
+    csr->offsets[csr->num_vertices] = write;
+    csr->num_edges = write;
+}
+
+/* qsort comparator for csr_slot, by target and then by edge id */
+static int compare_csr_slots(const void *a, const void *b)
+{
+    const csr_slot *sa = (const csr_slot *) a;
+    const csr_slot *sb = (const csr_slot *) b;
+
+    if (sa->target != sb->target)
+    {
+        return (sa->target < sb->target) ? -1 : 1;
+    }
+    if (sa->edge_id != sb->edge_id)
+    {
+        return (sa->edge_id < sb->edge_id) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Helper function to read a numeric edge property as the weight of every
+ * CSR slot. The properties come from the projection when the CSR was built
+ * from one, and are fetched from the edge label tables otherwise. It errors
+ * out on an edge without a numeric value for the property.
+ */
+float8 *get_graph_csr_edge_weights(const char *funcname, GraphCSR *csr,
+                                   const char *property)
+{
+    MemoryContext tmp_cxt;
+    MemoryContext old_cxt;
+    float8 *weights = NULL;
+    agtype_value key;
+    int64 slot;
+
+    key.type = AGTV_STRING;
+    key.val.string.val = (char *) property;
+    key.val.string.len = strlen(property);
+
+    weights = palloc_extended(sizeof(float8) * ((Size) csr->num_edges + 1),
+                              MCXT_ALLOC_HUGE);
+
+    /* the fetched properties are only needed until the weight is read */
+    tmp_cxt = AllocSetContextCreate(CurrentMemoryContext,
+                                    "age edge weights temporary cxt",
+                                    ALLOCSET_DEFAULT_SIZES);
+
+    for (slot = 0; slot < csr->num_edges; slot++)
+    {
+        agtype *props = NULL;
+        agtype_value *value = NULL;
+
+        old_cxt = MemoryContextSwitchTo(tmp_cxt);
+
+        if (csr->projection != NULL)
+        {
+            if (csr->projection->edge_properties != NULL)
+            {
+                props = DATUM_GET_AGTYPE_P(
+                    csr->projection->edge_properties[csr->projection_edges[slot]]);
+            }
+        }
+        else
+        {
+            props = DATUM_GET_AGTYPE_P(get_edge_entry_properties(
+                get_edge_entry(csr->ggctx, csr->edge_ids[slot])));
+        }
+
+        if (props != NULL)
+        {
+            value = find_agtype_value_from_container(&props->root,
+                                                     AGT_FOBJECT, &key);
+        }
+
+        if (value != NULL && value->type == AGTV_INTEGER)
+        {
+            weights[slot] = (float8) value->val.int_value;
+        }
+        else if (value != NULL && value->type == AGTV_FLOAT)
+        {
+            weights[slot] = value->val.float_value;
+        }
+        else if (value != NULL && value->type == AGTV_NUMERIC)
+        {
+            weights[slot] = DatumGetFloat8(DirectFunctionCall1(
+                numeric_float8, NumericGetDatum(value->val.numeric)));
+        }
+        else
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("%s: edge %ld does not have a numeric \"%s\" property",
+                            funcname, csr->edge_ids[slot], property)));
+        }
+
+        MemoryContextSwitchTo(old_cxt);
+        MemoryContextReset(tmp_cxt);
+
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    MemoryContextDelete(tmp_cxt);
+
+    return weights;
+}
+
+/*
+ * Helper function to check if neighbor is in the row of vertex. The rows
+ * must have been sorted with sort_graph_csr_rows.
+ */
+bool graph_csr_has_neighbor(GraphCSR *csr, int32 vertex, int32 neighbor)
+{
+    int64 low = csr->offsets[vertex];
+    int64 high = csr->offsets[vertex + 1] - 1;
+
+    while (low <= high)
+    {
+        int64 mid = low + (high - low) / 2;
+
+        if (csr->targets[mid] == neighbor)
+        {
+            return true;
+        }
+        else if (csr->targets[mid] < neighbor)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Helper function to return the dense ordinal of a vertex, or -1 if the
+ * vertex is not part of the CSR.
+ */
+int32 graph_csr_find_ordinal(GraphCSR *csr, graphid vertex_id)
+{
+    vertex_entry *ve = NULL;
+
+    if (csr->projection != NULL)
+    {
+        return graph_projection_find_ordinal(csr->projection, vertex_id);
+    }
+
+    ve = get_vertex_entry(csr->ggctx, vertex_id);
+    if (ve == NULL)
+    {
+        return -1;
+    }
+
+    return get_vertex_entry_ordinal(ve);
+}
+
+/* helper function to return an upper bound on the CSR slot count */
+static int64 count_adjacency_slots(GRAPH_global_context *ggctx,
+                                   graphid *vertex_ids, int32 num_vertices,
+                                   int direction, bool include_self_loops)
+{
+    int64 total = 0;
+    int32 i;
+
+    for (i = 0; i < num_vertices; i++)
+    {
+        vertex_entry *ve = get_vertex_entry(ggctx, vertex_ids[i]);
+
+        if (direction & CSR_DIRECTION_OUT)
+        {
+            total += get_vertex_entry_edges_out_array(ve)->size;
+        }
+        if (direction & CSR_DIRECTION_IN)
+        {
+            total += get_vertex_entry_edges_in_array(ve)->size;
+        }
+        if (include_self_loops)
+        {
+            total += get_vertex_entry_edges_self_array(ve)->size;
+        }
+    }
+
+    return total;
+}
+
+/*
+ * Helper function to resolve one adjacency array into CSR slots, starting
+ * at slot. The neighbor is the end vertex of each edge when use_end_vertex
+ * is true, otherwise it is the start vertex. Returns the next free slot.
+ */
+static int64 append_edge_slots(GraphCSR *csr, VertexEdgeArray *edges,
+                               int64 slot, bool use_end_vertex)
+{
+    int32 i;
+
+    for (i = 0; i < edges->size; i++)
+    {
+        edge_entry *ee = get_edge_entry(csr->ggctx, edges->array[i]);
+        graphid neighbor;
+        int32 target;
+
+        if (OidIsValid(csr->edge_label_table_oid) &&
+            get_edge_entry_label_table_oid(ee) != csr->edge_label_table_oid)
+        {
+            continue;
+        }
+
+        neighbor = use_end_vertex ? get_edge_entry_end_vertex_id(ee) :
+                                    get_edge_entry_start_vertex_id(ee);
+        target = graph_csr_find_ordinal(csr, neighbor);
+
+        /* a dangling edge, whose other vertex was not loaded, is left out */
+        if (target < 0)
+        {
+            continue;
+        }
+
+        csr->targets[slot] = target;
+        csr->edge_ids[slot] = edges->array[i];
+        slot++;
+    }
+
+    return slot;
+}
+
+/*
+ * Helper function to retrieve the GRAPH global context for a graph name
+ * passed to one of the graph algorithm functions. It errors out if the
+ * graph does not exist.
+ */
+GRAPH_global_context *get_graph_context_by_name(const char *funcname,
+                                                const char *graph_name)
+{
+    Oid graph_oid;
+
+    graph_oid = get_graph_oid(graph_name);
+    if (!OidIsValid(graph_oid))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_UNDEFINED_SCHEMA),
+                 errmsg("%s: graph \"%s\" does not exist", funcname,
+                        graph_name)));
+    }
+
+    /*
+     * Create or retrieve the GRAPH global context for this graph. This
+     * function will also purge off invalidated contexts.
+     */
+    return manage_GRAPH_global_contexts((char *) graph_name, graph_oid);
+}
+
+/*
+ * Helper function to resolve an edge label name to its label table oid. A
+ * NULL label name means all edge labels and returns InvalidOid.
+ */
+Oid get_edge_label_table_oid_by_name(const char *funcname, Oid graph_oid,
+                                     const char *label_name)
+{
+    label_cache_data *lcd = NULL;
+
+    if (label_name == NULL)
+    {
+        return InvalidOid;
+    }
+
+    lcd = search_label_name_graph_cache(label_name, graph_oid);
+    if (lcd == NULL)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_UNDEFINED_TABLE),
+                 errmsg("%s: label \"%s\" does not exist", funcname,
+                        label_name)));
+    }
+
+    if (lcd->kind != LABEL_KIND_EDGE)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("%s: label \"%s\" is not an edge label", funcname,
+                        label_name)));
+    }
+
+    return lcd->relation;
+}
+
+/* helper function to parse a direction argument into CSR_DIRECTION_* flags */
+int parse_csr_direction(const char *funcname, const char *direction)
+{
+    if (direction == NULL || pg_strcasecmp(direction, "both") == 0)
+    {
+        return CSR_DIRECTION_BOTH;
+    }
+    else if (pg_strcasecmp(direction, "out") == 0 ||
+             pg_strcasecmp(direction, "outgoing") == 0)
+    {
+        return CSR_DIRECTION_OUT;
+    }
+    else if (pg_strcasecmp(direction, "in") == 0 ||
+             pg_strcasecmp(direction, "incoming") == 0)
+    {
+        return CSR_DIRECTION_IN;
+    }
+
+    ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+             errmsg("%s: invalid direction \"%s\"", funcname, direction),
+             errhint("Valid directions are \"out\", \"in\", and \"both\".")));
+
+    /* keep the compiler quiet */
+    return CSR_DIRECTION_BOTH;
+}
+
+/*
+ * Helper function to extract the values of a graphid[] argument. NULL
+ * elements are skipped. The result is palloc'd and nelems is set to the
+ * number of values returned.
+ */
+graphid *get_graphid_array_values(ArrayType *array, int *nelems)
+{
+    Datum *elements = NULL;
+    bool *nulls = NULL;
+    graphid *result = NULL;
+    int16 typlen;
+    bool typbyval;
+    char typalign;
+    int count = 0;
+    int i;
+
+    if (ARR_NDIM(array) > 1)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+                 errmsg("graphid arrays must be one-dimensional")));
+    }
+
+    get_typlenbyvalalign(GRAPHIDOID, &typlen, &typbyval, &typalign);
+    deconstruct_array(array, GRAPHIDOID, typlen, typbyval, typalign,
+                      &elements, &nulls, nelems);
+
+    result = palloc(sizeof(graphid) * (*nelems + 1));
+    for (i = 0; i < *nelems; i++)
+    {
+        if (!nulls[i])
+        {
+            result[count++] = DATUM_GET_GRAPHID(elements[i]);
+        }
+    }
+    *nelems = count;
+
+    pfree_if_not_null(elements);
+    pfree_if_not_null(nulls);
+
+    return result;
+}
+
+/* helper function to build a graphid[] from an array of graphids */
+ArrayType *make_graphid_array(graphid *ids, int nelems)
+{
+    Datum *elements = NULL;
+    ArrayType *result = NULL;
+    int16 typlen;
+    bool typbyval;
+    char typalign;
+    int i;
+
+    elements = palloc(sizeof(Datum) * (nelems + 1));
+    for (i = 0; i < nelems; i++)
+    {
+        elements[i] = GRAPHID_GET_DATUM(ids[i]);
+    }
+
+    get_typlenbyvalalign(GRAPHIDOID, &typlen, &typbyval, &typalign);
+    result = construct_array(elements, nelems, GRAPHIDOID, typlen, typbyval,
+                             typalign);
+
+    pfree(elements);
+
+    return result;
+}
+
+/*
+ * Helper function to set up materialize mode for a graph algorithm SRF. It
+ * returns the tuplestore to fill and the blessed result tuple descriptor.
+ */
+Tuplestorestate *begin_graph_algorithm_srf(FunctionCallInfo fcinfo,
+                                           TupleDesc *tupdesc)
+{
+    ReturnSetInfo *rsi = (ReturnSetInfo *) fcinfo->resultinfo;
+    Tuplestorestate *tuple_store = NULL;
+    MemoryContext oldctx;
+
+    if (rsi == NULL || !IsA(rsi, ReturnSetInfo) ||
+        (rsi->allowedModes & SFRM_Materialize) == 0)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("set-valued function called in context that cannot accept a set")));
+    }
+
+    oldctx = MemoryContextSwitchTo(rsi->econtext->ecxt_per_query_memory);
+
+    if (get_call_result_type(fcinfo, NULL, tupdesc) != TYPEFUNC_COMPOSITE)
+    {
+        elog(ERROR, "return type must be a row type");
+    }
+    *tupdesc = BlessTupleDesc(CreateTupleDescCopy(*tupdesc));
+
+    tuple_store =
+        tuplestore_begin_heap(rsi->allowedModes & SFRM_Materialize_Random,
+                              false, work_mem);
+
+    rsi->returnMode = SFRM_Materialize;
+    rsi->setResult = tuple_store;
+    rsi->setDesc = *tupdesc;
+
+    MemoryContextSwitchTo(oldctx);
+
+    return tuple_store;
+}
+
+/* helper function to return a name argument as a C string, or NULL */
+char *get_name_arg_or_null(FunctionCallInfo fcinfo, int argno)
+{
+    if (PG_ARGISNULL(argno))
+    {
+        return NULL;
+    }
+
+    return NameStr(*PG_GETARG_NAME(argno));
+}
+
+/*
+ * Returns the number of parallel workers a graph algorithm should launch for
+ * the passed amount of work, which is zero below min_work, when
+ * age.graph_algorithm_workers is zero, or when we already are in parallel
+ * mode.
+ */
+int get_graph_algorithm_workers(int64 work, int64 min_work)
+{
+    if (work < min_work || IsInParallelMode())
+    {
+        return 0;
+    }
+
+    return age_graph_algorithm_workers;
+}
+
+/*
+ * Reserves room for the rows of a CSR in the DSM segment of a parallel
+ * context. Only offsets and targets are shared; the vertex and edge ids
+ * stay with the leader, which maps ordinals back to graphids.
+ */
+void estimate_graph_csr_dsm(ParallelContext *pcxt, GraphCSR *csr)
+{
+    shm_toc_estimate_chunk(&pcxt->estimator, sizeof(GraphCSRHeader));
+    shm_toc_estimate_chunk(&pcxt->estimator,
+                           sizeof(int64) * ((Size) csr->num_vertices + 1));
+    shm_toc_estimate_chunk(&pcxt->estimator,
+                           sizeof(int32) * ((Size) csr->num_edges + 1));
+    shm_toc_estimate_keys(&pcxt->estimator, 3);
+}
+
+/* copies the rows of a CSR into an initialized parallel DSM segment */
+void store_graph_csr_dsm(ParallelContext *pcxt, GraphCSR *csr)
+{
+    GraphCSRHeader *header = NULL;
+    int64 *offsets = NULL;
+    int32 *targets = NULL;
+
+    header = shm_toc_allocate(pcxt->toc, sizeof(GraphCSRHeader));
+    header->num_vertices = csr->num_vertices;
+    header->num_edges = csr->num_edges;
+    header->direction = csr->direction;
+    shm_toc_insert(pcxt->toc, CSR_KEY_HEADER, header);
+
+    offsets = shm_toc_allocate(pcxt->toc,
+                               sizeof(int64) * ((Size) csr->num_vertices + 1));
+    memcpy(offsets, csr->offsets,
+           sizeof(int64) * ((Size) csr->num_vertices + 1));
+    shm_toc_insert(pcxt->toc, CSR_KEY_OFFSETS, offsets);
+
+    targets = shm_toc_allocate(pcxt->toc,
+                               sizeof(int32) * ((Size) csr->num_edges + 1));
+    memcpy(targets, csr->targets, sizeof(int32) * (Size) csr->num_edges);
+    shm_toc_insert(pcxt->toc, CSR_KEY_TARGETS, targets);
+}
+
+/*
+ * Returns a CSR whose rows point into a parallel worker's DSM segment. Its
+ * vertex_ids and edge_ids are NULL, and it must not be freed with
+ * free_graph_csr.
+ */
+GraphCSR *attach_graph_csr_dsm(shm_toc *toc)
+{
+    GraphCSRHeader *header = shm_toc_lookup(toc, CSR_KEY_HEADER, false);
+    GraphCSR *csr = palloc0(sizeof(GraphCSR));
+
+    csr->num_vertices = header->num_vertices;
+    csr->num_edges = header->num_edges;
+    csr->direction = header->direction;
+    csr->edge_label_table_oid = InvalidOid;
+    csr->offsets = shm_toc_lookup(toc, CSR_KEY_OFFSETS, false);
+    csr->targets = shm_toc_lookup(toc, CSR_KEY_TARGETS, false);
+
+    return csr;
+}
@@ -0,0 +1,657 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Named in-memory graph projections.
+ *
+ * age_project_graph copies the vertices and edges of the selected labels
+ * out of the GRAPH global context into a compact, read-only projection,
+ * which the graph algorithm functions accept in place of a graph name.
+ * Algorithms that run on a projection only see the subgraph it holds, and
+ * build their CSR from its flat edge list instead of resolving every edge
+ * through the global graph's hash tables.
+ */
+
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
+
+#include "catalog/ag_graph.h"
+#include "catalog/ag_label.h"
+#include "utils/ag_cache.h"
+#include "utils/age_graph_csr.h"
+#include "utils/age_graph_projection.h"
+
+/* vertex_ordinals hash table entry */
+typedef struct projection_vertex_entry
+{
+    graphid vertex_id;  /* hash key */
+    int32 ordinal;
+} projection_vertex_entry;
+
+/* state of age_project_graph while it builds a projection */
+typedef struct projection_build_state
+{
+    GraphProjection *projection;
+    GRAPH_global_context *ggctx;
+    Oid *edge_label_oids;        /* selected edge labels, NULL for all */
+    int num_edge_label_oids;
+    char **keys;                 /* projected property keys, NULL for none */
+    int num_keys;
+    int64 edge_capacity;         /* allocated length of the edge arrays */
+    MemoryContext tmp_cxt;       /* reset after each property projection */
+} projection_build_state;
+
+/* the projections of this backend */
+static GraphProjection *graph_projections = NULL;
+
+static Oid *get_label_oids(const char *funcname, Oid graph_oid,
+                           ArrayType *labels, char kind, int *num_oids);
+static bool label_oid_in_list(Oid label_oid, Oid *label_oids,
+                              int num_label_oids);
+static char **get_property_keys(ArrayType *keys, int *num_keys);
+static Datum project_properties(projection_build_state *state,
+                                vertex_entry *ve, edge_entry *ee);
+static void add_projection_edge(projection_build_state *state,
+                                graphid edge_id);
+
+/* returns the projection with the passed name, or NULL if there is none */
+GraphProjection *find_graph_projection(const char *name)
+{
+    GraphProjection *curr = graph_projections;
+
+    while (curr != NULL)
+    {
+        if (strcmp(curr->name, name) == 0)
+        {
+            return curr;
+        }
+        curr = curr->next;
+    }
+
+    return NULL;
+}
+
+/*
+ * Helper function to return the ordinal of a vertex in a projection, or -1
+ * if the projection does not contain it.
+ */
+int32 graph_projection_find_ordinal(GraphProjection *projection,
+                                    graphid vertex_id)
+{
+    projection_vertex_entry *entry = NULL;
+
+    entry = hash_search(projection->vertex_ordinals, &vertex_id, HASH_FIND,
+                        NULL);
+
+    return (entry != NULL) ? entry->ordinal : -1;
+}
+
+/*
+ * Helper function to resolve a name[] of labels into label table oids. A
+ * NULL array selects every label and returns NULL.
+ */
+static Oid *get_label_oids(const char *funcname, Oid graph_oid,
+                           ArrayType *labels, char kind, int *num_oids)
+{
+    Datum *elements = NULL;
+    bool *nulls = NULL;
+    Oid *result = NULL;
+    int nelems = 0;
+    int i;
+
+    *num_oids = 0;
+
+    if (labels == NULL)
+    {
+        return NULL;
+    }
+
+    deconstruct_array(labels, NAMEOID, NAMEDATALEN, false, TYPALIGN_CHAR,
+                      &elements, &nulls, &nelems);
+
+    result = palloc(sizeof(Oid) * (nelems + 1));
+    for (i = 0; i < nelems; i++)
+    {
+        label_cache_data *lcd = NULL;
+        char *label_name = NULL;
+
+        if (nulls[i])
+        {
+            continue;
+        }
+
+        label_name = NameStr(*DatumGetName(elements[i]));
+        lcd = search_label_name_graph_cache(label_name, graph_oid);
+        if (lcd == NULL)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_UNDEFINED_TABLE),
+                     errmsg("%s: label \"%s\" does not exist", funcname,
+                            label_name)));
+        }
+        if (lcd->kind != kind)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("%s: label \"%s\" is not %s label", funcname,
+                            label_name,
+                            (kind == LABEL_KIND_VERTEX) ? "a vertex" :
+                                                          "an edge")));
+        }
+
+        result[(*num_oids)++] = lcd->relation;
+    }
+
+    pfree_if_not_null(elements);
+    pfree_if_not_null(nulls);
+
+    return result;
+}
+
+/* helper function to check a label against a label list, NULL for all */
+static bool label_oid_in_list(Oid label_oid, Oid *label_oids,
+                              int num_label_oids)
+{
+    int i;
+
+    if (label_oids == NULL)
+    {
+        return true;
+    }
+
+    for (i = 0; i < num_label_oids; i++)
+    {
+        if (label_oids[i] == label_oid)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* helper function to extract the non NULL keys of a text[] */
+static char **get_property_keys(ArrayType *keys, int *num_keys)
+{
+    Datum *elements = NULL;
+    bool *nulls = NULL;
+    char **result = NULL;
+    int nelems = 0;
+    int i;
+
+    *num_keys = 0;
+
+    if (keys == NULL)
+    {
+        return NULL;
+    }
+
+    deconstruct_array(keys, TEXTOID, -1, false, 'i', &elements, &nulls,
+                      &nelems);
+
+    result = palloc(sizeof(char *) * (nelems + 1));
+    for (i = 0; i < nelems; i++)
+    {
+        if (!nulls[i])
+        {
+            result[(*num_keys)++] = TextDatumGetCString(elements[i]);
+        }
+    }
+
+    pfree_if_not_null(elements);
+    pfree_if_not_null(nulls);
+
+    return result;
+}
+
+/*
+ * Helper function to reduce the properties of a vertex (or, when ve is NULL,
+ * an edge) to the projected keys. Keys the object does not have are left
+ * out. The result is allocated in the current memory context; the fetched
+ * properties and the intermediate values are freed with the build state's
+ * temporary context.
+ */
+static Datum project_properties(projection_build_state *state,
+                                vertex_entry *ve, edge_entry *ee)
+{
+    MemoryContext old_cxt;
+    agtype_in_state result;
+    agtype *props = NULL;
+    Datum projected;
+    int i;
+
+    old_cxt = MemoryContextSwitchTo(state->tmp_cxt);
+
+    props = DATUM_GET_AGTYPE_P((ve != NULL) ?
+                               get_vertex_entry_properties(ve) :
+                               get_edge_entry_properties(ee));
+
+    memset(&result, 0, sizeof(agtype_in_state));
+
+    result.res = push_agtype_value(&result.parse_state, WAGT_BEGIN_OBJECT,
+                                   NULL);
+
+    for (i = 0; i < state->num_keys; i++)
+    {
+        agtype_value *value = NULL;
+        agtype_value key;
+
+        key.type = AGTV_STRING;
+        key.val.string.val = state->keys[i];
+        key.val.string.len = strlen(state->keys[i]);
+
+        value = find_agtype_value_from_container(&props->root, AGT_FOBJECT,
+                                                 &key);
+        if (value == NULL)
+        {
+            continue;
+        }
+
+        result.res = push_agtype_value(&result.parse_state, WAGT_KEY, &key);
+        result.res = push_agtype_value(&result.parse_state, WAGT_VALUE,
+                                       value);
+    }
+
+    result.res = push_agtype_value(&result.parse_state, WAGT_END_OBJECT,
+                                   NULL);
+
+    projected = AGTYPE_P_GET_DATUM(agtype_value_to_agtype(result.res));
+
+    MemoryContextSwitchTo(old_cxt);
+
+    projected = datumCopy(projected, false, -1);
+    MemoryContextReset(state->tmp_cxt);
+
+    return projected;
+}
+
+/*
+ * Helper function to add an edge to a projection, if its label is selected
+ * and both of its endpoints are in the projection. Called once per edge,
+ * from the out-edges and self loops of its start vertex.
+ */
+static void add_projection_edge(projection_build_state *state,
+                                graphid edge_id)
+{
+    GraphProjection *projection = state->projection;
+    edge_entry *ee = get_edge_entry(state->ggctx, edge_id);
+    Oid label_oid = get_edge_entry_label_table_oid(ee);
+    int32 start;
+    int32 end;
+    int64 n;
+
+    if (!label_oid_in_list(label_oid, state->edge_label_oids,
+                           state->num_edge_label_oids))
+    {
+        return;
+    }
+
+    start = graph_projection_find_ordinal(projection,
+                                          get_edge_entry_start_vertex_id(ee));
+    end = graph_projection_find_ordinal(projection,
+                                        get_edge_entry_end_vertex_id(ee));
+    if (start < 0 || end < 0)
+    {
+        return;
+    }
+
+    n = projection->num_edges;
+    if (n == state->edge_capacity)
+    {
+        Size capacity = state->edge_capacity * 2;
+
+        projection->edge_ids = repalloc_huge(projection->edge_ids,
+                                             sizeof(graphid) * capacity);
+        projection->edge_label_oids =
+            repalloc_huge(projection->edge_label_oids, sizeof(Oid) * capacity);
+        projection->edge_starts = repalloc_huge(projection->edge_starts,
+                                                sizeof(int32) * capacity);
+        projection->edge_ends = repalloc_huge(projection->edge_ends,
+                                              sizeof(int32) * capacity);
+        if (projection->edge_properties != NULL)
+        {
+            projection->edge_properties =
+                repalloc_huge(projection->edge_properties,
+                              sizeof(Datum) * capacity);
+        }
+
+        state->edge_capacity = capacity;
+    }
+
+    projection->edge_ids[n] = edge_id;
+    projection->edge_label_oids[n] = label_oid;
+    projection->edge_starts[n] = start;
+    projection->edge_ends[n] = end;
+    if (projection->edge_properties != NULL)
+    {
+        projection->edge_properties[n] = project_properties(state, NULL, ee);
+    }
+    projection->num_edges++;
+}
+
+PG_FUNCTION_INFO_V1(age_project_graph);
+
+/*
+ * age_project_graph(projection_name, graph_name, vertex_labels, edge_labels,
+ *                   property_keys)
+ *
+ * Builds a named projection of a graph, holding the vertices of
+ * vertex_labels and the edges of edge_labels between them. NULL label
+ * arrays select every label. When property_keys is passed, the projection
+ * keeps those properties of each vertex and edge. Returns the number of
+ * vertices and edges projected.
+ */
+Datum age_project_graph(PG_FUNCTION_ARGS)
+{
+    projection_build_state state;
+    GraphProjection *projection = NULL;
+    MemoryContext projection_cxt;
+    MemoryContext old_cxt;
+    TupleDesc tupdesc;
+    HASHCTL ctl;
+    GraphIdNode *curr = NULL;
+    char *name = NULL;
+    char *graph_name = NULL;
+    Oid *vertex_label_oids = NULL;
+    int num_vertex_label_oids = 0;
+    int64 num_graph_vertices;
+    int32 i;
+    Datum values[2];
+    bool nulls[2] = {false, false};
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("project_graph: projection name cannot be NULL")));
+    }
+    if (PG_ARGISNULL(1))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("project_graph: graph name cannot be NULL")));
+    }
+
+    name = NameStr(*PG_GETARG_NAME(0));
+    graph_name = NameStr(*PG_GETARG_NAME(1));
+
+    if (find_graph_projection(name) != NULL)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_DUPLICATE_OBJECT),
+                 errmsg("project_graph: projection \"%s\" already exists",
+                        name)));
+    }
+
+    /* the graph algorithm functions take the name of either */
+    if (OidIsValid(get_graph_oid(name)))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_DUPLICATE_OBJECT),
+                 errmsg("project_graph: graph \"%s\" already exists", name),
+                 errhint("A projection cannot have the name of a graph.")));
+    }
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+    {
+        elog(ERROR, "return type must be a row type");
+    }
+
+    MemSet(&state, 0, sizeof(state));
+    state.ggctx = get_graph_context_by_name("project_graph", graph_name);
+
+    vertex_label_oids = get_label_oids("project_graph",
+                                       get_graph_context_oid(state.ggctx),
+                                       PG_ARGISNULL(2) ? NULL :
+                                       PG_GETARG_ARRAYTYPE_P(2),
+                                       LABEL_KIND_VERTEX,
+                                       &num_vertex_label_oids);
+    state.edge_label_oids = get_label_oids("project_graph",
+                                           get_graph_context_oid(state.ggctx),
+                                           PG_ARGISNULL(3) ? NULL :
+                                           PG_GETARG_ARRAYTYPE_P(3),
+                                           LABEL_KIND_EDGE,
+                                           &state.num_edge_label_oids);
+    state.keys = get_property_keys(PG_ARGISNULL(4) ? NULL :
+                                   PG_GETARG_ARRAYTYPE_P(4),
+                                   &state.num_keys);
+
+    /*
+     * Build the projection in a context under the current one, so that it
+     * goes away if we error out, and only move it under TopMemoryContext
+     * once it is complete.
+     */
+    projection_cxt = AllocSetContextCreate(CurrentMemoryContext,
+                                           "age graph projection",
+                                           ALLOCSET_DEFAULT_SIZES);
+    state.tmp_cxt = AllocSetContextCreate(CurrentMemoryContext,
+                                          "age graph projection temporary cxt",
+                                          ALLOCSET_DEFAULT_SIZES);
+    old_cxt = MemoryContextSwitchTo(projection_cxt);
+
+    projection = palloc0(sizeof(GraphProjection));
+    projection->name = pstrdup(name);
+    projection->graph_name = pstrdup(graph_name);
+    projection->graph_oid = get_graph_context_oid(state.ggctx);
+    projection->context = projection_cxt;
+    state.projection = projection;
+
+    num_graph_vertices = get_graph_num_loaded_vertices(state.ggctx);
+    projection->vertex_ids = palloc_extended(sizeof(graphid) *
+                                             (num_graph_vertices + 1),
+                                             MCXT_ALLOC_HUGE);
+    projection->vertex_label_oids = palloc_extended(sizeof(Oid) *
+                                                    (num_graph_vertices + 1),
+                                                    MCXT_ALLOC_HUGE);
+    if (state.keys != NULL)
+    {
+        projection->vertex_properties =
+            palloc_extended(sizeof(Datum) * (num_graph_vertices + 1),
+                            MCXT_ALLOC_HUGE);
+    }
+
+    MemSet(&ctl, 0, sizeof(ctl));
+    ctl.keysize = sizeof(graphid);
+    ctl.entrysize = sizeof(projection_vertex_entry);
+    ctl.hash = graphid_hash;
+    ctl.hcxt = projection_cxt;
+    projection->vertex_ordinals =
+        hash_create("age graph projection vertices",
+                    Max(num_graph_vertices, 16), &ctl,
+                    HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+    /* project the vertices, in load order */
+    curr = peek_stack_head(get_graph_vertices(state.ggctx));
+    while (curr != NULL)
+    {
+        graphid vertex_id = get_graphid(curr);
+        vertex_entry *ve = get_vertex_entry(state.ggctx, vertex_id);
+        Oid label_oid = get_vertex_entry_label_table_oid(ve);
+        projection_vertex_entry *entry = NULL;
+
+        curr = next_GraphIdNode(curr);
+
+        if (!label_oid_in_list(label_oid, vertex_label_oids,
+                               num_vertex_label_oids))
+        {
+            continue;
+        }
+
+        i = projection->num_vertices++;
+        projection->vertex_ids[i] = vertex_id;
+        projection->vertex_label_oids[i] = label_oid;
+        if (state.keys != NULL)
+        {
+            projection->vertex_properties[i] =
+                project_properties(&state, ve, NULL);
+        }
+
+        entry = hash_search(projection->vertex_ordinals, &vertex_id,
+                            HASH_ENTER, NULL);
+        entry->ordinal = i;
+
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    /* project the edges between them */
+    state.edge_capacity = 1024;
+    projection->edge_ids = palloc_extended(sizeof(graphid) *
+                                           state.edge_capacity,
+                                           MCXT_ALLOC_HUGE);
+    projection->edge_label_oids = palloc_extended(sizeof(Oid) *
+                                                  state.edge_capacity,
+                                                  MCXT_ALLOC_HUGE);
+    projection->edge_starts = palloc_extended(sizeof(int32) *
+                                              state.edge_capacity,
+                                              MCXT_ALLOC_HUGE);
+    projection->edge_ends = palloc_extended(sizeof(int32) *
+                                            state.edge_capacity,
+                                            MCXT_ALLOC_HUGE);
+    if (state.keys != NULL)
+    {
+        projection->edge_properties =
+            palloc_extended(sizeof(Datum) * state.edge_capacity,
+                            MCXT_ALLOC_HUGE);
+    }
+
+    for (i = 0; i < projection->num_vertices; i++)
+    {
+        vertex_entry *ve = get_vertex_entry(state.ggctx,
+                                            projection->vertex_ids[i]);
+        VertexEdgeArray *edges = NULL;
+        int32 j;
+
+        edges = get_vertex_entry_edges_out_array(ve);
+        for (j = 0; j < edges->size; j++)
+        {
+            add_projection_edge(&state, edges->array[j]);
+        }
+
+        edges = get_vertex_entry_edges_self_array(ve);
+        for (j = 0; j < edges->size; j++)
+        {
+            add_projection_edge(&state, edges->array[j]);
+        }
+
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    MemoryContextSwitchTo(old_cxt);
+    MemoryContextDelete(state.tmp_cxt);
+
+    /* the projection is complete, keep it for the rest of the session */
+    MemoryContextSetParent(projection_cxt, TopMemoryContext);
+    projection->next = graph_projections;
+    graph_projections = projection;
+
+    values[0] = Int64GetDatum(projection->num_vertices);
+    values[1] = Int64GetDatum(projection->num_edges);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(BlessTupleDesc(tupdesc),
+                                                      values, nulls)));
+}
+
+PG_FUNCTION_INFO_V1(age_drop_projection);
+
+/*
+ * age_drop_projection(projection_name)
+ *
+ * Frees a projection. Returns false if there was no such projection.
+ */
+Datum age_drop_projection(PG_FUNCTION_ARGS)
+{
+    GraphProjection *prev = NULL;
+    GraphProjection *curr = graph_projections;
+    char *name = NULL;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("drop_projection: projection name cannot be NULL")));
+    }
+
+    name = NameStr(*PG_GETARG_NAME(0));
+
+    while (curr != NULL)
+    {
+        if (strcmp(curr->name, name) == 0)
+        {
+            if (prev == NULL)
+            {
+                graph_projections = curr->next;
+            }
+            else
+            {
+                prev->next = curr->next;
+            }
+
+            MemoryContextDelete(curr->context);
+
+            PG_RETURN_BOOL(true);
+        }
+
+        prev = curr;
+        curr = curr->next;
+    }
+
+    PG_RETURN_BOOL(false);
+}
+
+PG_FUNCTION_INFO_V1(age_projections);
+
+/*
+ * age_projections()
+ *
+ * Lists the projections of this backend.
+ */
+Datum age_projections(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphProjection *curr = NULL;
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    for (curr = graph_projections; curr != NULL; curr = curr->next)
+    {
+        Datum values[4];
+        bool nulls[4] = {false, false, false, false};
+        NameData name;
+        NameData graph_name;
+
+        namestrcpy(&name, curr->name);
+        namestrcpy(&graph_name, curr->graph_name);
+
+        values[0] = NameGetDatum(&name);
+        values[1] = NameGetDatum(&graph_name);
+        values[2] = Int64GetDatum(curr->num_vertices);
+        values[3] = Int64GetDatum(curr->num_edges);
+
+        tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+    }
+
+    PG_RETURN_NULL();
+}
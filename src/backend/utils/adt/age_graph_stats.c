@@ -0,0 +1,545 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Graph statistics.
+ *
+ * age_analyze_graph() walks the graph's global context once and records the
+ * number of entities of every label and, for every edge label and direction,
+ * the degree distribution of the vertices of every vertex label. The default
+ * labels stand for all labels of their kind, so that MATCH (n)-[e]->() finds
+ * statistics too.
+ *
+ * graphid_eqjoinsel() is the join selectivity estimator of graphid '='. For
+ * the start_id/end_id = id joins between an edge label and a vertex label that
+ * transform_match_entities() generates, the selectivity is the fraction of
+ * the (edge, vertex) pairs that are connected:
+ *
+ *     edges of the edge label incident to the vertex label
+ *     -----------------------------------------------------
+ *     edges of the edge label * vertices of the vertex label
+ *
+ * This is exact for the whole labels where the generic estimate relies on a
+ * sampled ndistinct of start_id/end_id, which is far off for skewed degree
+ * distributions, and it knows when an edge label does not reach a vertex
+ * label at all. Any other join, or one on labels that were not analyzed,
+ * falls back to eqjoinsel().
+ */
+
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/genam.h"
+#include "access/htup_details.h"
+#include "access/table.h"
+#include "catalog/indexing.h"
+#include "nodes/pathnodes.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
+#include "utils/hsearch.h"
+#include "utils/selfuncs.h"
+
+#include "catalog/ag_graph.h"
+#include "catalog/ag_label.h"
+#include "catalog/ag_label_stats.h"
+#include "commands/label_commands.h"
+#include "utils/ag_cache.h"
+#include "utils/age_global_graph.h"
+#include "utils/age_graph_csr.h"
+#include "utils/graphid.h"
+
+/* one (edge label, direction, vertex label) degree distribution */
+typedef struct degree_stats_key
+{
+    int32 edge_label;
+    int32 vertex_label;
+    int32 direction;
+} degree_stats_key;
+
+typedef struct degree_stats_entry
+{
+    degree_stats_key key;
+    int64 edge_count;
+    int64 *degrees;     /* degrees of the vertices with at least one edge */
+    int64 num_degrees;
+    int64 capacity;
+} degree_stats_entry;
+
+/* state of one age_analyze_graph() run */
+typedef struct graph_stats_state
+{
+    int32 default_vertex_label;
+    int32 default_edge_label;
+    int64 *label_counts;        /* indexed by label id */
+    int32 *vertex_degrees;      /* scratch, indexed by edge label id */
+    int32 *touched_labels;      /* edge labels seen at the current vertex */
+    HTAB *degrees;
+} graph_stats_state;
+
+static void count_vertex_degrees(graph_stats_state *state, int32 vertex_label,
+                                 VertexEdgeArray *edges,
+                                 VertexEdgeArray *self_edges,
+                                 char direction, bool count_edges);
+static void add_degree(graph_stats_state *state, int32 edge_label,
+                       char direction, int32 vertex_label, int64 degree);
+static void store_graph_stats(graph_stats_state *state, Oid graph_oid);
+static float8 degree_percentile(int64 *degrees, int64 n, float8 fraction);
+static int compare_degrees(const void *a, const void *b);
+static bool get_graph_join_selectivity(PlannerInfo *root, List *args,
+                                       Selectivity *selectivity);
+static label_cache_data *get_var_label(PlannerInfo *root, Node *node,
+                                       AttrNumber *attno);
+
+PG_FUNCTION_INFO_V1(age_analyze_graph);
+
+/*
+ * age_analyze_graph(graph_name)
+ *
+ * Replaces the graph's rows in ag_catalog.ag_label_stats and
+ * ag_catalog.ag_degree_stats with statistics of the graph as it is now.
+ */
+Datum age_analyze_graph(PG_FUNCTION_ARGS)
+{
+    GRAPH_global_context *ggctx;
+    graph_stats_state state;
+    GraphIdNode *curr;
+    HASHCTL ctl;
+    char *graph_name;
+    Oid graph_oid;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("age_analyze_graph: graph name can not be NULL")));
+    }
+    graph_name = NameStr(*PG_GETARG_NAME(0));
+
+    ggctx = get_graph_context_by_name("age_analyze_graph", graph_name);
+    graph_oid = get_graph_context_oid(ggctx);
+
+    state.default_vertex_label = get_label_id(AG_DEFAULT_LABEL_VERTEX,
+                                              graph_oid);
+    state.default_edge_label = get_label_id(AG_DEFAULT_LABEL_EDGE, graph_oid);
+    state.label_counts = palloc0(sizeof(int64) * (LABEL_ID_MAX + 1));
+    state.vertex_degrees = palloc0(sizeof(int32) * (LABEL_ID_MAX + 1));
+    state.touched_labels = palloc(sizeof(int32) * (LABEL_ID_MAX + 1));
+
+    MemSet(&ctl, 0, sizeof(ctl));
+    ctl.keysize = sizeof(degree_stats_key);
+    ctl.entrysize = sizeof(degree_stats_entry);
+    ctl.hcxt = CurrentMemoryContext;
+    state.degrees = hash_create("age_analyze_graph degrees", 64, &ctl,
+                                HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+    for (curr = peek_stack_head(get_graph_vertices(ggctx)); curr != NULL;
+         curr = next_GraphIdNode(curr))
+    {
+        graphid vertex_id = get_graphid(curr);
+        int32 vertex_label = get_graphid_label_id(vertex_id);
+        vertex_entry *ve = get_vertex_entry(ggctx, vertex_id);
+        VertexEdgeArray *self_edges = get_vertex_entry_edges_self_array(ve);
+
+        state.label_counts[vertex_label]++;
+        if (vertex_label != state.default_vertex_label)
+        {
+            state.label_counts[state.default_vertex_label]++;
+        }
+
+        /*
+         * Every edge is in the out-edges of its start vertex or, for a self
+         * loop, in the self edges of it, so edges are counted on the way out.
+         * A self loop adds to both the out-degree and the in-degree.
+         */
+        count_vertex_degrees(&state, vertex_label,
+                             get_vertex_entry_edges_out_array(ve), self_edges,
+                             DEGREE_STATS_OUT, true);
+        count_vertex_degrees(&state, vertex_label,
+                             get_vertex_entry_edges_in_array(ve), self_edges,
+                             DEGREE_STATS_IN, false);
+    }
+
+    store_graph_stats(&state, graph_oid);
+
+    hash_destroy(state.degrees);
+    pfree(state.label_counts);
+    pfree(state.vertex_degrees);
+    pfree(state.touched_labels);
+
+    PG_RETURN_VOID();
+}
+
+/*
+ * Counts the edges of one vertex in one direction per edge label and adds
+ * the degrees to the distributions of the vertex's label and of all vertices,
+ * for the edge label and for all edges.
+ */
+static void count_vertex_degrees(graph_stats_state *state, int32 vertex_label,
+                                 VertexEdgeArray *edges,
+                                 VertexEdgeArray *self_edges,
+                                 char direction, bool count_edges)
+{
+    VertexEdgeArray *arrays[2] = {edges, self_edges};
+    int32 num_touched = 0;
+    int64 total = 0;
+    int a;
+    int32 i;
+
+    for (a = 0; a < 2; a++)
+    {
+        for (i = 0; i < arrays[a]->size; i++)
+        {
+            int32 edge_label = get_graphid_label_id(arrays[a]->array[i]);
+
+            if (state->vertex_degrees[edge_label] == 0)
+            {
+                state->touched_labels[num_touched++] = edge_label;
+            }
+            state->vertex_degrees[edge_label]++;
+            total++;
+        }
+    }
+
+    if (total == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < num_touched; i++)
+    {
+        int32 edge_label = state->touched_labels[i];
+        int64 degree = state->vertex_degrees[edge_label];
+
+        state->vertex_degrees[edge_label] = 0;
+
+        /* the default label's own edges only count toward all edges */
+        if (edge_label == state->default_edge_label)
+        {
+            continue;
+        }
+
+        if (count_edges)
+        {
+            state->label_counts[edge_label] += degree;
+        }
+
+        if (vertex_label != state->default_vertex_label)
+        {
+            add_degree(state, edge_label, direction, vertex_label, degree);
+        }
+        add_degree(state, edge_label, direction,
+                   state->default_vertex_label, degree);
+    }
+
+    if (count_edges)
+    {
+        state->label_counts[state->default_edge_label] += total;
+    }
+
+    if (vertex_label != state->default_vertex_label)
+    {
+        add_degree(state, state->default_edge_label, direction, vertex_label,
+                   total);
+    }
+    add_degree(state, state->default_edge_label, direction,
+               state->default_vertex_label, total);
+}
+
+/* appends a vertex's degree to a distribution */
+static void add_degree(graph_stats_state *state, int32 edge_label,
+                       char direction, int32 vertex_label, int64 degree)
+{
+    degree_stats_key key;
+    degree_stats_entry *entry;
+    bool found;
+
+    key.edge_label = edge_label;
+    key.vertex_label = vertex_label;
+    key.direction = direction;
+
+    entry = (degree_stats_entry *) hash_search(state->degrees, &key,
+                                               HASH_ENTER, &found);
+    if (!found)
+    {
+        entry->edge_count = 0;
+        entry->num_degrees = 0;
+        entry->capacity = 16;
+        entry->degrees = palloc(sizeof(int64) * entry->capacity);
+    }
+    else if (entry->num_degrees == entry->capacity)
+    {
+        entry->capacity *= 2;
+        entry->degrees = repalloc_huge(entry->degrees,
+                                       sizeof(int64) * entry->capacity);
+    }
+
+    entry->degrees[entry->num_degrees++] = degree;
+    entry->edge_count += degree;
+}
+
+/*
+ * Replaces the graph's statistics rows. Every label gets a row count, even
+ * an empty one, so the planner can tell an empty label from one that was
+ * not analyzed.
+ */
+static void store_graph_stats(graph_stats_state *state, Oid graph_oid)
+{
+    ScanKeyData scan_keys[1];
+    Relation ag_label;
+    SysScanDesc scan_desc;
+    HeapTuple tuple;
+    HASH_SEQ_STATUS seq;
+    degree_stats_entry *entry;
+
+    delete_graph_stats(graph_oid);
+
+    ScanKeyInit(&scan_keys[0], Anum_ag_label_graph, BTEqualStrategyNumber,
+                F_OIDEQ, ObjectIdGetDatum(graph_oid));
+
+    ag_label = table_open(ag_label_relation_id(), AccessShareLock);
+    scan_desc = systable_beginscan(ag_label, ag_label_graph_oid_index_id(),
+                                   true, NULL, 1, scan_keys);
+
+    while (HeapTupleIsValid(tuple = systable_getnext(scan_desc)))
+    {
+        bool isnull;
+        int32 label_id = DatumGetInt32(heap_getattr(tuple, Anum_ag_label_id,
+                                                    RelationGetDescr(ag_label),
+                                                    &isnull));
+
+        insert_label_stats(graph_oid, label_id,
+                           state->label_counts[label_id]);
+    }
+
+    systable_endscan(scan_desc);
+    table_close(ag_label, AccessShareLock);
+
+    hash_seq_init(&seq, state->degrees);
+    while ((entry = (degree_stats_entry *) hash_seq_search(&seq)) != NULL)
+    {
+        degree_stats stats;
+        int64 n = entry->num_degrees;
+
+        qsort(entry->degrees, n, sizeof(int64), compare_degrees);
+
+        stats.edge_count = entry->edge_count;
+        stats.vertex_count = n;
+        stats.avg_degree = (float8) entry->edge_count / n;
+        stats.p50_degree = degree_percentile(entry->degrees, n, 0.5);
+        stats.p90_degree = degree_percentile(entry->degrees, n, 0.9);
+        stats.p99_degree = degree_percentile(entry->degrees, n, 0.99);
+        stats.max_degree = entry->degrees[n - 1];
+
+        insert_degree_stats(graph_oid, entry->key.edge_label,
+                            (char) entry->key.direction,
+                            entry->key.vertex_label, &stats);
+
+        pfree(entry->degrees);
+    }
+
+    CommandCounterIncrement();
+}
+
+/* interpolated percentile of sorted degrees, like percentile_cont() */
+static float8 degree_percentile(int64 *degrees, int64 n, float8 fraction)
+{
+    float8 position = fraction * (n - 1);
+    int64 lower = (int64) floor(position);
+    int64 upper = (int64) ceil(position);
+
+    return degrees[lower] +
+           (position - lower) * (degrees[upper] - degrees[lower]);
+}
+
+static int compare_degrees(const void *a, const void *b)
+{
+    int64 da = *(const int64 *) a;
+    int64 db = *(const int64 *) b;
+
+    if (da != db)
+    {
+        return (da < db) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+PG_FUNCTION_INFO_V1(graphid_eqjoinsel);
+
+/*
+ * Join selectivity of graphid '='. See the top of this file.
+ */
+Datum graphid_eqjoinsel(PG_FUNCTION_ARGS)
+{
+    PlannerInfo *root = (PlannerInfo *) PG_GETARG_POINTER(0);
+    List *args = (List *) PG_GETARG_POINTER(2);
+    JoinType jointype = (JoinType) PG_GETARG_INT16(3);
+    Selectivity selectivity;
+
+    /*
+     * The estimate is the fraction of matching pairs, which is what inner
+     * and outer joins need. Semi and anti joins count the matched rows of
+     * one side only and are left to eqjoinsel().
+     */
+    if ((jointype == JOIN_INNER || jointype == JOIN_LEFT ||
+         jointype == JOIN_FULL) &&
+        get_graph_join_selectivity(root, args, &selectivity))
+    {
+        PG_RETURN_FLOAT8((float8) selectivity);
+    }
+
+    return DirectFunctionCall5Coll(eqjoinsel, PG_GET_COLLATION(),
+                                   PG_GETARG_DATUM(0), PG_GETARG_DATUM(1),
+                                   PG_GETARG_DATUM(2), PG_GETARG_DATUM(3),
+                                   PG_GETARG_DATUM(4));
+}
+
+/*
+ * Estimates the selectivity of an edge start_id/end_id = vertex id join from
+ * the graph statistics. Returns false if the clause is not such a join or
+ * the labels have not been analyzed.
+ */
+static bool get_graph_join_selectivity(PlannerInfo *root, List *args,
+                                       Selectivity *selectivity)
+{
+    label_cache_data *left_label;
+    label_cache_data *right_label;
+    label_cache_data *edge_label;
+    label_cache_data *vertex_label;
+    AttrNumber left_attno;
+    AttrNumber right_attno;
+    AttrNumber edge_attno;
+    AttrNumber vertex_attno;
+    degree_stats stats;
+    int64 edge_rows;
+    int64 vertex_rows;
+    char direction;
+
+    if (list_length(args) != 2)
+    {
+        return false;
+    }
+
+    left_label = get_var_label(root, linitial(args), &left_attno);
+    right_label = get_var_label(root, lsecond(args), &right_attno);
+    if (left_label == NULL || right_label == NULL ||
+        left_label->graph != right_label->graph)
+    {
+        return false;
+    }
+
+    if (left_label->kind == LABEL_KIND_EDGE &&
+        right_label->kind == LABEL_KIND_VERTEX)
+    {
+        edge_label = left_label;
+        edge_attno = left_attno;
+        vertex_label = right_label;
+        vertex_attno = right_attno;
+    }
+    else if (left_label->kind == LABEL_KIND_VERTEX &&
+             right_label->kind == LABEL_KIND_EDGE)
+    {
+        edge_label = right_label;
+        edge_attno = right_attno;
+        vertex_label = left_label;
+        vertex_attno = left_attno;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (vertex_attno != Anum_ag_label_vertex_table_id)
+    {
+        return false;
+    }
+
+    if (edge_attno == Anum_ag_label_edge_table_start_id)
+    {
+        direction = DEGREE_STATS_OUT;
+    }
+    else if (edge_attno == Anum_ag_label_edge_table_end_id)
+    {
+        direction = DEGREE_STATS_IN;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (!get_label_stats(edge_label->graph, edge_label->id, &edge_rows) ||
+        !get_label_stats(vertex_label->graph, vertex_label->id,
+                         &vertex_rows) ||
+        edge_rows == 0 || vertex_rows == 0)
+    {
+        return false;
+    }
+
+    /* no row means no edge of the edge label reaches the vertex label */
+    if (!get_degree_stats(edge_label->graph, edge_label->id, direction,
+                          vertex_label->id, &stats))
+    {
+        stats.edge_count = 0;
+    }
+
+    /* keep a pessimistic row, as the generic estimators do */
+    *selectivity = (Selectivity) Max(stats.edge_count, 1) /
+                   ((float8) edge_rows * (float8) vertex_rows);
+    CLAMP_PROBABILITY(*selectivity);
+
+    return true;
+}
+
+/*
+ * Returns the label of the table a plain column reference belongs to, or
+ * NULL if node is something else.
+ */
+static label_cache_data *get_var_label(PlannerInfo *root, Node *node,
+                                       AttrNumber *attno)
+{
+    RangeTblEntry *rte;
+    Var *var;
+
+    if (IsA(node, RelabelType))
+    {
+        node = (Node *) ((RelabelType *) node)->arg;
+    }
+
+    if (!IsA(node, Var))
+    {
+        return NULL;
+    }
+
+    var = (Var *) node;
+    if (var->varlevelsup != 0 || var->varno <= 0 ||
+        var->varno >= root->simple_rel_array_size)
+    {
+        return NULL;
+    }
+
+    rte = root->simple_rte_array[var->varno];
+    if (rte == NULL || rte->rtekind != RTE_RELATION)
+    {
+        return NULL;
+    }
+
+    *attno = var->varattno;
+
+    return search_label_relation_cache(rte->relid);
+}
@@ -0,0 +1,467 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Label propagation community detection.
+ *
+ * Every vertex starts in its own community and repeatedly adopts the label
+ * that is most frequent among its neighbors, until a full pass changes no
+ * label or max_iter passes have run. Labels are updated in place
+ * (asynchronous propagation), which converges faster than the synchronous
+ * variant and does not oscillate on bipartite structures.
+ *
+ * On large graphs the passes are split across parallel background workers.
+ * The CSR rows and the label array are copied into the parallel DSM segment
+ * and each participant claims fixed size chunks of vertices from a shared
+ * counter. Labels are read and written with atomics, so participants see
+ * each other's updates as soon as they are made, just as a single backend
+ * would. A barrier separates the passes and one elected participant decides
+ * whether another pass is needed.
+ */
+
+#include "postgres.h"
+
+#include "access/parallel.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/barrier.h"
+#include "utils/builtins.h"
+#include "utils/wait_event.h"
+
+#include "utils/age_graph_csr.h"
+
+/* shm_toc keys of the label propagation parallel DSM segment */
+#define LP_KEY_SHARED UINT64CONST(0xA6E0000000000001)
+#define LP_KEY_LABELS UINT64CONST(0xA6E0000000000002)
+
+/* number of vertices a participant claims at a time */
+#define LP_CHUNK_SIZE 4096
+
+/*
+ * Below this many adjacency slots the cost of starting workers and copying
+ * the CSR into DSM outweighs the work, so the leader runs alone.
+ */
+#define LP_MIN_PARALLEL_EDGES 1000000
+
+/* label propagation state shared by all participants */
+typedef struct LabelPropagationShared
+{
+    int32 num_vertices;
+    int32 max_degree;
+    int32 max_iter;
+    int32 iterations;          /* completed passes */
+    bool done;                 /* set by the participant ending the last pass */
+    Barrier barrier;           /* separates the passes */
+    pg_atomic_uint32 next_chunk;
+    pg_atomic_uint64 changed;  /* labels changed during the current pass */
+} LabelPropagationShared;
+
+/* one participant's view of the label propagation state */
+typedef struct LabelPropagationState
+{
+    LabelPropagationShared *shared;
+    int64 *offsets;
+    int32 *targets;
+    pg_atomic_uint32 *labels;
+    int32 *scratch;            /* max_degree neighbor labels */
+} LabelPropagationState;
+
+PGDLLEXPORT void age_label_propagation_worker(dsm_segment *seg, shm_toc *toc);
+
+static void init_label_propagation_shared(LabelPropagationShared *shared,
+                                          GraphCSR *csr, int32 max_iter);
+static void label_propagation_participate(LabelPropagationState *lps,
+                                          bool parallel);
+static bool label_propagation_update_vertex(LabelPropagationState *lps,
+                                            int32 vertex);
+static void label_propagation_end_pass(LabelPropagationShared *shared);
+static int32 *run_label_propagation(GraphCSR *csr, int32 max_iter);
+static int compare_int32s(const void *a, const void *b);
+
+/* qsort comparator for int32 labels */
+static int compare_int32s(const void *a, const void *b)
+{
+    int32 la = *(const int32 *) a;
+    int32 lb = *(const int32 *) b;
+
+    return (la > lb) - (la < lb);
+}
+
+static void init_label_propagation_shared(LabelPropagationShared *shared,
+                                          GraphCSR *csr, int32 max_iter)
+{
+    int32 max_degree = 0;
+    int32 i;
+
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        int64 degree = csr->offsets[i + 1] - csr->offsets[i];
+
+        if (degree > max_degree)
+        {
+            max_degree = (int32) degree;
+        }
+    }
+
+    shared->num_vertices = csr->num_vertices;
+    shared->max_degree = max_degree;
+    shared->max_iter = max_iter;
+    shared->iterations = 0;
+    shared->done = (max_iter == 0 || csr->num_vertices == 0);
+    BarrierInit(&shared->barrier, 0);
+    pg_atomic_init_u32(&shared->next_chunk, 0);
+    pg_atomic_init_u64(&shared->changed, 0);
+}
+
+/*
+ * Moves a vertex to the most frequent label among its neighbors. The vertex
+ * keeps its current label when that label is one of the most frequent ones,
+ * otherwise the smallest of the most frequent labels wins, so a pass over
+ * the same labels always makes the same choice. Returns true if the label
+ * changed.
+ */
+static bool label_propagation_update_vertex(LabelPropagationState *lps,
+                                            int32 vertex)
+{
+    int64 start = lps->offsets[vertex];
+    int32 degree = (int32) (lps->offsets[vertex + 1] - start);
+    int32 current;
+    int32 best_label = -1;
+    int32 best_count = 0;
+    int32 current_count = 0;
+    int32 i;
+
+    if (degree == 0)
+    {
+        return false;
+    }
+
+    for (i = 0; i < degree; i++)
+    {
+        lps->scratch[i] =
+            (int32) pg_atomic_read_u32(&lps->labels[lps->targets[start + i]]);
+    }
+    qsort(lps->scratch, degree, sizeof(int32), compare_int32s);
+
+    current = (int32) pg_atomic_read_u32(&lps->labels[vertex]);
+
+    i = 0;
+    while (i < degree)
+    {
+        int32 label = lps->scratch[i];
+        int32 count = 0;
+
+        while (i < degree && lps->scratch[i] == label)
+        {
+            count++;
+            i++;
+        }
+
+        if (label == current)
+        {
+            current_count = count;
+        }
+        /* labels are ascending, so ties keep the smallest label */
+        if (count > best_count)
+        {
+            best_label = label;
+            best_count = count;
+        }
+    }
+
+    if (current_count == best_count)
+    {
+        return false;
+    }
+
+    pg_atomic_write_u32(&lps->labels[vertex], (uint32) best_label);
+
+    return true;
+}
+
+/*
+ * Called by exactly one participant once every participant has finished the
+ * current pass.
+ */
+static void label_propagation_end_pass(LabelPropagationShared *shared)
+{
+    shared->iterations++;
+
+    if (pg_atomic_read_u64(&shared->changed) == 0 ||
+        shared->iterations >= shared->max_iter)
+    {
+        shared->done = true;
+    }
+
+    pg_atomic_write_u32(&shared->next_chunk, 0);
+    pg_atomic_write_u64(&shared->changed, 0);
+}
+
+/*
+ * Runs label propagation passes until the shared state says it is done.
+ *
+ * Barrier phases alternate between passes (even) and the decision to run
+ * another pass (odd). Workers may attach at any point, so a participant
+ * that arrives during a decision phase waits for it before looking at the
+ * done flag.
+ */
+static void label_propagation_participate(LabelPropagationState *lps,
+                                          bool parallel)
+{
+    LabelPropagationShared *shared = lps->shared;
+    uint32 num_chunks;
+
+    num_chunks = (shared->num_vertices + LP_CHUNK_SIZE - 1) / LP_CHUNK_SIZE;
+
+    if (parallel)
+    {
+        int phase = BarrierAttach(&shared->barrier);
+
+        if (phase % 2 == 1)
+        {
+            BarrierArriveAndWait(&shared->barrier, PG_WAIT_EXTENSION);
+        }
+    }
+
+    while (!shared->done)
+    {
+        uint64 changed = 0;
+        uint32 chunk;
+
+        while ((chunk = pg_atomic_fetch_add_u32(&shared->next_chunk, 1)) <
+               num_chunks)
+        {
+            int32 start = chunk * LP_CHUNK_SIZE;
+            int32 end = Min(start + LP_CHUNK_SIZE, shared->num_vertices);
+            int32 i;
+
+            for (i = start; i < end; i++)
+            {
+                if (label_propagation_update_vertex(lps, i))
+                {
+                    changed++;
+                }
+            }
+
+            CHECK_FOR_INTERRUPTS();
+        }
+
+        pg_atomic_fetch_add_u64(&shared->changed, changed);
+
+        if (!parallel)
+        {
+            label_propagation_end_pass(shared);
+            continue;
+        }
+
+        if (BarrierArriveAndWait(&shared->barrier, PG_WAIT_EXTENSION))
+        {
+            label_propagation_end_pass(shared);
+        }
+        BarrierArriveAndWait(&shared->barrier, PG_WAIT_EXTENSION);
+    }
+
+    if (parallel)
+    {
+        BarrierDetach(&shared->barrier);
+    }
+}
+
+/* entry point of the label propagation parallel workers */
+void age_label_propagation_worker(dsm_segment *seg, shm_toc *toc)
+{
+    LabelPropagationState lps;
+    GraphCSR *csr = attach_graph_csr_dsm(toc);
+
+    lps.shared = shm_toc_lookup(toc, LP_KEY_SHARED, false);
+    lps.offsets = csr->offsets;
+    lps.targets = csr->targets;
+    lps.labels = shm_toc_lookup(toc, LP_KEY_LABELS, false);
+    lps.scratch = palloc_extended(sizeof(int32) *
+                                  (lps.shared->max_degree + 1),
+                                  MCXT_ALLOC_HUGE);
+
+    label_propagation_participate(&lps, true);
+}
+
+/*
+ * Runs label propagation over the CSR and returns the final label (a vertex
+ * ordinal) of every vertex. Workers are only used when the graph is large
+ * enough and age.graph_algorithm_workers allows them.
+ */
+static int32 *run_label_propagation(GraphCSR *csr, int32 max_iter)
+{
+    LabelPropagationShared local_shared;
+    LabelPropagationState lps;
+    ParallelContext *pcxt = NULL;
+    Size labels_size;
+    int32 *result;
+    int nworkers;
+    int32 i;
+
+    nworkers = get_graph_algorithm_workers(csr->num_edges,
+                                           LP_MIN_PARALLEL_EDGES);
+    labels_size = sizeof(pg_atomic_uint32) * Max((Size) csr->num_vertices, 1);
+
+    if (nworkers > 0)
+    {
+        LabelPropagationShared *shared;
+
+        EnterParallelMode();
+        pcxt = CreateParallelContext("age", "age_label_propagation_worker",
+                                     nworkers);
+
+        shm_toc_estimate_chunk(&pcxt->estimator,
+                               sizeof(LabelPropagationShared));
+        shm_toc_estimate_chunk(&pcxt->estimator, labels_size);
+        shm_toc_estimate_keys(&pcxt->estimator, 2);
+        estimate_graph_csr_dsm(pcxt, csr);
+
+        InitializeParallelDSM(pcxt);
+        store_graph_csr_dsm(pcxt, csr);
+
+        shared = shm_toc_allocate(pcxt->toc, sizeof(LabelPropagationShared));
+        init_label_propagation_shared(shared, csr, max_iter);
+        shm_toc_insert(pcxt->toc, LP_KEY_SHARED, shared);
+
+        /* the leader reads its own copy of the rows */
+        lps.shared = shared;
+        lps.offsets = csr->offsets;
+        lps.targets = csr->targets;
+        lps.labels = shm_toc_allocate(pcxt->toc, labels_size);
+        shm_toc_insert(pcxt->toc, LP_KEY_LABELS, lps.labels);
+    }
+    else
+    {
+        init_label_propagation_shared(&local_shared, csr, max_iter);
+
+        lps.shared = &local_shared;
+        lps.offsets = csr->offsets;
+        lps.targets = csr->targets;
+        lps.labels = palloc_extended(labels_size, MCXT_ALLOC_HUGE);
+    }
+
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        pg_atomic_init_u32(&lps.labels[i], (uint32) i);
+    }
+    lps.scratch = palloc_extended(sizeof(int32) *
+                                  (lps.shared->max_degree + 1),
+                                  MCXT_ALLOC_HUGE);
+
+    if (pcxt != NULL)
+    {
+        /* the leader participates as well, whether or not workers start */
+        LaunchParallelWorkers(pcxt);
+        label_propagation_participate(&lps, true);
+        WaitForParallelWorkersToFinish(pcxt);
+    }
+    else
+    {
+        label_propagation_participate(&lps, false);
+    }
+
+    result = palloc_extended(sizeof(int32) *
+                             Max((Size) csr->num_vertices, 1),
+                             MCXT_ALLOC_HUGE);
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        result[i] = (int32) pg_atomic_read_u32(&lps.labels[i]);
+    }
+
+    pfree(lps.scratch);
+    if (pcxt != NULL)
+    {
+        DestroyParallelContext(pcxt);
+        ExitParallelMode();
+    }
+    else
+    {
+        pfree(lps.labels);
+    }
+
+    return result;
+}
+
+PG_FUNCTION_INFO_V1(age_label_propagation);
+
+/*
+ * age_label_propagation(graph_name, edge_label, max_iter)
+ *
+ * Detects communities with label propagation over the undirected view of
+ * the graph, optionally restricted to one edge label. Returns every vertex
+ * with its community, which is identified by the graphid of one of its
+ * members.
+ */
+Datum age_label_propagation(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    char *graph_name = NULL;
+    char *label_name = NULL;
+    int32 max_iter = 20;
+    int32 *labels = NULL;
+    int32 i;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("label_propagation: graph name cannot be NULL")));
+    }
+
+    graph_name = NameStr(*PG_GETARG_NAME(0));
+    label_name = get_name_arg_or_null(fcinfo, 1);
+    if (!PG_ARGISNULL(2))
+    {
+        max_iter = PG_GETARG_INT32(2);
+    }
+
+    if (max_iter < 0)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("label_propagation: max_iter cannot be negative")));
+    }
+
+    csr = build_graph_csr_by_name("label_propagation", graph_name,
+                                  label_name, CSR_DIRECTION_BOTH, false);
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    labels = run_label_propagation(csr, max_iter);
+
+    for (i = 0; i < csr->num_vertices; i++)
+    {
+        Datum values[2];
+        bool nulls[2] = {false, false};
+
+        values[0] = GRAPHID_GET_DATUM(csr->vertex_ids[i]);
+        values[1] = GRAPHID_GET_DATUM(csr->vertex_ids[labels[i]]);
+
+        tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+    }
+
+    pfree(labels);
+    free_graph_csr(csr);
+
+    PG_RETURN_NULL();
+}
@@ -0,0 +1,416 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Minimum spanning forest with Kruskal's algorithm.
+ *
+ * The edges are taken from the OUT CSR, so each one is seen once, and are
+ * sorted by weight in runs. Kruskal's loop then consumes the runs through a
+ * binary heap of their heads, which merges them on the fly, and joins the
+ * components with a union-find over the vertex ordinals.
+ *
+ * Sorting dominates, so with enough edges the runs are sorted by parallel
+ * workers in the DSM segment. The leader claims runs as well and does the
+ * merge and the union-find by itself, which are close to linear.
+ */
+
+#include "postgres.h"
+
+#include "access/parallel.h"
+#include "funcapi.h"
+#include "lib/binaryheap.h"
+#include "miscadmin.h"
+#include <math.h>
+#include "port/atomics.h"
+#include "utils/builtins.h"
+
+#include "utils/age_graph_csr.h"
+
+/* shm_toc keys of the spanning forest parallel DSM segment */
+#define MSF_KEY_SHARED UINT64CONST(0xA6E0000000000301)
+#define MSF_KEY_EDGES  UINT64CONST(0xA6E0000000000302)
+
+/* below this many edges, the leader sorts them by itself */
+#define MSF_MIN_PARALLEL_EDGES 1000000
+
+/* sorted runs per participant, so that a slow one can be made up for */
+#define MSF_RUNS_PER_PARTICIPANT 4
+
+/* an undirected edge, as sorted by Kruskal's algorithm */
+typedef struct msf_edge
+{
+    float8 weight;
+    graphid edge_id;
+    int32 start;        /* start vertex ordinal */
+    int32 end;          /* end vertex ordinal */
+} msf_edge;
+
+/* spanning forest state shared by all participants */
+typedef struct SpanningForestShared
+{
+    int64 num_edges;
+    int32 num_runs;
+    pg_atomic_uint32 next_run;
+} SpanningForestShared;
+
+/* a sorted run of edges, consumed from next up to end */
+typedef struct msf_run
+{
+    int64 next;
+    int64 end;
+} msf_run;
+
+/* the runs being merged, passed to the heap comparator */
+typedef struct msf_merge_state
+{
+    msf_edge *edges;
+    msf_run *runs;
+} msf_merge_state;
+
+PGDLLEXPORT void age_spanning_forest_worker(dsm_segment *seg, shm_toc *toc);
+
+static int compare_msf_edges(const void *a, const void *b);
+static int compare_msf_runs(Datum a, Datum b, void *arg);
+static void get_msf_run_bounds(int64 num_edges, int32 num_runs, int32 run,
+                               int64 *start, int64 *end);
+static void spanning_forest_participate(SpanningForestShared *shared,
+                                        msf_edge *edges);
+static int32 find_msf_root(int32 *parent, int32 v);
+
+/* orders edges by weight, then by edge graphid to keep results stable */
+static int compare_msf_edges(const void *a, const void *b)
+{
+    const msf_edge *ea = (const msf_edge *) a;
+    const msf_edge *eb = (const msf_edge *) b;
+
+    if (ea->weight != eb->weight)
+    {
+        return (ea->weight < eb->weight) ? -1 : 1;
+    }
+    if (ea->edge_id != eb->edge_id)
+    {
+        return (ea->edge_id < eb->edge_id) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/*
+ * binaryheap keeps the largest node first, so the comparison is reversed to
+ * keep the run with the lightest head edge first.
+ */
+static int compare_msf_runs(Datum a, Datum b, void *arg)
+{
+    msf_merge_state *state = (msf_merge_state *) arg;
+    msf_run *ra = &state->runs[DatumGetInt32(a)];
+    msf_run *rb = &state->runs[DatumGetInt32(b)];
+
+    return compare_msf_edges(&state->edges[rb->next],
+                             &state->edges[ra->next]);
+}
+
+/* computes the edge range of a run, which all participants agree on */
+static void get_msf_run_bounds(int64 num_edges, int32 num_runs, int32 run,
+                               int64 *start, int64 *end)
+{
+    *start = num_edges * run / num_runs;
+    *end = num_edges * (run + 1) / num_runs;
+}
+
+/* claims runs from the shared counter and sorts them until none are left */
+static void spanning_forest_participate(SpanningForestShared *shared,
+                                        msf_edge *edges)
+{
+    uint32 run;
+
+    while ((run = pg_atomic_fetch_add_u32(&shared->next_run, 1)) <
+           (uint32) shared->num_runs)
+    {
+        int64 start;
+        int64 end;
+
+        get_msf_run_bounds(shared->num_edges, shared->num_runs, (int32) run,
+                           &start, &end);
+        qsort(edges + start, end - start, sizeof(msf_edge),
+              compare_msf_edges);
+
+        CHECK_FOR_INTERRUPTS();
+    }
+}
+
+/* entry point of the spanning forest parallel workers */
+void age_spanning_forest_worker(dsm_segment *seg, shm_toc *toc)
+{
+    spanning_forest_participate(shm_toc_lookup(toc, MSF_KEY_SHARED, false),
+                                shm_toc_lookup(toc, MSF_KEY_EDGES, false));
+}
+
+/* union-find root of v, halving the path on the way */
+static int32 find_msf_root(int32 *parent, int32 v)
+{
+    while (parent[v] != v)
+    {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+
+    return v;
+}
+
+PG_FUNCTION_INFO_V1(age_minimum_spanning_forest);
+
+/*
+ * age_minimum_spanning_forest(graph_name, edge_label, weight_property)
+ *
+ * Returns the edges of a minimum spanning forest of the graph, viewed as
+ * undirected, with the weight of each edge and the total weight of the
+ * forest. Edges weigh the numeric value of weight_property, or 1 when it is
+ * NULL. Self loops never join two components and are ignored. Edges of
+ * equal weight are taken in graphid order, so the forest returned is always
+ * the same one. The edges are returned in the order they were chosen.
+ */
+Datum age_minimum_spanning_forest(PG_FUNCTION_ARGS)
+{
+    Tuplestorestate *tuple_store = NULL;
+    TupleDesc tupdesc;
+    GraphCSR *csr = NULL;
+    SpanningForestShared local_shared;
+    SpanningForestShared *shared = &local_shared;
+    ParallelContext *pcxt = NULL;
+    msf_merge_state merge;
+    binaryheap *heap = NULL;
+    char *weight_property = NULL;
+    float8 *weights = NULL;
+    msf_edge *edges = NULL;
+    int64 *chosen = NULL;
+    int32 *parent = NULL;
+    uint8 *rank = NULL;
+    float8 total_weight = 0.0;
+    int32 num_chosen = 0;
+    int32 num_runs = 1;
+    int32 r;
+    int32 v;
+    int64 slot;
+    int64 i;
+    int nworkers;
+
+    if (PG_ARGISNULL(0))
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("minimum_spanning_forest: graph name cannot be NULL")));
+    }
+
+    if (!PG_ARGISNULL(2))
+    {
+        weight_property = text_to_cstring(PG_GETARG_TEXT_PP(2));
+    }
+
+    csr = build_graph_csr_by_name("minimum_spanning_forest",
+                                  NameStr(*PG_GETARG_NAME(0)),
+                                  get_name_arg_or_null(fcinfo, 1),
+                                  CSR_DIRECTION_OUT, false);
+
+    if (weight_property != NULL)
+    {
+        weights = get_graph_csr_edge_weights("minimum_spanning_forest", csr,
+                                             weight_property);
+    }
+
+    tuple_store = begin_graph_algorithm_srf(fcinfo, &tupdesc);
+
+    nworkers = get_graph_algorithm_workers(csr->num_edges,
+                                           MSF_MIN_PARALLEL_EDGES);
+
+    if (nworkers > 0)
+    {
+        Size edges_size = sizeof(msf_edge) * ((Size) csr->num_edges + 1);
+
+        EnterParallelMode();
+        pcxt = CreateParallelContext("age", "age_spanning_forest_worker",
+                                     nworkers);
+
+        shm_toc_estimate_chunk(&pcxt->estimator,
+                               sizeof(SpanningForestShared));
+        shm_toc_estimate_chunk(&pcxt->estimator, edges_size);
+        shm_toc_estimate_keys(&pcxt->estimator, 2);
+
+        InitializeParallelDSM(pcxt);
+
+        shared = shm_toc_allocate(pcxt->toc, sizeof(SpanningForestShared));
+        shm_toc_insert(pcxt->toc, MSF_KEY_SHARED, shared);
+
+        edges = shm_toc_allocate(pcxt->toc, edges_size);
+        shm_toc_insert(pcxt->toc, MSF_KEY_EDGES, edges);
+
+        num_runs = (nworkers + 1) * MSF_RUNS_PER_PARTICIPANT;
+    }
+    else
+    {
+        edges = palloc_extended(sizeof(msf_edge) *
+                                ((Size) csr->num_edges + 1),
+                                MCXT_ALLOC_HUGE);
+    }
+
+    for (v = 0; v < csr->num_vertices; v++)
+    {
+        for (slot = csr->offsets[v]; slot < csr->offsets[v + 1]; slot++)
+        {
+            float8 weight = (weights != NULL) ? weights[slot] : 1.0;
+
+            if (isnan(weight))
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                         errmsg("minimum_spanning_forest: edge %ld has a NaN \"%s\" property",
+                                csr->edge_ids[slot], weight_property)));
+            }
+
+            edges[slot].weight = weight;
+            edges[slot].edge_id = csr->edge_ids[slot];
+            edges[slot].start = v;
+            edges[slot].end = csr->targets[slot];
+        }
+    }
+
+    shared->num_edges = csr->num_edges;
+    shared->num_runs = num_runs;
+    pg_atomic_init_u32(&shared->next_run, 0);
+
+    if (pcxt != NULL)
+    {
+        /* the leader sorts runs as well, whether or not workers start */
+        LaunchParallelWorkers(pcxt);
+        spanning_forest_participate(shared, edges);
+        WaitForParallelWorkersToFinish(pcxt);
+    }
+    else
+    {
+        spanning_forest_participate(shared, edges);
+    }
+
+    /* merge the sorted runs through a heap of their head edges */
+    merge.edges = edges;
+    merge.runs = palloc(sizeof(msf_run) * num_runs);
+    heap = binaryheap_allocate(num_runs, compare_msf_runs, &merge);
+    for (r = 0; r < num_runs; r++)
+    {
+        get_msf_run_bounds(csr->num_edges, num_runs, r, &merge.runs[r].next,
+                           &merge.runs[r].end);
+        if (merge.runs[r].next < merge.runs[r].end)
+        {
+            binaryheap_add_unordered(heap, Int32GetDatum(r));
+        }
+    }
+    binaryheap_build(heap);
+
+    parent = palloc_extended(sizeof(int32) * ((Size) csr->num_vertices + 1),
+                             MCXT_ALLOC_HUGE);
+    rank = palloc_extended(sizeof(uint8) * ((Size) csr->num_vertices + 1),
+                           MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+    chosen = palloc_extended(sizeof(int64) * ((Size) csr->num_vertices + 1),
+                             MCXT_ALLOC_HUGE);
+    for (v = 0; v < csr->num_vertices; v++)
+    {
+        parent[v] = v;
+    }
+
+    /* a forest over n vertices has at most n - 1 edges */
+    while (!binaryheap_empty(heap) && num_chosen < csr->num_vertices - 1)
+    {
+        msf_run *run;
+        msf_edge *edge;
+        int32 root_start;
+        int32 root_end;
+
+        r = DatumGetInt32(binaryheap_first(heap));
+        run = &merge.runs[r];
+        i = run->next++;
+        edge = &edges[i];
+
+        if (run->next < run->end)
+        {
+            binaryheap_replace_first(heap, Int32GetDatum(r));
+        }
+        else
+        {
+            binaryheap_remove_first(heap);
+        }
+
+        root_start = find_msf_root(parent, edge->start);
+        root_end = find_msf_root(parent, edge->end);
+
+        if (root_start == root_end)
+        {
+            continue;
+        }
+
+        /* union by rank */
+        if (rank[root_start] < rank[root_end])
+        {
+            parent[root_start] = root_end;
+        }
+        else if (rank[root_start] > rank[root_end])
+        {
+            parent[root_end] = root_start;
+        }
+        else
+        {
+            parent[root_end] = root_start;
+            rank[root_start]++;
+        }
+
+        chosen[num_chosen++] = i;
+        total_weight += edge->weight;
+
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    for (i = 0; i < num_chosen; i++)
+    {
+        Datum values[3];
+        bool nulls[3] = {false, false, false};
+
+        values[0] = GRAPHID_GET_DATUM(edges[chosen[i]].edge_id);
+        values[1] = Float8GetDatum(edges[chosen[i]].weight);
+        values[2] = Float8GetDatum(total_weight);
+
+        tuplestore_putvalues(tuple_store, tupdesc, values, nulls);
+    }
+
+    if (pcxt != NULL)
+    {
+        DestroyParallelContext(pcxt);
+        ExitParallelMode();
+    }
+    else
+    {
+        pfree(edges);
+    }
+
+    binaryheap_free(heap);
+    pfree(merge.runs);
+    pfree(parent);
+    pfree(rank);
+    pfree(chosen);
+    pfree_if_not_null(weights);
+    free_graph_csr(csr);
+
+    PG_RETURN_NULL();
+}
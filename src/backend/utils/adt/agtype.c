@@ -42,7 +42,9 @@
 #include "catalog/pg_am_d.h"
 #include "catalog/pg_collation_d.h"
 #include "catalog/pg_operator_d.h"
+#include "common/hashfn.h"
 #include "funcapi.h"
+#include "lib/hyperloglog.h"
 #include "libpq/pqformat.h"
 #include "miscadmin.h"
 #include "parser/parse_coerce.h"
@@ -53,7 +55,9 @@
 #include "utils/float.h"
 #include "utils/lsyscache.h"
 #include "utils/snapmgr.h"
+#include "utils/sortsupport.h"
 #include "utils/typcache.h"
+#include "utils/varlena.h"
 #include "utils/age_vle.h"
 #include "utils/agtype_parser.h"
 #include "utils/ag_float8_supp.h"
@@ -5379,6 +5383,148 @@ Datum agtype_btree_cmp(PG_FUNCTION_ARGS)
     PG_RETURN_INT32(result);
 }
 
+/*
+ * State of the sort support of agtype_btree_sort() when keys are
+ * abbreviated. The prefixes of strings are the abbreviated keys of text in
+ * the default collation, if text has them.
+ */
+typedef struct agtype_sort_support_state
+{
+    SortSupport text_ssup;
+    int64 input_count;
+    bool estimating;
+    hyperLogLogState abbr_card;
+} agtype_sort_support_state;
+
+/*
+ * agtype_btree_cmp() without the function call overhead. Two scalars are
+ * compared without iterators.
+ */
+static int agtype_btree_fast_cmp(Datum x, Datum y, SortSupport ssup)
+{
+    agtype *agtype_lhs = DATUM_GET_AGTYPE_P(x);
+    agtype *agtype_rhs = DATUM_GET_AGTYPE_P(y);
+    int result;
+
+    result = compare_agtype_containers_orderability(&agtype_lhs->root,
+                                                    &agtype_rhs->root);
+
+    if ((Pointer)agtype_lhs != DatumGetPointer(x))
+    {
+        pfree(agtype_lhs);
+    }
+    if ((Pointer)agtype_rhs != DatumGetPointer(y))
+    {
+        pfree(agtype_rhs);
+    }
+
+    return result;
+}
+
+static Datum agtype_abbrev_convert(Datum original, SortSupport ssup)
+{
+    agtype_sort_support_state *state = ssup->ssup_extra;
+    SortSupport text_ssup = state->text_ssup;
+    agtype *agt = DATUM_GET_AGTYPE_P(original);
+    char *str;
+    int str_len;
+    uint64 key;
+
+    key = get_agtype_abbrev_key(&agt->root, &str, &str_len);
+
+    if (str != NULL && text_ssup->abbrev_converter != NULL)
+    {
+        text *t = cstring_to_text_with_len(str, str_len);
+        Datum text_key;
+
+        text_key = text_ssup->abbrev_converter(PointerGetDatum(t), text_ssup);
+        key |= DatumGetUInt64(text_key) >> (64 - AGTYPE_ABBREV_PREFIX_BITS);
+
+        pfree(t);
+    }
+
+    if ((Pointer)agt != DatumGetPointer(original))
+    {
+        pfree(agt);
+    }
+
+    state->input_count++;
+    if (state->estimating)
+    {
+        uint32 tmp = (uint32)key ^ (uint32)(key >> 32);
+
+        addHyperLogLog(&state->abbr_card, DatumGetUInt32(hash_uint32(tmp)));
+    }
+
+    return UInt64GetDatum(key);
+}
+
+/*
+ * Give up the abbreviated keys when they are mostly the same, with the
+ * thresholds of numeric_abbrev_abort().
+ */
+static bool agtype_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+    agtype_sort_support_state *state = ssup->ssup_extra;
+    double abbr_card;
+
+    if (memtupcount < 10000 || state->input_count < 10000 ||
+        !state->estimating)
+    {
+        return false;
+    }
+
+    abbr_card = estimateHyperLogLog(&state->abbr_card);
+
+    /* with that many distinct keys, abbreviation pays off; stop counting */
+    if (abbr_card > 100000.0)
+    {
+        state->estimating = false;
+        return false;
+    }
+
+    return abbr_card < state->input_count / 10000.0 + 0.5;
+}
+
+/* Sort support for the btree operator class */
+PG_FUNCTION_INFO_V1(agtype_btree_sort);
+
+Datum agtype_btree_sort(PG_FUNCTION_ARGS)
+{
+    SortSupport ssup = (SortSupport)PG_GETARG_POINTER(0);
+
+    ssup->comparator = agtype_btree_fast_cmp;
+
+    /* the prefixes of abbreviated keys need 64-bit Datums */
+    if (ssup->abbreviate && SIZEOF_DATUM == 8)
+    {
+        agtype_sort_support_state *state;
+        MemoryContext oldcontext;
+
+        oldcontext = MemoryContextSwitchTo(ssup->ssup_cxt);
+
+        state = palloc(sizeof(agtype_sort_support_state));
+        state->text_ssup = palloc0(sizeof(SortSupportData));
+        state->text_ssup->ssup_cxt = ssup->ssup_cxt;
+        state->text_ssup->ssup_collation = DEFAULT_COLLATION_OID;
+        state->text_ssup->abbreviate = true;
+        varstr_sortsupport(state->text_ssup, TEXTOID, DEFAULT_COLLATION_OID);
+        state->input_count = 0;
+        state->estimating = true;
+        initHyperLogLog(&state->abbr_card, 10);
+
+        MemoryContextSwitchTo(oldcontext);
+
+        ssup->ssup_extra = state;
+        ssup->abbrev_full_comparator = ssup->comparator;
+        ssup->comparator = ssup_datum_unsigned_cmp;
+        ssup->abbrev_converter = agtype_abbrev_convert;
+        ssup->abbrev_abort = agtype_abbrev_abort;
+    }
+
+    PG_RETURN_VOID();
+}
+
 PG_FUNCTION_INFO_V1(agtype_typecast_numeric);
 /*
  * Execute function to typecast an agtype to an agtype numeric
@@ -11119,6 +11265,111 @@ agtype_value *alter_property_value(agtype_value *properties, char *var_name,
     return parsed_agtype_value;
 }
 
+/*
+ * Sets the property var_name of the properties object to new_v, or removes
+ * it, in place. It is the same as alter_property_value(), without copying
+ * the object through its serialized form, and returns properties. The pairs
+ * are kept in the order that uniqueify_agtype_object() gives them.
+ *
+ * This is a helper function used by the SET clause executor to apply the
+ * items of a list to an entity it has decoded once.
+ */
+agtype_value *set_property_value(agtype_value *properties, char *var_name,
+                                 agtype *new_v, bool remove_property)
+{
+    agtype_pair *pairs;
+    int num_pairs;
+    int var_name_len = strlen(var_name);
+    int i;
+    int cmp = 1;
+
+    /* if no properties, return NULL */
+    if (properties == NULL)
+    {
+        return NULL;
+    }
+
+    /* if properties is not an object, throw an error */
+    if (properties->type != AGTV_OBJECT)
+    {
+        ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                        errmsg("can only update objects")));
+    }
+
+    /*
+     * If the new value is NULL, this is equivalent to the remove_property
+     * flag set to true.
+     */
+    if (new_v == NULL)
+    {
+        remove_property = true;
+    }
+
+    pairs = properties->val.object.pairs;
+    num_pairs = properties->val.object.num_pairs;
+
+    /* keys are ordered by length first, then by their bytes */
+    for (i = 0; i < num_pairs; i++)
+    {
+        agtype_value *key = &pairs[i].key;
+
+        if (key->val.string.len != var_name_len)
+        {
+            cmp = (key->val.string.len > var_name_len) ? 1 : -1;
+        }
+        else
+        {
+            cmp = memcmp(key->val.string.val, var_name, var_name_len);
+        }
+
+        if (cmp >= 0)
+        {
+            break;
+        }
+    }
+
+    if (remove_property)
+    {
+        if (i < num_pairs && cmp == 0)
+        {
+            memmove(&pairs[i], &pairs[i + 1],
+                    sizeof(agtype_pair) * (num_pairs - i - 1));
+            properties->val.object.num_pairs--;
+        }
+
+        return properties;
+    }
+
+    /* add a pair for the key if it doesn't exist yet */
+    if (i == num_pairs || cmp != 0)
+    {
+        agtype_pair *new_pairs = palloc(sizeof(agtype_pair) * (num_pairs + 1));
+
+        memcpy(new_pairs, pairs, sizeof(agtype_pair) * i);
+        memcpy(&new_pairs[i + 1], &pairs[i],
+               sizeof(agtype_pair) * (num_pairs - i));
+
+        new_pairs[i].key = *string_to_agtype_value(var_name);
+        new_pairs[i].order = num_pairs;
+
+        properties->val.object.pairs = new_pairs;
+        properties->val.object.num_pairs++;
+        pairs = new_pairs;
+    }
+
+    /* see alter_property_value() */
+    if (AGTYPE_CONTAINER_IS_SCALAR(&new_v->root))
+    {
+        pairs[i].value = *get_ith_agtype_value_from_container(&new_v->root, 0);
+    }
+    else
+    {
+        pairs[i].value = *agtype_composite_to_agtype_value_binary(new_v);
+    }
+
+    return properties;
+}
+
 /*
  * Appends new_properties into a copy of original_properties. If the
  * original_properties is NULL, returns new_properties.
@@ -99,6 +99,7 @@ static agtype_value *push_agtype_value_scalar(agtype_parse_state **pstate,
                                               agtype_iterator_token seq,
                                               agtype_value *scalar_val);
 static int compare_two_floats_orderability(float8 lhs, float8 rhs);
+static uint64 float8_to_sortable_uint64(float8 value);
 static int get_type_sort_priority(enum agtype_value_type type);
 static void pfree_iterator_agtype_value_token(agtype_iterator_token token,
                                               agtype_value *agtv);
@@ -1197,6 +1198,129 @@ static int compare_agtype_scalar_containers(agtype_container *a,
     return result;
 }
 
+/*
+ * Map a float8 to a uint64 whose unsigned order is the order of
+ * compare_two_floats_orderability(): all NANs are the largest value and
+ * -0.0 is the same as 0.0.
+ */
+static uint64 float8_to_sortable_uint64(float8 value)
+{
+    uint64 bits;
+
+    if (isnan(value))
+    {
+        return PG_UINT64_MAX;
+    }
+    if (value == 0)
+    {
+        value = 0.0;
+    }
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    /* flip all bits of negative values, and only the sign bit of others */
+    if (bits & (UINT64CONST(1) << 63))
+    {
+        return ~bits;
+    }
+    return bits | (UINT64CONST(1) << 63);
+}
+
+/*
+ * Abbreviated key of an agtype for B-tree sort support. The top byte is the
+ * sort priority of the type and the remaining AGTYPE_ABBREV_PREFIX_BITS bits
+ * are a prefix of the value, so that the unsigned order of two keys never
+ * contradicts compare_agtype_containers_orderability(). Equal keys need the
+ * full comparison.
+ *
+ * Integers, floats, and numerics, which compare with each other, are all
+ * prefixed by the bits of their float8 value. (A float is compared with a
+ * numeric after rounding it to 15 digits, so the two can disagree beyond
+ * that, where that comparison is not transitive anyway.)
+ *
+ * The prefix of strings depends on the collation, so it is left to the
+ * caller: *str and *str_len are set to the string, and *str is NULL for
+ * other types.
+ */
+uint64 get_agtype_abbrev_key(agtype_container *agtc, char **str,
+                             int *str_len)
+{
+    agtype_value v;
+    uint64 prefix = 0;
+
+    *str = NULL;
+
+    /*
+     * Arrays and objects get the same priority. Which of the two comes first
+     * depends on the first element of the array.
+     */
+    if (!AGTYPE_CONTAINER_IS_SCALAR(agtc))
+    {
+        return (uint64)get_type_sort_priority(AGTV_OBJECT)
+               << AGTYPE_ABBREV_PREFIX_BITS;
+    }
+
+    if (AGTE_IS_AGTYPE(agtc->children[0]))
+    {
+        AGT_HEADER_TYPE header;
+
+        memcpy(&header, (char *)&agtc->children[1], sizeof(AGT_HEADER_TYPE));
+
+        /* vertices and edges are ordered by their ids, paths by everything */
+        if (header == AGT_HEADER_VERTEX || header == AGT_HEADER_EDGE)
+        {
+            graphid id;
+
+            if (extract_composite_id_fast(agtc, &id))
+            {
+                prefix = ((uint64)id ^ (UINT64CONST(1) << 63)) >>
+                         (64 - AGTYPE_ABBREV_PREFIX_BITS);
+            }
+
+            return ((uint64)get_type_sort_priority(
+                        header == AGT_HEADER_VERTEX ? AGTV_VERTEX : AGTV_EDGE)
+                    << AGTYPE_ABBREV_PREFIX_BITS) | prefix;
+        }
+        if (header == AGT_HEADER_PATH)
+        {
+            return (uint64)get_type_sort_priority(AGTV_PATH)
+                   << AGTYPE_ABBREV_PREFIX_BITS;
+        }
+    }
+
+    fill_agtype_value_no_copy(agtc, 0, (char *)&agtc->children[1], 0, &v);
+
+    switch (v.type)
+    {
+    case AGTV_STRING:
+        *str = v.val.string.val;
+        *str_len = v.val.string.len;
+        break;
+    case AGTV_BOOL:
+        prefix = v.val.boolean ? 1 : 0;
+        break;
+    case AGTV_INTEGER:
+        prefix = float8_to_sortable_uint64((float8)v.val.int_value) >>
+                 (64 - AGTYPE_ABBREV_PREFIX_BITS);
+        break;
+    case AGTV_FLOAT:
+        prefix = float8_to_sortable_uint64(v.val.float_value) >>
+                 (64 - AGTYPE_ABBREV_PREFIX_BITS);
+        break;
+    case AGTV_NUMERIC:
+        prefix = float8_to_sortable_uint64(DatumGetFloat8(DirectFunctionCall1(
+                     numeric_float8_no_overflow,
+                     NumericGetDatum(v.val.numeric)))) >>
+                 (64 - AGTYPE_ABBREV_PREFIX_BITS);
+        break;
+    default:
+        break;
+    }
+
+    return ((uint64)get_type_sort_priority(v.type)
+            << AGTYPE_ABBREV_PREFIX_BITS) | prefix;
+}
+
 /*
  * Push agtype_value into agtype_parse_state.
  *
@@ -19,10 +19,16 @@
 
 #include "postgres.h"
 
+#include "postmaster/bgworker.h"
 #include "utils/guc.h"
 #include "utils/ag_guc.h"
 
 bool age_enable_containment = true;
+int age_graph_algorithm_workers = 2;
+bool age_enable_graph_expand = false;
+bool age_enable_multiway_join = false;
+int age_cypher_query_cache_size = 256;
+int age_graphid_block_size = 1;
 
 /*
  * Defines AGE's custom configuration parameters.
@@ -42,5 +48,61 @@ void define_config_params(void)
                              NULL,
                              NULL,
                              NULL);
+    DefineCustomIntVariable("age.graph_algorithm_workers",
+                            "Sets the maximum number of parallel workers a graph algorithm may use.",
+                            NULL,
+                            &age_graph_algorithm_workers,
+                            2,
+                            0,
+                            MAX_PARALLEL_WORKER_LIMIT,
+                            PGC_USERSET,
+                            0,
+                            NULL,
+                            NULL,
+                            NULL);
+    DefineCustomBoolVariable("age.enable_graph_expand",
+                             "Enables the planner's use of graph expand scans over the global graph context.",
+                             NULL,
+                             &age_enable_graph_expand,
+                             false,
+                             PGC_USERSET,
+                             0,
+                             NULL,
+                             NULL,
+                             NULL);
+    DefineCustomBoolVariable("age.enable_multiway_join",
+                             "Enables joining cyclic MATCH patterns by intersecting the adjacency of the global graph context.",
+                             NULL,
+                             &age_enable_multiway_join,
+                             false,
+                             PGC_USERSET,
+                             0,
+                             NULL,
+                             NULL,
+                             NULL);
+    DefineCustomIntVariable("age.cypher_query_cache_size",
+                            "Sets the maximum number of analyzed cypher() queries cached by each backend.",
+                            NULL,
+                            &age_cypher_query_cache_size,
+                            256,
+                            0,
+                            INT_MAX,
+                            PGC_USERSET,
+                            0,
+                            NULL,
+                            NULL,
+                            NULL);
+    DefineCustomIntVariable("age.graphid_block_size",
+                            "Sets the sequence cache of new labels, the number of graph ids a backend takes at a time.",
+                            NULL,
+                            &age_graphid_block_size,
+                            1,
+                            1,
+                            INT_MAX,
+                            PGC_USERSET,
+                            0,
+                            NULL,
+                            NULL,
+                            NULL);
     EmitWarningsOnPlaceholders("age");
 }
@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include "commands/sequence.h"
+#include "utils/inval.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+
+#include "utils/ag_cache.h"
+#include "utils/ag_graphid_cache.h"
+
+typedef struct label_seq_entry
+{
+    Oid label_relation; /* hash key */
+    Oid seq_relation;
+    int32 label_id;
+} label_seq_entry;
+
+static HTAB *label_seq_hash = NULL;
+
+static void initialize_label_seq_cache(void);
+static void invalidate_label_seq_cache(Datum arg, Oid relid);
+static label_seq_entry *get_label_seq_entry(Oid label_relation);
+
+static void initialize_label_seq_cache(void)
+{
+    HASHCTL hash_ctl;
+
+    if (label_seq_hash)
+    {
+        return;
+    }
+    if (!CacheMemoryContext)
+    {
+        CreateCacheMemoryContext();
+    }
+
+    MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+    hash_ctl.keysize = sizeof(Oid);
+    hash_ctl.entrysize = sizeof(label_seq_entry);
+
+    label_seq_hash = hash_create("label sequence cache", 16, &hash_ctl,
+                                 HASH_ELEM | HASH_BLOBS);
+
+    /*
+     * An entry must not outlive its label or its sequence, whose OIDs may be
+     * reused by relations created later.
+     */
+    CacheRegisterRelcacheCallback(invalidate_label_seq_cache, (Datum)0);
+}
+
+static void invalidate_label_seq_cache(Datum arg, Oid relid)
+{
+    HASH_SEQ_STATUS hash_seq;
+    label_seq_entry *entry;
+
+    hash_seq_init(&hash_seq, label_seq_hash);
+    while ((entry = hash_seq_search(&hash_seq)) != NULL)
+    {
+        if (relid == InvalidOid || entry->label_relation == relid ||
+            entry->seq_relation == relid)
+        {
+            hash_search(label_seq_hash, &entry->label_relation, HASH_REMOVE,
+                        NULL);
+        }
+    }
+}
+
+static label_seq_entry *get_label_seq_entry(Oid label_relation)
+{
+    label_seq_entry *entry;
+    label_cache_data *label;
+    int32 label_id;
+    Oid seq_relation;
+
+    initialize_label_seq_cache();
+
+    entry = hash_search(label_seq_hash, &label_relation, HASH_FIND, NULL);
+    if (entry)
+    {
+        return entry;
+    }
+
+    label = search_label_relation_cache(label_relation);
+    if (!label)
+    {
+        elog(ERROR, "relation %u is not a label table", label_relation);
+    }
+    label_id = label->id;
+
+    /* the namespace of a graph has the same OID as the graph */
+    seq_relation = get_relname_relid(NameStr(label->seq_name), label->graph);
+    if (!OidIsValid(seq_relation))
+    {
+        elog(ERROR, "sequence \"%s\" of label relation %u does not exist",
+             NameStr(label->seq_name), label_relation);
+    }
+
+    entry = hash_search(label_seq_hash, &label_relation, HASH_ENTER, NULL);
+    entry->seq_relation = seq_relation;
+    entry->label_id = label_id;
+
+    return entry;
+}
+
+graphid get_next_label_graphid(Oid label_relation)
+{
+    label_seq_entry *entry;
+    int64 entry_id;
+
+    entry = get_label_seq_entry(label_relation);
+
+    /* values cached by the sequence's CACHE are handed out from the backend */
+    entry_id = nextval_internal(entry->seq_relation, true);
+
+    return make_graphid(entry->label_id, entry_id);
+}
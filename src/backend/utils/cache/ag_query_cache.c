@@ -0,0 +1,338 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "postgres.h"
+
+#include "catalog/namespace.h"
+#include "common/hashfn.h"
+#include "lib/ilist.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "storage/lmgr.h"
+#include "utils/inval.h"
+#include "utils/memutils.h"
+#include "utils/syscache.h"
+
+#include "utils/ag_guc.h"
+#include "utils/ag_query_cache.h"
+
+/*
+ * Everything other than the query text that changes what analyze_cypher()
+ * produces for it. The text itself is only hashed here; entries keep the
+ * full text to tell hash collisions apart.
+ */
+typedef struct cypher_query_cache_key
+{
+    Oid graph_oid;
+    uint32 query_hash;
+    Oid param_type; /* InvalidOid if cypher() is called without parameters */
+    int param_id;
+    Oid user_id; /* "$user" in search_path depends on it */
+    bool enable_containment;
+    bool enable_multiway_join;
+} cypher_query_cache_key;
+
+typedef struct cypher_query_cache_entry
+{
+    cypher_query_cache_key key; /* hash key */
+    dlist_node lru_node;
+    MemoryContext context; /* holds everything below */
+    char *query_str;
+    char *search_path;
+    bool ends_with_dml;
+    Query *query;
+} cypher_query_cache_entry;
+
+static HTAB *cypher_query_cache_hash = NULL;
+
+/* entries in the order of their last use, the most recent one first */
+static dlist_head cypher_query_cache_lru =
+    DLIST_STATIC_INIT(cypher_query_cache_lru);
+
+static void initialize_cypher_query_cache(void);
+static void invalidate_cypher_query_cache_rel(Datum arg, Oid relid);
+static void invalidate_cypher_query_cache_sys(Datum arg, int cache_id,
+                                              uint32 hash_value);
+static void flush_cypher_query_cache(void);
+static void remove_cypher_query_cache_entry(cypher_query_cache_entry *entry);
+static void make_cypher_query_cache_key(cypher_query_cache_key *key,
+                                        Oid graph_oid, const char *query_str,
+                                        Param *params);
+static void lock_query_relations(Query *query);
+static bool lock_sublink_relations_walker(Node *node, void *context);
+
+static void initialize_cypher_query_cache(void)
+{
+    HASHCTL hash_ctl;
+
+    if (cypher_query_cache_hash)
+    {
+        return;
+    }
+    if (!CacheMemoryContext)
+    {
+        CreateCacheMemoryContext();
+    }
+
+    MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+    hash_ctl.keysize = sizeof(cypher_query_cache_key);
+    hash_ctl.entrysize = sizeof(cypher_query_cache_entry);
+
+    cypher_query_cache_hash = hash_create("cypher() query cache", 64,
+                                          &hash_ctl, HASH_ELEM | HASH_BLOBS);
+
+    /*
+     * An analyzed query refers to the relations of the labels it uses and
+     * to their absence as well; a label created later must not be missed.
+     * Labels may also be created while a query is analyzed. So, any relcache
+     * invalidation flushes the whole cache instead of the entries of one
+     * relation. Graphs are backed by namespaces, and functions, operators,
+     * and types are resolved by name during the analysis.
+     */
+    CacheRegisterRelcacheCallback(invalidate_cypher_query_cache_rel,
+                                  (Datum)0);
+    CacheRegisterSyscacheCallback(NAMESPACEOID,
+                                  invalidate_cypher_query_cache_sys, (Datum)0);
+    CacheRegisterSyscacheCallback(PROCOID, invalidate_cypher_query_cache_sys,
+                                  (Datum)0);
+    CacheRegisterSyscacheCallback(OPEROID, invalidate_cypher_query_cache_sys,
+                                  (Datum)0);
+    CacheRegisterSyscacheCallback(TYPEOID, invalidate_cypher_query_cache_sys,
+                                  (Datum)0);
+}
+
+static void invalidate_cypher_query_cache_rel(Datum arg, Oid relid)
+{
+    flush_cypher_query_cache();
+}
+
+static void invalidate_cypher_query_cache_sys(Datum arg, int cache_id,
+                                              uint32 hash_value)
+{
+    flush_cypher_query_cache();
+}
+
+static void flush_cypher_query_cache(void)
+{
+    dlist_mutable_iter iter;
+
+    dlist_foreach_modify(iter, &cypher_query_cache_lru)
+    {
+        remove_cypher_query_cache_entry(
+            dlist_container(cypher_query_cache_entry, lru_node, iter.cur));
+    }
+}
+
+static void remove_cypher_query_cache_entry(cypher_query_cache_entry *entry)
+{
+    dlist_delete(&entry->lru_node);
+    MemoryContextDelete(entry->context);
+    hash_search(cypher_query_cache_hash, &entry->key, HASH_REMOVE, NULL);
+}
+
+static void make_cypher_query_cache_key(cypher_query_cache_key *key,
+                                        Oid graph_oid, const char *query_str,
+                                        Param *params)
+{
+    /* the key is hashed as a blob, so its padding must be zeroed as well */
+    MemSet(key, 0, sizeof(*key));
+
+    key->graph_oid = graph_oid;
+    key->query_hash = hash_bytes((const unsigned char *)query_str,
+                                 strlen(query_str));
+    if (params != NULL)
+    {
+        key->param_type = params->paramtype;
+        key->param_id = params->paramid;
+    }
+    key->user_id = GetUserId();
+    key->enable_containment = age_enable_containment;
+    key->enable_multiway_join = age_enable_multiway_join;
+}
+
+/*
+ * Takes the locks that the analysis of the query took on the relations it
+ * reads and writes, as AcquireRewriteLocks() does for a stored rule. The
+ * planner and the executor expect them to be held.
+ */
+static void lock_query_relations(Query *query)
+{
+    ListCell *lc;
+
+    foreach (lc, query->rtable)
+    {
+        RangeTblEntry *rte = lfirst_node(RangeTblEntry, lc);
+
+        switch (rte->rtekind)
+        {
+            case RTE_RELATION:
+                LockRelationOid(rte->relid, rte->rellockmode);
+                break;
+            case RTE_SUBQUERY:
+                lock_query_relations(rte->subquery);
+                break;
+            default:
+                break;
+        }
+    }
+
+    foreach (lc, query->cteList)
+    {
+        CommonTableExpr *cte = lfirst_node(CommonTableExpr, lc);
+
+        lock_query_relations(castNode(Query, cte->ctequery));
+    }
+
+    if (query->hasSubLinks)
+    {
+        query_tree_walker(query, lock_sublink_relations_walker, NULL,
+                          QTW_IGNORE_RC_SUBQUERIES);
+    }
+}
+
+static bool lock_sublink_relations_walker(Node *node, void *context)
+{
+    if (node == NULL)
+    {
+        return false;
+    }
+
+    if (IsA(node, SubLink))
+    {
+        SubLink *sublink = (SubLink *)node;
+
+        lock_query_relations(castNode(Query, sublink->subselect));
+        /* fall through to the rest of the SubLink */
+    }
+
+    return expression_tree_walker(node, lock_sublink_relations_walker,
+                                  context);
+}
+
+Query *search_cypher_query_cache(Oid graph_oid, const char *query_str,
+                                 Param *params, bool *ends_with_dml)
+{
+    cypher_query_cache_key key;
+    cypher_query_cache_entry *entry;
+    Query *query;
+
+    if (age_cypher_query_cache_size <= 0)
+    {
+        return NULL;
+    }
+
+    initialize_cypher_query_cache();
+
+    make_cypher_query_cache_key(&key, graph_oid, query_str, params);
+
+    entry = hash_search(cypher_query_cache_hash, &key, HASH_FIND, NULL);
+    if (entry == NULL || strcmp(entry->query_str, query_str) != 0 ||
+        strcmp(entry->search_path, namespace_search_path) != 0)
+    {
+        return NULL;
+    }
+
+    /* the caller and the planner are free to scribble on the copy */
+    query = copyObject(entry->query);
+
+    /*
+     * A relation may have been altered or dropped since the query was
+     * analyzed. Lock the relations of the copy, as the entry itself is freed
+     * if an invalidation arrives meanwhile, and then look the entry up again.
+     * Any invalidation flushes the whole cache, so an entry that is still
+     * there is up to date.
+     */
+    lock_query_relations(query);
+    AcceptInvalidationMessages();
+
+    entry = hash_search(cypher_query_cache_hash, &key, HASH_FIND, NULL);
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+
+    dlist_move_head(&cypher_query_cache_lru, &entry->lru_node);
+
+    *ends_with_dml = entry->ends_with_dml;
+
+    return query;
+}
+
+void store_cypher_query_cache(Oid graph_oid, const char *query_str,
+                              Param *params, bool ends_with_dml, Query *query)
+{
+    cypher_query_cache_key key;
+    cypher_query_cache_entry *entry;
+    MemoryContext context;
+    MemoryContext old_context;
+    Query *query_copy;
+    char *query_str_copy;
+    char *search_path_copy;
+    bool found;
+
+    if (age_cypher_query_cache_size <= 0)
+    {
+        return;
+    }
+
+    initialize_cypher_query_cache();
+
+    make_cypher_query_cache_key(&key, graph_oid, query_str, params);
+
+    /*
+     * Copy everything before the entry is created. The context stays under
+     * the caller's context until then so that an error does not leak it.
+     */
+    context = AllocSetContextCreate(CurrentMemoryContext,
+                                    "cypher() query cache entry",
+                                    ALLOCSET_SMALL_SIZES);
+    old_context = MemoryContextSwitchTo(context);
+    query_copy = copyObject(query);
+    query_str_copy = pstrdup(query_str);
+    search_path_copy = pstrdup(namespace_search_path);
+    MemoryContextSwitchTo(old_context);
+
+    MemoryContextSetParent(context, CacheMemoryContext);
+
+    /* replace the entry of the same key, if any */
+    entry = hash_search(cypher_query_cache_hash, &key, HASH_FIND, NULL);
+    if (entry != NULL)
+    {
+        remove_cypher_query_cache_entry(entry);
+    }
+
+    /* make room for the new entry by evicting the least recently used ones */
+    while (hash_get_num_entries(cypher_query_cache_hash) >=
+           age_cypher_query_cache_size)
+    {
+        remove_cypher_query_cache_entry(
+            dlist_tail_element(cypher_query_cache_entry, lru_node,
+                               &cypher_query_cache_lru));
+    }
+
+    entry = hash_search(cypher_query_cache_hash, &key, HASH_ENTER, &found);
+    Assert(!found);
+
+    entry->context = context;
+    entry->query_str = query_str_copy;
+    entry->search_path = search_path_copy;
+    entry->ends_with_dml = ends_with_dml;
+    entry->query = query_copy;
+    dlist_push_head(&cypher_query_cache_lru, &entry->lru_node);
+}
@@ -28,6 +28,7 @@
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
+#include "utils/ag_graphid_cache.h"
 #include "utils/load/ag_load_edges.h"
 
 /*
@@ -36,8 +37,8 @@
  */
 static void process_edge_row(char **fields, int nfields,
                              char **header, int header_count,
-                             int label_id, Oid label_seq_relid,
-                             Oid graph_oid, bool load_as_agtype,
+                             Oid label_relid, Oid graph_oid,
+                             bool load_as_agtype,
                              batch_insert_state *batch_state)
 {
     int64 start_id_int;
@@ -49,7 +50,6 @@ static void process_edge_row(char **fields, int nfields,
     int end_vertex_type_id;
 
     graphid edge_id;
-    int64 entry_id;
     TupleTableSlot *slot;
 
     char *start_vertex_type;
@@ -57,8 +57,7 @@ static void process_edge_row(char **fields, int nfields,
     agtype *edge_properties;
 
     /* Generate edge ID */
-    entry_id = nextval_internal(label_seq_relid, true);
-    edge_id = make_graphid(label_id, entry_id);
+    edge_id = get_next_label_graphid(label_relid);
 
     /* Trim whitespace from vertex type names */
     start_vertex_type = trim_whitespace(fields[1]);
@@ -155,8 +154,6 @@ int create_edges_from_csv_file(char *file_path,
     char          **header = NULL;
     int             header_count = 0;
     bool            is_first_row = true;
-    char           *label_seq_name;
-    Oid             label_seq_relid;
     batch_insert_state *batch_state = NULL;
     MemoryContext   batch_context;
     MemoryContext   old_context;
@@ -170,10 +167,6 @@ int create_edges_from_csv_file(char *file_path,
     label_relid = get_label_relation(label_name, graph_oid);
     label_rel = table_open(label_relid, RowExclusiveLock);
 
-    /* Get sequence info */
-    label_seq_name = get_label_seq_relation_name(label_name);
-    label_seq_relid = get_relname_relid(label_seq_name, graph_oid);
-
     /* Initialize the batch insert state */
     init_batch_insert(&batch_state, label_name, graph_oid);
 
@@ -229,8 +222,7 @@ int create_edges_from_csv_file(char *file_path,
                 /* Data row - process it */
                 process_edge_row(fields, nfields,
                                  header, header_count,
-                                 label_id, label_seq_relid,
-                                 graph_oid, load_as_agtype,
+                                 label_relid, graph_oid, load_as_agtype,
                                  batch_state);
 
                 /* Switch back to main context */
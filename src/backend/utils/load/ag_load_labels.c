@@ -28,6 +28,7 @@
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
+#include "utils/ag_graphid_cache.h"
 #include "utils/load/ag_load_labels.h"
 
 /*
@@ -36,8 +37,9 @@
  */
 static void process_vertex_row(char **fields, int nfields,
                                char **header, int header_count,
-                               int label_id, Oid label_seq_relid,
-                               bool id_field_exists, bool load_as_agtype,
+                               int label_id, Oid label_relid,
+                               Oid label_seq_relid, bool id_field_exists,
+                               bool load_as_agtype,
                                int64 *curr_seq_num,
                                batch_insert_state *batch_state)
 {
@@ -58,14 +60,15 @@ static void process_vertex_row(char **fields, int nfields,
                                 Int64GetDatum(entry_id));
             *curr_seq_num = entry_id;
         }
+
+        vertex_id = make_graphid(label_id, entry_id);
     }
     else
     {
-        entry_id = nextval_internal(label_seq_relid, true);
+        vertex_id = get_next_label_graphid(label_relid);
+        entry_id = get_graphid_entry_id(vertex_id);
     }
 
-    vertex_id = make_graphid(label_id, entry_id);
-
     /* Get the appropriate slot from the batch state */
     slot = batch_state->slots[batch_state->num_tuples];
 
@@ -227,8 +230,9 @@ int create_labels_from_csv_file(char *file_path,
                 /* Data row - process it */
                 process_vertex_row(fields, nfields,
                                    header, header_count,
-                                   label_id, label_seq_relid,
-                                   id_field_exists, load_as_agtype,
+                                   label_id, label_relid,
+                                   label_seq_relid, id_field_exists,
+                                   load_as_agtype,
                                    &curr_seq_num,
                                    batch_state);
 
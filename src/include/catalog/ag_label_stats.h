@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef AG_AG_LABEL_STATS_H
+#define AG_AG_LABEL_STATS_H
+
+#include "catalog/ag_catalog.h"
+
+#define Anum_ag_label_stats_graph 1
+#define Anum_ag_label_stats_label 2
+#define Anum_ag_label_stats_row_count 3
+
+#define Natts_ag_label_stats 3
+
+#define Anum_ag_degree_stats_graph 1
+#define Anum_ag_degree_stats_edge_label 2
+#define Anum_ag_degree_stats_direction 3
+#define Anum_ag_degree_stats_vertex_label 4
+#define Anum_ag_degree_stats_edge_count 5
+#define Anum_ag_degree_stats_vertex_count 6
+#define Anum_ag_degree_stats_avg_degree 7
+#define Anum_ag_degree_stats_p50_degree 8
+#define Anum_ag_degree_stats_p90_degree 9
+#define Anum_ag_degree_stats_p99_degree 10
+#define Anum_ag_degree_stats_max_degree 11
+
+#define Natts_ag_degree_stats 11
+
+#define AG_LABEL_STATS_TABLE "ag_label_stats"
+#define AG_LABEL_STATS_INDEX "ag_label_stats_graph_label_index"
+#define AG_DEGREE_STATS_TABLE "ag_degree_stats"
+#define AG_DEGREE_STATS_INDEX "ag_degree_stats_graph_label_index"
+
+/* degrees counted along start_id (out-edges) or end_id (in-edges) */
+#define DEGREE_STATS_OUT 'o'
+#define DEGREE_STATS_IN 'i'
+
+/*
+ * Degree statistics of one edge label in one direction, restricted to the
+ * endpoint vertices of one vertex label. vertex_count is the number of those
+ * vertices that have at least one such edge; the degrees summarize them.
+ */
+typedef struct degree_stats
+{
+    int64 edge_count;
+    int64 vertex_count;
+    float8 avg_degree;
+    float8 p50_degree;
+    float8 p90_degree;
+    float8 p99_degree;
+    int64 max_degree;
+} degree_stats;
+
+void insert_label_stats(Oid graph_oid, int32 label_id, int64 row_count);
+void insert_degree_stats(Oid graph_oid, int32 edge_label_id, char direction,
+                         int32 vertex_label_id, degree_stats *stats);
+void delete_graph_stats(Oid graph_oid);
+void delete_label_stats(Oid graph_oid, int32 label_id);
+
+bool get_label_stats(Oid graph_oid, int32 label_id, int64 *row_count);
+bool get_degree_stats(Oid graph_oid, int32 edge_label_id, char direction,
+                      int32 vertex_label_id, degree_stats *stats);
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef AG_INDEX_COMMANDS_H
+#define AG_INDEX_COMMANDS_H
+
+#include "nodes/pg_list.h"
+
+#define CREATE_PROPERTY_INDEX_FUNCTION_NAME "_cypher_create_property_index"
+#define DROP_PROPERTY_INDEX_FUNCTION_NAME "_cypher_drop_property_index"
+
+/*
+ * A btree index of a label table whose columns are all properties, accessed
+ * the way the transform of n.key does. Those are the indexes that CREATE
+ * INDEX creates, and the ones the planner can match n.key predicates with.
+ */
+typedef struct property_index
+{
+    Oid index_oid;
+    bool unique;
+    List *keys; /* String nodes of the property keys in column order */
+} property_index;
+
+List *get_label_property_indexes(Oid label_relation);
+
+#endif
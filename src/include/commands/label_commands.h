@@ -44,6 +44,9 @@
 #define AG_EDGE_ACCESS_FUNCTION_END_ID "age_end_id"
 #define AG_EDGE_ACCESS_FUNCTION_PROPERTIES "age_properties"
 
+/* CHECK constraint of a label table that bounds its ids to the label's */
+#define AG_LABEL_ID_CHECK_NAME "_age_label_id_check"
+
 #define IS_DEFAULT_LABEL_EDGE(str) \
     (str != NULL && strcmp(AG_DEFAULT_LABEL_EDGE, str) == 0)
 #define IS_DEFAULT_LABEL_VERTEX(str) \
@@ -48,6 +48,23 @@
 #define DELETE_VERTEX_HTAB_NAME "delete_vertex_htab"
 #define DELETE_VERTEX_HTAB_SIZE 1000000
 
+/* flush an entity insert buffer when either limit is reached */
+#define ENTITY_INSERT_BUFFER_SIZE 1000
+#define ENTITY_INSERT_BUFFER_BYTES 65535 /* 64KB, same as pg COPY */
+
+/*
+ * The tuples of one label that a terminal CREATE clause has not inserted yet.
+ * They are inserted together by flush_entity_insert_buffer().
+ */
+typedef struct entity_insert_buffer
+{
+    ResultRelInfo *resultRelInfo;
+    BulkInsertState bistate;
+    TupleTableSlot **slots;
+    int num_tuples;
+    size_t buffered_bytes;
+} entity_insert_buffer;
+
 typedef struct cypher_create_custom_scan_state
 {
     CustomScanState css;
@@ -57,6 +74,8 @@ typedef struct cypher_create_custom_scan_state
     uint32 flags;
     TupleTableSlot *slot;
     Oid graph_oid;
+    /* entity_insert_buffers by label relation, if the clause is terminal */
+    List *insert_buffers;
 } cypher_create_custom_scan_state;
 
 typedef struct cypher_set_custom_scan_state
@@ -108,11 +127,23 @@ typedef struct cypher_merge_custom_scan_state
     bool found_a_path;
     CommandId base_currentCommandId;
     struct created_path *created_paths_list;
+    /*
+     * The paths of created_paths_list by the hash of their labels and
+     * properties. See find_duplicate_path().
+     */
+    HTAB *created_paths_htab;
     List *eager_tuples;
     int eager_tuples_index;
     bool eager_buffer_filled;
     cypher_update_information *on_match_set_info;   /* NULL if not specified */
     cypher_update_information *on_create_set_info;   /* NULL if not specified */
+    /*
+     * The unique constraints of the label when the path is a lone vertex. See
+     * insert_merge_vertex().
+     */
+    List *arbiter_indexes;
+    TupleTableSlot *conflict_slot;
+    bool matched_on_conflict;
 } cypher_merge_custom_scan_state;
 
 /* Reusable SET logic callable from MERGE executor */
@@ -136,6 +167,12 @@ HeapTuple insert_entity_tuple(ResultRelInfo *resultRelInfo,
 HeapTuple insert_entity_tuple_cid(ResultRelInfo *resultRelInfo,
                                   TupleTableSlot *elemTupleSlot,
                                   EState *estate, CommandId cid);
+entity_insert_buffer *create_entity_insert_buffer(ResultRelInfo *resultRelInfo);
+void buffer_entity_tuple(entity_insert_buffer *buffer,
+                         ResultRelInfo *resultRelInfo,
+                         TupleTableSlot *elemTupleSlot, EState *estate);
+void flush_entity_insert_buffer(entity_insert_buffer *buffer, EState *estate);
+void free_entity_insert_buffer(entity_insert_buffer *buffer);
 
 /* RLS support */
 void setup_wcos(ResultRelInfo *resultRelInfo, EState *estate,
@@ -65,6 +65,9 @@ typedef enum ag_node_tag
     cypher_sub_query_t,
     /* procedure calls */
     cypher_call_t,
+    /* schema commands */
+    cypher_create_index_t,
+    cypher_drop_index_t,
     /* create data structures */
     cypher_create_target_nodes_t,
     cypher_create_path_t,
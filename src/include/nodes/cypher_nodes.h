@@ -349,6 +349,35 @@ typedef struct cypher_call
     List *yield_items; /* optional yield subclause */
 } cypher_call;
 
+/*
+ * schema commands
+ */
+
+/*
+ * CREATE INDEX name IF NOT EXISTS FOR entity ON (properties), or
+ * CREATE CONSTRAINT name IF NOT EXISTS FOR entity REQUIRE properties IS UNIQUE
+ */
+typedef struct cypher_create_index
+{
+    ExtensibleNode extensible;
+    char *name; /* NULL if the name is to be chosen */
+    bool if_not_exists;
+    Node *entity; /* cypher_node or cypher_relationship */
+    List *properties; /* property accesses on the entity's variable */
+    bool unique; /* CREATE CONSTRAINT ... REQUIRE ... IS UNIQUE */
+    int location;
+} cypher_create_index;
+
+/* DROP INDEX name IF EXISTS, or DROP CONSTRAINT name IF EXISTS */
+typedef struct cypher_drop_index
+{
+    ExtensibleNode extensible;
+    char *name;
+    bool if_exists;
+    bool unique; /* DROP CONSTRAINT */
+    int location;
+} cypher_drop_index;
+
 #define CYPHER_CLAUSE_FLAG_NONE 0x0000
 #define CYPHER_CLAUSE_FLAG_TERMINAL 0x0001
 #define CYPHER_CLAUSE_FLAG_PREVIOUS_CLAUSE 0x0002
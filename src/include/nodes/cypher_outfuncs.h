@@ -72,6 +72,10 @@ void out_cypher_sub_query(StringInfo str, const ExtensibleNode *node);
 
 void out_cypher_call(StringInfo str, const ExtensibleNode *node);
 
+/* schema commands */
+void out_cypher_create_index(StringInfo str, const ExtensibleNode *node);
+void out_cypher_drop_index(StringInfo str, const ExtensibleNode *node);
+
 /* create private data structures */
 void out_cypher_create_target_nodes(StringInfo str, const ExtensibleNode *node);
 void out_cypher_create_path(StringInfo str, const ExtensibleNode *node);
@@ -38,9 +38,14 @@ Plan *plan_cypher_merge_path(PlannerInfo *root, RelOptInfo *rel,
                              CustomPath *best_path, List *tlist,
                              List *clauses, List *custom_plans);
 
+Plan *plan_cypher_graph_expand_path(PlannerInfo *root, RelOptInfo *rel,
+                                    CustomPath *best_path, List *tlist,
+                                    List *clauses, List *custom_plans);
+
 extern const CustomScanMethods cypher_create_plan_methods;
 extern const CustomScanMethods cypher_set_plan_methods;
 extern const CustomScanMethods cypher_delete_plan_methods;
 extern const CustomScanMethods cypher_merge_plan_methods;
+extern const CustomScanMethods cypher_graph_expand_plan_methods;
 
 #endif
@@ -26,6 +26,7 @@
 #define SET_PATH_NAME "Cypher Set"
 #define DELETE_PATH_NAME "Cypher Delete"
 #define MERGE_PATH_NAME "Cypher Merge"
+#define GRAPH_EXPAND_PATH_NAME "Cypher Graph Expand"
 
 CustomPath *create_cypher_create_path(PlannerInfo *root, RelOptInfo *rel,
                                       List *custom_private);
@@ -35,10 +36,18 @@ CustomPath *create_cypher_delete_path(PlannerInfo *root, RelOptInfo *rel,
                                       List *custom_private);
 CustomPath *create_cypher_merge_path(PlannerInfo *root, RelOptInfo *rel,
                                      List *custom_private);
+CustomPath *create_cypher_graph_expand_path(PlannerInfo *root,
+                                            RelOptInfo *rel,
+                                            RestrictInfo *rinfo,
+                                            bool outgoing,
+                                            Relids required_outer,
+                                            double avg_degree,
+                                            double graph_size);
 
 extern const CustomPathMethods cypher_create_path_methods;
 extern const CustomPathMethods cypher_set_path_methods;
 extern const CustomPathMethods cypher_delete_path_methods;
 extern const CustomPathMethods cypher_merge_path_methods;
+extern const CustomPathMethods cypher_graph_expand_path_methods;
 
 #endif
@@ -9,6 +9,7 @@ PG_KEYWORD("by", BY, RESERVED_KEYWORD)
 PG_KEYWORD("call", CALL, RESERVED_KEYWORD)
 PG_KEYWORD("case", CASE, RESERVED_KEYWORD)
 PG_KEYWORD("coalesce", COALESCE, RESERVED_KEYWORD)
+PG_KEYWORD("constraint", CONSTRAINT, UNRESERVED_KEYWORD)
 PG_KEYWORD("contains", CONTAINS, RESERVED_KEYWORD)
 PG_KEYWORD("count", COUNT, RESERVED_KEYWORD)
 PG_KEYWORD("create", CREATE, RESERVED_KEYWORD)
@@ -17,13 +18,17 @@ PG_KEYWORD("desc", DESC, RESERVED_KEYWORD)
 PG_KEYWORD("descending", DESCENDING, RESERVED_KEYWORD)
 PG_KEYWORD("detach", DETACH, RESERVED_KEYWORD)
 PG_KEYWORD("distinct", DISTINCT, RESERVED_KEYWORD)
+PG_KEYWORD("drop", DROP, UNRESERVED_KEYWORD)
 PG_KEYWORD("else", ELSE, RESERVED_KEYWORD)
 PG_KEYWORD("end", END_P, RESERVED_KEYWORD)
 PG_KEYWORD("ends", ENDS, RESERVED_KEYWORD)
 PG_KEYWORD("exists", EXISTS, RESERVED_KEYWORD)
 PG_KEYWORD("explain", EXPLAIN, RESERVED_KEYWORD)
 PG_KEYWORD("false", FALSE_P, RESERVED_KEYWORD)
+PG_KEYWORD("for", FOR, UNRESERVED_KEYWORD)
+PG_KEYWORD("if", IF_P, UNRESERVED_KEYWORD)
 PG_KEYWORD("in", IN, RESERVED_KEYWORD)
+PG_KEYWORD("index", INDEX, UNRESERVED_KEYWORD)
 PG_KEYWORD("is", IS, RESERVED_KEYWORD)
 PG_KEYWORD("limit", LIMIT, RESERVED_KEYWORD)
 PG_KEYWORD("match", MATCH, RESERVED_KEYWORD)
@@ -37,6 +42,7 @@ PG_KEYWORD("optional", OPTIONAL, RESERVED_KEYWORD)
 PG_KEYWORD("or", OR, RESERVED_KEYWORD)
 PG_KEYWORD("order", ORDER, RESERVED_KEYWORD)
 PG_KEYWORD("remove", REMOVE, RESERVED_KEYWORD)
+PG_KEYWORD("require", REQUIRE, UNRESERVED_KEYWORD)
 PG_KEYWORD("return", RETURN, RESERVED_KEYWORD)
 PG_KEYWORD("set", SET, RESERVED_KEYWORD)
 PG_KEYWORD("single", SINGLE, RESERVED_KEYWORD)
@@ -45,6 +51,7 @@ PG_KEYWORD("starts", STARTS, RESERVED_KEYWORD)
 PG_KEYWORD("then", THEN, RESERVED_KEYWORD)
 PG_KEYWORD("true", TRUE_P, RESERVED_KEYWORD)
 PG_KEYWORD("union", UNION, RESERVED_KEYWORD)
+PG_KEYWORD("unique", UNIQUE, UNRESERVED_KEYWORD)
 PG_KEYWORD("unwind", UNWIND, RESERVED_KEYWORD)
 PG_KEYWORD("verbose", VERBOSE, RESERVED_KEYWORD)
 PG_KEYWORD("when", WHEN, RESERVED_KEYWORD)
@@ -0,0 +1,37 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef AG_AG_GRAPHID_CACHE_H
+#define AG_AG_GRAPHID_CACHE_H
+
+#include "utils/graphid.h"
+
+/*
+ * get_next_label_graphid() returns the graphid for a new entity of the label
+ * whose table is label_relation, the same as the id column's default. The
+ * sequence of the label and its label id are cached per backend, so no
+ * expression is evaluated per entity.
+ *
+ * The entry ids come from nextval() on the label's sequence. A label created
+ * with age.graphid_block_size greater than one has that as the CACHE of its
+ * sequence, so each backend takes a block of ids at a time.
+ */
+graphid get_next_label_graphid(Oid label_relation);
+
+#endif
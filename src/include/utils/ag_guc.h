@@ -39,6 +39,45 @@
  */
 extern bool age_enable_containment;
 
+/*
+ * Maximum number of parallel background workers a graph algorithm may launch
+ * in addition to the leader backend. Zero runs every algorithm in the leader
+ * only.
+ */
+extern int age_graph_algorithm_workers;
+
+/*
+ * If set true, the planner may scan the edges of a bound vertex through the
+ * adjacency lists of the graph's global context instead of an index on
+ * start_id or end_id. It is only considered for graphs analyzed with
+ * age_analyze_graph() and is costed with a load of the context. It is off
+ * by default, as the loaded context stays in the backend's memory.
+ */
+extern bool age_enable_graph_expand;
+
+/*
+ * If set true, a MATCH pattern whose vertices and edges form a cycle is
+ * joined with age_match_cycle, which intersects the sorted adjacency of the
+ * graph's global context one vertex at a time. It loads that context, which
+ * may reflect a different snapshot than the query's; hence it is off by
+ * default.
+ */
+extern bool age_enable_multiway_join;
+
+/*
+ * Maximum number of analyzed cypher() queries each backend keeps so that
+ * running the same query again skips parsing and analysis. Zero disables
+ * the cache.
+ */
+extern int age_cypher_query_cache_size;
+
+/*
+ * The CACHE of the sequences of labels created afterwards, which is the
+ * number of entry ids a backend takes at a time for the label. It can be
+ * changed for an existing label with ALTER SEQUENCE.
+ */
+extern int age_graphid_block_size;
+
 void define_config_params(void);
 
 #endif
@@ -0,0 +1,38 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef AG_AG_QUERY_CACHE_H
+#define AG_AG_QUERY_CACHE_H
+
+#include "nodes/parsenodes.h"
+#include "nodes/primnodes.h"
+
+/*
+ * Backend-local cache of the Query trees that analyze_cypher() produced for
+ * the cypher() calls of this session. A hit returns a copy of the tree that
+ * the caller may modify, with the relations it refers to locked as the
+ * analysis would have locked them. ends_with_dml is set to whether the query
+ * ends with a clause that writes to the graph.
+ */
+Query *search_cypher_query_cache(Oid graph_oid, const char *query_str,
+                                 Param *params, bool *ends_with_dml);
+void store_cypher_query_cache(Oid graph_oid, const char *query_str,
+                              Param *params, bool ends_with_dml, Query *query);
+
+#endif
@@ -20,6 +20,9 @@
 #ifndef AG_AGE_GLOBAL_GRAPH_H
 #define AG_AGE_GLOBAL_GRAPH_H
 
+#include "storage/itemptr.h"
+#include "utils/snapshot.h"
+
 #include "utils/age_graphid_ds.h"
 
 /*
@@ -60,8 +63,12 @@ GRAPH_global_context *manage_GRAPH_global_contexts(char *graph_name,
                                                    Oid graph_oid);
 GRAPH_global_context *find_GRAPH_global_context(Oid graph_oid);
 bool is_ggctx_invalid(GRAPH_global_context *ggctx);
+bool is_ggctx_current(GRAPH_global_context *ggctx, Snapshot snapshot);
 /* GRAPH retrieval functions */
 ListGraphId *get_graph_vertices(GRAPH_global_context *ggctx);
+int64 get_graph_num_loaded_vertices(GRAPH_global_context *ggctx);
+int64 get_graph_num_loaded_edges(GRAPH_global_context *ggctx);
+Oid get_graph_context_oid(GRAPH_global_context *ggctx);
 vertex_entry *get_vertex_entry(GRAPH_global_context *ggctx,
                                graphid vertex_id);
 edge_entry *get_edge_entry(GRAPH_global_context *ggctx, graphid edge_id);
@@ -77,6 +84,11 @@ edge_entry *get_edge_entry_with_hash(GRAPH_global_context *ggctx,
 graphid get_vertex_entry_id(vertex_entry *ve);
 Oid get_vertex_entry_label_table_oid(vertex_entry *ve);
 Datum get_vertex_entry_properties(vertex_entry *ve);
+/*
+ * Dense ordinal (0..num_loaded_vertices - 1) assigned in load order. It is
+ * also the vertex's position in get_graph_vertices().
+ */
+int32 get_vertex_entry_ordinal(vertex_entry *ve);
 
 /*
  * Flat-array adjacency accessors. Returned pointer is into the entry's
@@ -89,6 +101,8 @@ VertexEdgeArray *get_vertex_entry_edges_self_array(vertex_entry *ve);
 /* edge entry accessor functions */
 graphid get_edge_entry_id(edge_entry *ee);
 Oid get_edge_entry_label_table_oid(edge_entry *ee);
+/* location of the edge's heap tuple when the context was loaded */
+ItemPointer get_edge_entry_tid(edge_entry *ee);
 Datum get_edge_entry_properties(edge_entry *ee);
 graphid get_edge_entry_start_vertex_id(edge_entry *ee);
 graphid get_edge_entry_end_vertex_id(edge_entry *ee);
@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef AG_AGE_GRAPH_CSR_H
+#define AG_AGE_GRAPH_CSR_H
+
+#include "access/parallel.h"
+#include "fmgr.h"
+#include "utils/array.h"
+#include "utils/tuplestore.h"
+
+#include "utils/age_global_graph.h"
+#include "utils/age_graph_projection.h"
+
+/*
+ * Direction flags used when building a GraphCSR. CSR_DIRECTION_BOTH builds
+ * the undirected view of the graph, where every edge is listed in the rows
+ * of both of its endpoints.
+ */
+#define CSR_DIRECTION_OUT  0x01
+#define CSR_DIRECTION_IN   0x02
+#define CSR_DIRECTION_BOTH (CSR_DIRECTION_OUT | CSR_DIRECTION_IN)
+
+/*
+ * Compressed sparse row (CSR) adjacency built from a GRAPH_global_context.
+ *
+ * Vertices are addressed by their dense ordinal (see
+ * get_vertex_entry_ordinal), so the graph algorithms can keep their per
+ * vertex state in flat arrays. The neighbors of vertex i are
+ * targets[offsets[i] .. offsets[i + 1] - 1], and edge_ids holds the graphid
+ * of the edge that produced each slot.
+ *
+ * A CSR is built either from a GRAPH global context or from a named
+ * projection (see age_graph_projection.h). Exactly one of ggctx and
+ * projection is set.
+ *
+ * All arrays are allocated in the memory context that was current when the
+ * CSR was built. They may exceed MaxAllocSize on large graphs and are
+ * therefore allocated with MCXT_ALLOC_HUGE.
+ */
+typedef struct GraphCSR
+{
+    GRAPH_global_context *ggctx;  /* graph the CSR was built from */
+    GraphProjection *projection;  /* or the projection it was built from */
+    int32 num_vertices;           /* number of vertices (rows) */
+    int64 num_edges;              /* number of adjacency slots */
+    int direction;                /* CSR_DIRECTION_* flags used to build it */
+    Oid edge_label_table_oid;     /* edge label filter, InvalidOid for all */
+    graphid *vertex_ids;          /* ordinal -> vertex graphid */
+    int64 *offsets;               /* num_vertices + 1 row offsets */
+    int32 *targets;               /* neighbor ordinal per slot */
+    graphid *edge_ids;            /* edge graphid per slot */
+    int64 *projection_edges;      /* projection edge per slot, or NULL */
+} GraphCSR;
+
+/* CSR construction */
+GraphCSR *build_graph_csr(GRAPH_global_context *ggctx, int direction,
+                          Oid edge_label_table_oid, bool include_self_loops);
+GraphCSR *build_projection_csr(GraphProjection *projection, int direction,
+                               Oid edge_label_table_oid,
+                               bool include_self_loops);
+GraphCSR *build_graph_csr_by_name(const char *funcname, const char *name,
+                                  const char *edge_label_name, int direction,
+                                  bool include_self_loops);
+void free_graph_csr(GraphCSR *csr);
+void sort_graph_csr_rows(GraphCSR *csr);
+void make_graph_csr_neighbor_sets(GraphCSR *csr);
+
+/*
+ * Parallel workers. A CSR stored with store_graph_csr_dsm shares its rows
+ * with the workers, which attach to them with attach_graph_csr_dsm.
+ */
+int get_graph_algorithm_workers(int64 work, int64 min_work);
+void estimate_graph_csr_dsm(ParallelContext *pcxt, GraphCSR *csr);
+void store_graph_csr_dsm(ParallelContext *pcxt, GraphCSR *csr);
+GraphCSR *attach_graph_csr_dsm(shm_toc *toc);
+
+/* edge properties */
+float8 *get_graph_csr_edge_weights(const char *funcname, GraphCSR *csr,
+                                   const char *property);
+
+/* vertex lookups */
+int32 graph_csr_find_ordinal(GraphCSR *csr, graphid vertex_id);
+/* requires rows sorted by sort_graph_csr_rows */
+bool graph_csr_has_neighbor(GraphCSR *csr, int32 vertex, int32 neighbor);
+
+/* argument helpers shared by the graph algorithm functions */
+GRAPH_global_context *get_graph_context_by_name(const char *funcname,
+                                                const char *graph_name);
+Oid get_edge_label_table_oid_by_name(const char *funcname, Oid graph_oid,
+                                     const char *label_name);
+int parse_csr_direction(const char *funcname, const char *direction);
+graphid *get_graphid_array_values(ArrayType *array, int *nelems);
+ArrayType *make_graphid_array(graphid *ids, int nelems);
+char *get_name_arg_or_null(FunctionCallInfo fcinfo, int argno);
+
+/* materialize mode setup for the graph algorithm set returning functions */
+Tuplestorestate *begin_graph_algorithm_srf(FunctionCallInfo fcinfo,
+                                           TupleDesc *tupdesc);
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef AG_AGE_GRAPH_PROJECTION_H
+#define AG_AGE_GRAPH_PROJECTION_H
+
+#include "utils/hsearch.h"
+
+#include "utils/agtype.h"
+#include "utils/graphid.h"
+
+/*
+ * A named, read-only projection of a graph.
+ *
+ * A projection is a snapshot of the vertices of the selected labels and of
+ * the edges of the selected labels between them, taken from the GRAPH
+ * global context when age_project_graph is called. It is not refreshed when
+ * the graph changes; drop and project it again instead.
+ *
+ * Vertices are addressed by dense ordinals, in the load order of the global
+ * graph. Edges are kept as a flat list of (start, end) ordinal pairs, from
+ * which the graph algorithms build their CSR. When property keys were
+ * passed, the properties of each vertex and edge are reduced to those keys;
+ * otherwise no properties are kept.
+ *
+ * Projections are backend local. Each one owns a memory context under
+ * TopMemoryContext that holds everything below.
+ */
+typedef struct GraphProjection
+{
+    char *name;                   /* projection name */
+    char *graph_name;             /* graph the projection was built from */
+    Oid graph_oid;
+    MemoryContext context;        /* owns the projection */
+
+    int32 num_vertices;
+    graphid *vertex_ids;          /* ordinal -> vertex graphid */
+    Oid *vertex_label_oids;       /* ordinal -> vertex label table oid */
+    Datum *vertex_properties;     /* projected agtype properties, or NULL */
+    HTAB *vertex_ordinals;        /* vertex graphid -> ordinal */
+
+    int64 num_edges;
+    graphid *edge_ids;
+    Oid *edge_label_oids;         /* edge label table oids */
+    int32 *edge_starts;           /* start vertex ordinals */
+    int32 *edge_ends;             /* end vertex ordinals */
+    Datum *edge_properties;       /* projected agtype properties, or NULL */
+
+    struct GraphProjection *next; /* next projection of this backend */
+} GraphProjection;
+
+GraphProjection *find_graph_projection(const char *name);
+int32 graph_projection_find_ordinal(GraphProjection *projection,
+                                    graphid vertex_id);
+
+#endif
@@ -565,6 +565,10 @@ uint32 get_agtype_offset(const agtype_container *agtc, int index);
 uint32 get_agtype_length(const agtype_container *agtc, int index);
 int compare_agtype_containers_orderability(agtype_container *a,
                                            agtype_container *b);
+/* the low bits of an abbreviated key; the high ones are the type's priority */
+#define AGTYPE_ABBREV_PREFIX_BITS 56
+uint64 get_agtype_abbrev_key(agtype_container *agtc, char **str,
+                             int *str_len);
 agtype_value *find_agtype_value_from_container(agtype_container *container,
                                                uint32 flags,
                                                agtype_value *key);
@@ -688,6 +692,8 @@ bool is_decimal_needed(char *numstr);
 int compare_agtype_scalar_values(agtype_value *a, agtype_value *b);
 agtype_value *alter_property_value(agtype_value *properties, char *var_name,
                                    agtype *new_v, bool remove_property);
+agtype_value *set_property_value(agtype_value *properties, char *var_name,
+                                 agtype *new_v, bool remove_property);
 void remove_null_from_agtype_object(agtype_value *object);
 agtype_value *alter_properties(agtype_value *original_properties,
                                agtype *new_properties);